@@ -0,0 +1,47 @@
+// DisplayBackend.h
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+
+// Where rendered pixels end up. Display_ST7789.cpp draws into a FrameCanvas
+// and, at present time, hands each dirty rectangle to the backend; it never
+// talks to a panel driver itself.
+//
+// The device build uses the TFT_eSPI backend. Building with LCD_HOST_BACKEND
+// swaps in HostDisplayBackend, an in-memory panel that runs on a PC.
+class DisplayBackend {
+public:
+  virtual ~DisplayBackend() {}
+
+  virtual void begin() = 0;
+  // rot is 0..3, as passed to LCD_SetOrientation().
+  virtual void setRotation(uint8_t rot) = 0;
+
+  // One present is beginPush(), pushRect() per dirty rect, endPush(). pixels
+  // is RGB565 in wire order (see Rgb565Format), with rows stride px apart, and
+  // is only valid until pushRect() returns. A backend may still be sending when
+  // endPush() returns.
+  virtual void beginPush() {}
+  virtual void pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                        const uint16_t* pixels, uint16_t stride) = 0;
+  virtual void endPush() {}
+  virtual void waitIdle() {}
+  virtual bool busy() { return false; }
+
+  // Direct drawing, used only when the framebuffer could not be allocated.
+  // Colours are plain RGB565.
+  virtual void fillScreen(uint16_t color) = 0;
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) = 0;
+  virtual void drawFastHLine(int32_t x, int32_t y, int32_t w, uint16_t color) = 0;
+  virtual void drawPixel(int32_t x, int32_t y, uint16_t color) = 0;
+  virtual void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) = 0;
+  virtual void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) = 0;
+  virtual void drawCircle(int32_t xc, int32_t yc, int32_t r, uint16_t color) = 0;
+  virtual void fillCircle(int32_t xc, int32_t yc, int32_t r, uint16_t color) = 0;
+  virtual int16_t drawText(const char* str, int32_t x, int32_t y,
+                           uint16_t fg, uint16_t bg, bool opaque, uint8_t size) = 0;
+};
+
+// The backend LCD_Init() uses unless LCD_SetBackend() picked another one.
+// Provided by TFTDisplayBackend.cpp, or HostDisplayBackend.cpp on a host build.
+DisplayBackend& LCD_DefaultBackend();
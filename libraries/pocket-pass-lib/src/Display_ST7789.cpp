@@ -1,20 +1,42 @@
-// Display_ST7789.cpp (TFT_eSPI-backed with optional off-screen framebuffer)
+// Display_ST7789.cpp (off-screen framebuffer presented through a DisplayBackend)
 
 #include "Display_ST7789.h"
+#include "DisplayBackend.h"
+#include "FrameCanvas.h"
+#include "TextLayout.h"
+#include "fonts/BitmapFont.h"
 #include <Arduino.h>
-#include <TFT_eSPI.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-static TFT_eSPI tft = TFT_eSPI();
-static TFT_eSprite framebuffer = TFT_eSprite(&tft);
+#if LCD_INDEXED_FRAMEBUFFER
+typedef IndexedFrameCanvas LCDCanvas;
+#else
+typedef FrameCanvas LCDCanvas;
+#endif
+typedef LCDCanvas::Pixel LCDPixel;
+
+static DisplayBackend* g_backend = nullptr;
+static LCDCanvas framebuffer;
 
 static uint16_t g_width  = LCD_WIDTH;
 static uint16_t g_height = LCD_HEIGHT;
 static uint8_t  g_rot = 0;
 static uint8_t  g_text_rot = 0;
 static bool     g_has_framebuffer = false;
-static bool     g_frame_dirty = false;
 static uint16_t g_frame_hold_depth = 0;
+static uint32_t g_frame_begin_us = 0;
+static LCDStats g_stats = {};
+static bool     g_stats_overlay = LCD_STATS_OVERLAY;
+
+// Regions of the framebuffer changed since the last present, half-open [x0,x1) x [y0,y1).
+struct DirtyRect {
+  int16_t x0, y0, x1, y1;
+};
+static DirtyRect g_dirty[LCD_DIRTY_MAX_RECTS];
+static uint8_t   g_dirty_count = 0;
+
 // Soft, low-saturation RGB565 palettes intended for small ST7789 displays.
 // Order: name, background, foreground, accent, selected background, selected foreground.
 static const UIColorPalette kPalettes[] = {
@@ -35,7 +57,24 @@ static const UIColorPalette kPalettes[] = {
   {"LILAC",      0x39CF, 0xF79F, 0xD63F, 0xE73C, 0x292C}, // lilac CRT
 };
 static uint8_t g_palette_idx = 0;
-const uint16_t extraSpacing = TEXT_EXTRA_SPACING;
+static void canvasPaletteChanged();
+
+// Role of each palette colour, and of the two backdrop blends; also the order of
+// the role entries in an indexed framebuffer's colour table.
+enum PaletteRole : uint8_t {
+  kRoleBg, kRoleFg, kRoleAccent, kRoleSelectedBg, kRoleSelectedFg, kRoleScanline, kRoleGrain,
+  kPaletteRoleCount
+};
+
+static DisplayBackend& backend() {
+  if (!g_backend) g_backend = &LCD_DefaultBackend();
+  return *g_backend;
+}
+
+void LCD_SetBackend(DisplayBackend* b) {
+  if (g_backend) g_backend->waitIdle();
+  g_backend = b;
+}
 
 uint16_t LCD_Width()  { return g_width; }
 uint16_t LCD_Height() { return g_height; }
@@ -54,17 +93,18 @@ uint8_t UI_GetPalette(void) {
 
 void UI_SetPalette(uint8_t idx) {
   g_palette_idx = (idx < UI_PaletteCount()) ? idx : 0;
+  canvasPaletteChanged();
 }
 
 const UIColorPalette& UI_GetPaletteDef(void) {
   return kPalettes[g_palette_idx];
 }
 
-uint16_t UI_ColorBg(void) { return UI_GetPaletteDef().bg; }
-uint16_t UI_ColorFg(void) { return UI_GetPaletteDef().fg; }
-uint16_t UI_ColorAccent(void) { return UI_GetPaletteDef().accent; }
-uint16_t UI_ColorSelectedBg(void) { return UI_GetPaletteDef().selectedBg; }
-uint16_t UI_ColorSelectedFg(void) { return UI_GetPaletteDef().selectedFg; }
+UIColor UI_ColorBg(void) { return UIColor(UI_GetPaletteDef().bg, kRoleBg); }
+UIColor UI_ColorFg(void) { return UIColor(UI_GetPaletteDef().fg, kRoleFg); }
+UIColor UI_ColorAccent(void) { return UIColor(UI_GetPaletteDef().accent, kRoleAccent); }
+UIColor UI_ColorSelectedBg(void) { return UIColor(UI_GetPaletteDef().selectedBg, kRoleSelectedBg); }
+UIColor UI_ColorSelectedFg(void) { return UIColor(UI_GetPaletteDef().selectedFg, kRoleSelectedFg); }
 
 static bool uiHasRetroBackdrop() {
   return true;
@@ -86,29 +126,98 @@ static uint16_t blend565(uint16_t a, uint16_t b, uint8_t amountB) {
   return (uint16_t)((r << 11) | (g << 5) | bl);
 }
 
-template <typename TCanvas>
-static void fillBackdropRect(TCanvas& canvas, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
-  if (w == 0 || h == 0) return;
+// The backdrop pattern is anchored to the screen, not to the rect being
+// filled, so partial restores line up with a full clear.
+static const uint8_t kScanlinePeriod = 8;
+static const uint8_t kScanlinePhase  = 3;
+static const uint8_t kGrainPeriod    = 17;
+static const uint8_t kGrainPhase     = 5;
 
-  const uint16_t bg = UI_ColorBg();
+static void backdropColors(UIColor& bg, UIColor& scanline, UIColor& grain) {
+  bg = UI_ColorBg();
   // Keep the CRT texture close to the background. Using accent directly creates
   // harsh stripes and substantially reduces text readability.
-  const uint16_t scanline = blend565(bg, UI_ColorAccent(), 18); // ~7% accent
-  const uint16_t grain    = blend565(bg, UI_ColorAccent(), 30); // ~12% accent
+  scanline = UIColor(blend565(bg, UI_ColorAccent(), 18), kRoleScanline); // ~7% accent
+  grain    = UIColor(blend565(bg, UI_ColorAccent(), 30), kRoleGrain);    // ~12% accent
+}
 
+static uint16_t grainColumn(uint32_t yy) {
+  return (uint16_t)((yy * 11U) % g_width);
+}
+
+template <typename TCanvas>
+static void fillBackdropRect(TCanvas& canvas, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  if (w == 0 || h == 0) return;
+
+  UIColor bg, scanline, grain;
+  backdropColors(bg, scanline, grain);
   canvas.fillRect(x, y, w, h, bg);
 
   // Sparse, faint scanlines rather than a strong line every few pixels.
   const uint32_t bottom = (uint32_t)y + h;
   const uint32_t right = (uint32_t)x + w;
-  for (uint32_t yy = y + 3U; yy < bottom; yy += 8U) {
-    canvas.drawFastHLine(x, (uint16_t)yy, w, scanline);
+  for (uint32_t yy = y; yy < bottom; ++yy) {
+    if (yy % kScanlinePeriod == kScanlinePhase) canvas.drawFastHLine(x, (uint16_t)yy, w, scanline);
+    // Very light deterministic phosphor/grain dots.
+    if (yy % kGrainPeriod == kGrainPhase) {
+      const uint16_t px = grainColumn(yy);
+      if (px >= x && (uint32_t)px < right) canvas.drawPixel(px, (uint16_t)yy, grain);
+    }
+  }
+}
+
+// Plain and scanline rows for the current palette and width, as stored
+// pixels, so restoring the backdrop in the framebuffer is a memcpy per row.
+static LCDPixel* g_backdrop_rows = nullptr; // [0, w) plain, [w, 2w) scanline
+static uint16_t  g_backdrop_w = 0;
+static uint8_t   g_backdrop_palette = 0xFF;
+static LCDPixel  g_backdrop_grain = 0;
+
+static bool backdropRowsReady() {
+  if (g_backdrop_rows && g_backdrop_w == g_width && g_backdrop_palette == g_palette_idx) return true;
+  if (g_backdrop_w != g_width) {
+    free(g_backdrop_rows);
+    g_backdrop_rows = (LCDPixel*)malloc((size_t)g_width * 2U * sizeof(LCDPixel));
+    g_backdrop_w = g_backdrop_rows ? g_width : 0;
+  }
+  if (!g_backdrop_rows) return false;
+
+  UIColor bg, scanline, grain;
+  backdropColors(bg, scanline, grain);
+  const LCDPixel bgPx = framebuffer.toBuffer(bg);
+  const LCDPixel scanPx = framebuffer.toBuffer(scanline);
+  for (uint16_t i = 0; i < g_width; ++i) {
+    g_backdrop_rows[i] = bgPx;
+    g_backdrop_rows[g_width + i] = scanPx;
+  }
+  g_backdrop_grain = framebuffer.toBuffer(grain);
+  g_backdrop_palette = g_palette_idx;
+  return true;
+}
+
+// Backdrop of screen row yy, columns [x, x + w), into dst. Needs backdropRowsReady().
+static void backdropSpan(LCDPixel* dst, uint16_t x, uint16_t yy, uint16_t w) {
+  const LCDPixel* src = g_backdrop_rows + ((yy % kScanlinePeriod == kScanlinePhase) ? g_width : 0);
+  memcpy(dst, src + x, (size_t)w * sizeof(LCDPixel));
+  if (yy % kGrainPeriod == kGrainPhase) {
+    const uint16_t px = grainColumn(yy);
+    if (px >= x && (uint32_t)px < (uint32_t)x + w) dst[px - x] = g_backdrop_grain;
   }
+}
+
+static void fillBackdropRect(LCDCanvas& canvas, uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  LCDPixel* pixels = canvas.pixels();
+  if (!pixels || !backdropRowsReady()) {
+    fillBackdropRect<LCDCanvas>(canvas, x, y, w, h);
+    return;
+  }
+  if (x >= g_width || y >= g_height) return;
+  if ((uint32_t)x + w > g_width) w = (uint16_t)(g_width - x);
+  if ((uint32_t)y + h > g_height) h = (uint16_t)(g_height - y);
+  if (w == 0 || h == 0) return;
 
-  // Very light deterministic phosphor/grain dots.
-  for (uint32_t yy = y + 5U; yy < bottom; yy += 17U) {
-    const uint16_t px = (uint16_t)(x + ((yy * 11U + x * 3U) % w));
-    if ((uint32_t)px < right) canvas.drawPixel(px, (uint16_t)yy, grain);
+  for (uint32_t yy = y; yy < (uint32_t)y + h; ++yy) {
+    backdropSpan(pixels + yy * g_width + x, x, (uint16_t)yy, w);
   }
 }
 
@@ -117,41 +226,159 @@ static void drawRetroBackdrop(TCanvas& canvas, uint16_t w, uint16_t h) {
   fillBackdropRect(canvas, 0, 0, w, h);
 }
 
+static uint32_t dirtyArea(const DirtyRect& r) {
+  return (uint32_t)(r.x1 - r.x0) * (uint32_t)(r.y1 - r.y0);
+}
+
+static DirtyRect dirtyUnion(const DirtyRect& a, const DirtyRect& b) {
+  DirtyRect u;
+  u.x0 = min(a.x0, b.x0);
+  u.y0 = min(a.y0, b.y0);
+  u.x1 = max(a.x1, b.x1);
+  u.y1 = max(a.y1, b.y1);
+  return u;
+}
+
+// Pixels a merge would push that neither input needed. Each extra window costs
+// a CASET/RASET round trip, so small overdraw is cheaper than another rect.
+static uint32_t dirtyMergeWaste(const DirtyRect& a, const DirtyRect& b) {
+  const uint32_t ua = dirtyArea(dirtyUnion(a, b));
+  const uint32_t ab = dirtyArea(a) + dirtyArea(b);
+  return (ua > ab) ? (ua - ab) : 0;
+}
+
+static void markDirtyRect(int32_t x, int32_t y, int32_t w, int32_t h) {
+  if (w <= 0 || h <= 0) return;
+  int32_t x1 = x + w;
+  int32_t y1 = y + h;
+  if (x < 0) x = 0;
+  if (y < 0) y = 0;
+  if (x1 > (int32_t)g_width) x1 = g_width;
+  if (y1 > (int32_t)g_height) y1 = g_height;
+  if (x >= x1 || y >= y1) return;
+
+  DirtyRect r = { (int16_t)x, (int16_t)y, (int16_t)x1, (int16_t)y1 };
+
+  // Fold r into any rect it overlaps or sits close to, then repeat with the
+  // grown rect since it may now reach others.
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (uint8_t i = 0; i < g_dirty_count; ++i) {
+      if (dirtyMergeWaste(g_dirty[i], r) > LCD_DIRTY_MERGE_SLACK) continue;
+      r = dirtyUnion(g_dirty[i], r);
+      g_dirty[i] = g_dirty[--g_dirty_count];
+      merged = true;
+      break;
+    }
+  }
+
+  if (g_dirty_count < LCD_DIRTY_MAX_RECTS) {
+    g_dirty[g_dirty_count++] = r;
+    return;
+  }
+
+  // Table full: merge with whichever rect wastes the fewest pixels.
+  uint8_t best = 0;
+  uint32_t bestWaste = UINT32_MAX;
+  for (uint8_t i = 0; i < g_dirty_count; ++i) {
+    const uint32_t waste = dirtyMergeWaste(g_dirty[i], r);
+    if (waste < bestWaste) {
+      bestWaste = waste;
+      best = i;
+    }
+  }
+  g_dirty[best] = dirtyUnion(g_dirty[best], r);
+}
+
 static void markFrameDirty() {
-  g_frame_dirty = true;
+  g_dirty[0] = { 0, 0, (int16_t)g_width, (int16_t)g_height };
+  g_dirty_count = 1;
+}
+
+// An indexed framebuffer keeps the palette colours in the first table entries,
+// so switching palettes recolours the frame on the next present, no redraw needed.
+static void canvasPaletteChanged() {
+#if LCD_INDEXED_FRAMEBUFFER
+  const UIColorPalette& p = UI_GetPaletteDef();
+  UIColor bg, scanline, grain;
+  backdropColors(bg, scanline, grain);
+  static_assert(kPaletteRoleCount <= IndexedFormat::kRoleCount, "palette roles must fit the role entries");
+  const uint16_t roles[kPaletteRoleCount] = { bg, p.fg, p.accent, p.selectedBg, p.selectedFg, scanline, grain };
+  framebuffer.format().setRoles(roles, kPaletteRoleCount);
+  if (g_has_framebuffer) markFrameDirty();
+#endif
+}
+
+#if LCD_INDEXED_FRAMEBUFFER
+// Indexed rows are expanded through the colour table into this strip on their way out.
+static const uint32_t kExpandPx = (uint32_t)LCD_INDEXED_STRIP_ROWS * ((LCD_WIDTH > LCD_HEIGHT) ? LCD_WIDTH : LCD_HEIGHT);
+static uint16_t g_expand[kExpandPx];
+#endif
+
+// Sends a w x h block of stored pixels (rows stride px apart) to the backend.
+static void pushCanvasRect(DisplayBackend& out, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                           const LCDPixel* src, uint16_t stride) {
+#if LCD_INDEXED_FRAMEBUFFER
+  const uint16_t* wire = framebuffer.format().wireTable();
+  const uint16_t chunkRows = (uint16_t)(kExpandPx / w);
+  for (uint16_t done = 0; done < h; ) {
+    const uint16_t rows = (uint16_t)min<uint32_t>(chunkRows, h - done);
+    for (uint16_t row = 0; row < rows; ++row) {
+      const LCDPixel* s = src + (uint32_t)(done + row) * stride;
+      uint16_t* d = g_expand + (uint32_t)row * w;
+      for (uint16_t i = 0; i < w; ++i) d[i] = wire[s[i]];
+    }
+    out.pushRect(x, (uint16_t)(y + done), w, rows, g_expand, w);
+    done = (uint16_t)(done + rows);
+  }
+#else
+  out.pushRect(x, y, w, h, src, stride);
+#endif
 }
 
 static void destroyFramebuffer() {
   if (!g_has_framebuffer) return;
-  framebuffer.deleteSprite();
+  framebuffer.destroy();
   g_has_framebuffer = false;
 }
 
 static void ensureFramebuffer() {
   destroyFramebuffer();
 
-  framebuffer.setColorDepth(16);
-  framebuffer.setSwapBytes(false);
-  g_has_framebuffer = framebuffer.createSprite(g_width, g_height) != nullptr;
+  g_dirty_count = 0;
+  g_has_framebuffer = framebuffer.create(g_width, g_height);
   if (g_has_framebuffer) {
+    canvasPaletteChanged();
     if (uiHasRetroBackdrop()) drawRetroBackdrop(framebuffer, g_width, g_height);
-    else framebuffer.fillSprite(UI_ColorBg());
+    else framebuffer.fill(UI_ColorBg());
     markFrameDirty();
   }
 }
 
-template <typename TCanvas>
-static void configureTextCanvas(TCanvas& canvas,
-                                uint16_t color,
-                                uint16_t bg,
-                                uint8_t size) {
-  canvas.setTextFont(1);
-  canvas.setTextSize(size);
+// Current text colours and size, set by configureTextStyle().
+struct TextStyle {
+  UIColor fg;
+  UIColor bg;
+  uint8_t  size;
+  bool     opaque;
+};
+static TextStyle g_text_style = { 0xFFFF, 0x0000, 1, false };
+
+static void configureTextStyle(UIColor color, UIColor bg, uint8_t size) {
   // Normal text over the retro backdrop must be transparent. Otherwise
-  // TFT_eSPI paints a solid rectangle behind every glyph.
-  if (uiHasRetroBackdrop() && bg == UI_ColorBg()) canvas.setTextColor(color);
-  else canvas.setTextColor(color, bg);
-  canvas.setTextDatum(TL_DATUM);
+  // the glyph cells would paint a solid rectangle over the scanlines.
+  g_text_style.opaque = !(uiHasRetroBackdrop() && bg == UI_ColorBg());
+  g_text_style.fg = color;
+  g_text_style.bg = bg;
+  g_text_style.size = size ? size : 1;
+}
+
+// Draws one line in the current text style and returns its advance in px.
+template <typename TCanvas>
+static int16_t canvasDrawText(TCanvas& canvas, const char* str, int32_t x, int32_t y) {
+  return canvas.drawText(str, x, y, g_text_style.fg, g_text_style.bg,
+                         g_text_style.opaque, g_text_style.size);
 }
 
 template <typename TCanvas>
@@ -159,12 +386,12 @@ static void drawCharImpl(TCanvas& canvas,
                          uint16_t x,
                          uint16_t y,
                          char c,
-                         uint16_t color,
-                         uint16_t bg,
+                         UIColor color,
+                         UIColor bg,
                          uint8_t size) {
-  configureTextCanvas(canvas, color, bg, size);
+  configureTextStyle(color, bg, size);
   char buf[2] = {c, 0};
-  canvas.drawString(buf, x, y);
+  markDirtyRect(x, y, canvasDrawText(canvas, buf, x, y), fontLineHeight(size));
 }
 
 template <typename TCanvas>
@@ -172,11 +399,11 @@ static void drawStringImpl(TCanvas& canvas,
                            uint16_t x,
                            uint16_t y,
                            const char* str,
-                           uint16_t color,
-                           uint16_t bg,
+                           UIColor color,
+                           UIColor bg,
                            uint8_t size) {
-  configureTextCanvas(canvas, color, bg, size);
-  canvas.drawString(str, x, y);
+  configureTextStyle(color, bg, size);
+  markDirtyRect(x, y, canvasDrawText(canvas, str, x, y), fontLineHeight(size));
 }
 
 template <typename TCanvas>
@@ -190,10 +417,9 @@ static void measureTextSingleLineImpl(TCanvas& canvas,
     h = (uint16_t)(size * 8);
     return;
   }
-  canvas.setTextFont(1);
-  canvas.setTextSize(size);
-  w = (uint16_t)canvas.textWidth(str);
-  h = (uint16_t)canvas.fontHeight();
+  (void)canvas;
+  w = fontTextWidth(str, size);
+  h = fontLineHeight(size);
 }
 
 template <typename TCanvas>
@@ -201,16 +427,13 @@ static void drawStringWithPaddingImpl(TCanvas& canvas,
                                       uint16_t x,
                                       uint16_t y,
                                       const char* str,
-                                      uint16_t fgColor,
-                                      uint16_t bgColor,
+                                      UIColor fgColor,
+                                      UIColor bgColor,
                                       uint8_t size,
                                       uint16_t padX,
                                       uint16_t padY) {
-  canvas.setTextFont(1);
-  canvas.setTextSize(size);
-
-  uint16_t textW = (uint16_t)canvas.textWidth(str);
-  uint16_t textH = (uint16_t)canvas.fontHeight();
+  uint16_t textW = fontTextWidth(str, size);
+  uint16_t textH = fontLineHeight(size);
 
   uint16_t boxX = (x > padX) ? (uint16_t)(x - padX) : 0;
   uint16_t boxY = (y > padY) ? (uint16_t)(y - padY) : 0;
@@ -219,134 +442,41 @@ static void drawStringWithPaddingImpl(TCanvas& canvas,
   if (uiHasRetroBackdrop() && bgColor == UI_ColorBg()) fillBackdropRect(canvas, boxX, boxY, boxW, boxH);
   else canvas.fillRect(boxX, boxY, boxW, boxH, bgColor);
 
-  // The area was already restored above. Draw transparently when it is the
-  // normal retro background so the scanlines remain visible around glyphs.
-  if (uiHasRetroBackdrop() && bgColor == UI_ColorBg()) canvas.setTextColor(fgColor);
-  else canvas.setTextColor(fgColor, bgColor);
-  canvas.setTextDatum(TL_DATUM);
-  canvas.drawString(str, x, y);
+  // The area was already restored above. Text is drawn transparently when it
+  // is the normal retro background so the scanlines remain visible around glyphs.
+  configureTextStyle(fgColor, bgColor, size);
+  canvasDrawText(canvas, str, x, y);
+  markDirtyRect(boxX, boxY, max<int32_t>(boxW, x - boxX + textW), max<int32_t>(boxH, y - boxY + textH));
 }
 
+// Wrapped text drawn or measured last. Scrolling the same text reuses its
+// line breaks, so each step only draws the lines inside the view.
+static TextLayout g_wrap_layout;
+
 template <typename TCanvas>
 static void drawStringWrapWidthImpl(TCanvas& canvas,
                                     uint16_t x,
                                     uint16_t y,
                                     const char* str,
-                                    uint16_t color,
-                                    uint16_t bg,
+                                    UIColor color,
+                                    UIColor bg,
                                     uint8_t size,
                                     uint16_t maxWidthPx) {
   if (!str || !*str || maxWidthPx == 0) return;
 
-  configureTextCanvas(canvas, color, bg, size);
-
-  const uint16_t baseLineH = (uint16_t)canvas.fontHeight();
-  const uint16_t lineH = (uint16_t)(baseLineH + 6);
-
-  char lineBuf[256];
-  uint16_t lineLen = 0;
-  uint16_t lineW = 0;
-
-  auto flush_line = [&]() {
-    if (lineLen == 0) return;
-    lineBuf[lineLen] = '\0';
-    canvas.drawString(lineBuf, x, y);
+  configureTextStyle(color, bg, size);
+  g_wrap_layout.update(str, size, maxWidthPx);
+  const uint16_t baseLineH = fontLineHeight(size);
+  const uint16_t lineH = g_wrap_layout.lineHeight();
+
+  char lineBuf[TextLayout::kMaxLineChars + 1];
+  for (uint16_t i = 0; i < g_wrap_layout.lineCount(); ++i) {
+    // Unscrolled text has always collapsed blank lines.
+    if (g_wrap_layout.lineText(i, lineBuf, sizeof(lineBuf)) == 0) continue;
+    canvasDrawText(canvas, lineBuf, x, y);
+    markDirtyRect(x, y, g_wrap_layout.line(i).width, baseLineH);
     y = (uint16_t)(y + lineH);
-    lineLen = 0;
-    lineW = 0;
-  };
-
-  auto charWidth = [&](char c) -> int16_t {
-    char tmp[2] = { c, 0 };
-    return (int16_t)canvas.textWidth(tmp);
-  };
-
-  auto wordWidth = [&](const char* start, const char* end) -> int16_t {
-    int16_t w = 0;
-    for (const char* p = start; p < end; ++p) w += charWidth(*p);
-    return w;
-  };
-
-  const char* p = str;
-  while (*p) {
-    if (*p == '\n') {
-      flush_line();
-      ++p;
-      continue;
-    }
-
-    if (lineLen == 0) {
-      while (*p == ' ') ++p;
-      if (!*p) break;
-      if (*p == '\n') { ++p; continue; }
-    }
-
-    const char* tokenStart = p;
-    bool isSpaceToken = false;
-    if (*p == ' ') {
-      while (*p == ' ') ++p;
-      isSpaceToken = true;
-    } else {
-      while (*p && *p != ' ' && *p != '\n') ++p;
-    }
-    const char* tokenEnd = p;
-
-    int16_t tokenW = isSpaceToken ? charWidth(' ') : wordWidth(tokenStart, tokenEnd);
-    if (isSpaceToken && lineLen == 0) continue;
-
-    if (lineW + tokenW <= (int)maxWidthPx || lineLen == 0) {
-      if (!isSpaceToken) {
-        for (const char* q = tokenStart; q < tokenEnd; ++q) {
-          int16_t cw = charWidth(*q);
-          if (lineW + cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (lineLen < sizeof(lineBuf) - 1) {
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)(lineW + cw);
-          } else {
-            flush_line();
-            if (lineLen < sizeof(lineBuf) - 1) {
-              lineBuf[lineLen++] = *q;
-              lineW = (uint16_t)cw;
-            }
-          }
-        }
-      } else {
-        int16_t sw = charWidth(' ');
-        if (lineLen > 0 && lineW + sw > (int)maxWidthPx) {
-          flush_line();
-        } else if (sw > (int)maxWidthPx && lineLen > 0) {
-          flush_line();
-        } else if (lineLen < sizeof(lineBuf) - 1) {
-          lineBuf[lineLen++] = ' ';
-          lineW = (uint16_t)(lineW + sw);
-        } else {
-          flush_line();
-        }
-      }
-    } else {
-      flush_line();
-      if (!isSpaceToken) {
-        for (const char* q = tokenStart; q < tokenEnd; ++q) {
-          int16_t cw = charWidth(*q);
-          if (lineW + cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (lineLen < sizeof(lineBuf) - 1) {
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)(lineW + cw);
-          } else {
-            flush_line();
-            if (lineLen < sizeof(lineBuf) - 1) {
-              lineBuf[lineLen++] = *q;
-              lineW = (uint16_t)cw;
-            }
-          }
-        }
-      }
-    }
   }
-
-  if (lineLen > 0) flush_line();
 }
 
 template <typename TCanvas>
@@ -354,240 +484,43 @@ static void drawStringWrapWidthScrolledImpl(TCanvas& canvas,
                                             uint16_t x,
                                             uint16_t y,
                                             const char* str,
-                                            uint16_t color,
-                                            uint16_t bg,
+                                            UIColor color,
+                                            UIColor bg,
                                             uint8_t size,
                                             uint16_t maxWidthPx,
                                             uint16_t maxHeightPx,
                                             uint16_t scrollPosY) {
   if (!str || !*str || maxWidthPx == 0 || maxHeightPx == 0) return;
 
-  configureTextCanvas(canvas, color, bg, size);
-
-  const uint16_t baseLineH = (uint16_t)canvas.fontHeight();
-  const uint16_t lineH = (uint16_t)(baseLineH + 6);
-  const int32_t viewTop = (int32_t)scrollPosY;
-  const int32_t viewBot = (int32_t)scrollPosY + (int32_t)maxHeightPx;
-
-  char lineBuf[256];
-  uint16_t lineLen = 0;
-  uint16_t lineW = 0;
-  int32_t layoutY = 0;
-
-  auto charWidth = [&](char c) -> int16_t {
-    char tmp[2] = { c, 0 };
-    return (int16_t)canvas.textWidth(tmp);
-  };
-  auto wordWidth = [&](const char* start, const char* end) -> int16_t {
-    int16_t w = 0;
-    for (const char* p = start; p < end; ++p) w += charWidth(*p);
-    return w;
-  };
-  auto draw_if_visible = [&](const char* textLine, int32_t lineBaselineY) {
-    int32_t top = lineBaselineY;
-    int32_t bot = lineBaselineY + (int32_t)lineH;
-    if (bot <= viewTop || top >= viewBot) return;
-    int16_t screenY = (int16_t)(y + (lineBaselineY - (int32_t)scrollPosY));
-    canvas.drawString(textLine, x, screenY);
-  };
-  auto flush_line = [&]() {
-    if (lineLen == 0) {
-      layoutY += lineH;
-      return;
-    }
-    lineBuf[lineLen] = '\0';
-    draw_if_visible(lineBuf, layoutY);
-    layoutY += lineH;
-    lineLen = 0;
-    lineW = 0;
-  };
-
-  const char* p = str;
-  while (*p) {
-    if (layoutY > viewBot) break;
-
-    if (*p == '\n') {
-      flush_line();
-      ++p;
-      continue;
-    }
-
-    if (lineLen == 0) {
-      while (*p == ' ') ++p;
-      if (!*p) break;
-      if (*p == '\n') { ++p; continue; }
-    }
-
-    const char* tokenStart = p;
-    bool isSpaceToken = false;
-    if (*p == ' ') {
-      while (*p == ' ') ++p;
-      isSpaceToken = true;
-    } else {
-      while (*p && *p != ' ' && *p != '\n') ++p;
-    }
-    const char* tokenEnd = p;
-
-    int16_t tokenW = isSpaceToken ? charWidth(' ') : wordWidth(tokenStart, tokenEnd);
-    if (isSpaceToken && lineLen == 0) continue;
-
-    if (lineW + tokenW <= (int)maxWidthPx || lineLen == 0) {
-      if (!isSpaceToken) {
-        for (const char* q = tokenStart; q < tokenEnd; ++q) {
-          int16_t cw = charWidth(*q);
-          if (lineW + cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (lineLen < sizeof(lineBuf) - 1) {
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)(lineW + cw);
-          } else {
-            flush_line();
-            if (lineLen < sizeof(lineBuf) - 1) {
-              lineBuf[lineLen++] = *q;
-              lineW = (uint16_t)cw;
-            }
-          }
-        }
-      } else {
-        int16_t sw = charWidth(' ');
-        if (lineLen > 0 && lineW + sw > (int)maxWidthPx) {
-          flush_line();
-        } else if (sw > (int)maxWidthPx && lineLen > 0) {
-          flush_line();
-        } else if (lineLen < sizeof(lineBuf) - 1) {
-          lineBuf[lineLen++] = ' ';
-          lineW = (uint16_t)(lineW + sw);
-        } else {
-          flush_line();
-        }
-      }
-    } else {
-      flush_line();
-      if (!isSpaceToken) {
-        for (const char* q = tokenStart; q < tokenEnd; ++q) {
-          int16_t cw = charWidth(*q);
-          if (lineW + cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (lineLen < sizeof(lineBuf) - 1) {
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)(lineW + cw);
-          } else {
-            flush_line();
-            if (lineLen < sizeof(lineBuf) - 1) {
-              lineBuf[lineLen++] = *q;
-              lineW = (uint16_t)cw;
-            }
-          }
-        }
-      }
-    }
+  configureTextStyle(color, bg, size);
+  g_wrap_layout.update(str, size, maxWidthPx);
+  const uint16_t baseLineH = fontLineHeight(size);
+  const uint16_t lineH = g_wrap_layout.lineHeight();
+  const uint32_t viewBot = (uint32_t)scrollPosY + maxHeightPx;
+
+  // Lines whose band [i*lineH, (i+1)*lineH) intersects the view.
+  char lineBuf[TextLayout::kMaxLineChars + 1];
+  for (uint16_t i = (uint16_t)(scrollPosY / lineH);
+       i < g_wrap_layout.lineCount() && (uint32_t)i * lineH < viewBot; ++i) {
+    if (g_wrap_layout.lineText(i, lineBuf, sizeof(lineBuf)) == 0) continue;
+    const int16_t screenY = (int16_t)(y + ((int32_t)i * lineH - (int32_t)scrollPosY));
+    canvasDrawText(canvas, lineBuf, x, screenY);
+    markDirtyRect(x, screenY, g_wrap_layout.line(i).width, baseLineH);
   }
-
-  if (lineLen > 0) flush_line();
 }
 
-template <typename TCanvas>
-static void measureWrappedTextHeightAndLines_Impl(TCanvas& canvas,
-                                                  const char* str,
-                                                  uint8_t size,
-                                                  uint16_t maxWidthPx,
-                                                  uint16_t& outTotalH,
-                                                  uint16_t& outNumLines) {
+static void measureWrappedTextHeightAndLines(const char* str,
+                                             uint8_t size,
+                                             uint16_t maxWidthPx,
+                                             uint16_t& outTotalH,
+                                             uint16_t& outNumLines) {
   outTotalH = 0;
   outNumLines = 0;
   if (!str || !*str || maxWidthPx == 0) return;
 
-  canvas.setTextFont(1);
-  canvas.setTextSize(size);
-
-  const uint16_t baseLineH = (uint16_t)canvas.fontHeight();
-  const uint16_t lineH = (uint16_t)(baseLineH + extraSpacing);
-
-  char lineBuf[256];
-  uint16_t lineLen = 0;
-  uint16_t lineW = 0;
-
-  auto charWidth = [&](char c) -> int16_t {
-    char tmp[2] = { c, 0 };
-    return (int16_t)canvas.textWidth(tmp);
-  };
-  auto wordWidth = [&](const char* s, const char* e) -> int16_t {
-    int16_t w = 0;
-    for (const char* p = s; p < e; ++p) w += charWidth(*p);
-    return w;
-  };
-  auto flush_line = [&]() {
-    outTotalH = (uint16_t)(outTotalH + lineH);
-    outNumLines = (uint16_t)(outNumLines + 1);
-    lineLen = 0;
-    lineW = 0;
-  };
-
-  const char* p = str;
-  while (*p) {
-    if (*p == '\n') { flush_line(); ++p; continue; }
-    if (lineLen == 0) {
-      while (*p == ' ') ++p;
-      if (!*p) break;
-      if (*p == '\n') { ++p; continue; }
-    }
-
-    const char* s = p;
-    bool spaceTok = false;
-    if (*p == ' ') { while (*p == ' ') ++p; spaceTok = true; }
-    else { while (*p && *p != ' ' && *p != '\n') ++p; }
-    const char* e = p;
-
-    int16_t tokW = spaceTok ? charWidth(' ') : wordWidth(s, e);
-    if (spaceTok && lineLen == 0) continue;
-
-    if (lineW + tokW <= (int)maxWidthPx || lineLen == 0) {
-      if (!spaceTok) {
-        for (const char* q = s; q < e; ++q) {
-          int16_t cw = charWidth(*q);
-          if (lineW + cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (lineLen < sizeof(lineBuf) - 1) {
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)(lineW + cw);
-          } else {
-            flush_line();
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)cw;
-          }
-        }
-      } else {
-        int16_t sw = charWidth(' ');
-        if (lineLen > 0 && lineW + sw > (int)maxWidthPx) {
-          flush_line();
-        } else if (lineLen < sizeof(lineBuf) - 1) {
-          lineBuf[lineLen++] = ' ';
-          lineW = (uint16_t)(lineW + sw);
-        } else {
-          flush_line();
-        }
-      }
-    } else {
-      flush_line();
-      if (!spaceTok) {
-        for (const char* q = s; q < e; ++q) {
-          int16_t cw = charWidth(*q);
-          if (lineW + cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (cw > (int)maxWidthPx && lineLen > 0) flush_line();
-          if (lineLen < sizeof(lineBuf) - 1) {
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)(lineW + cw);
-          } else {
-            flush_line();
-            lineBuf[lineLen++] = *q;
-            lineW = (uint16_t)cw;
-          }
-        }
-      }
-    }
-  }
-
-  if (lineLen > 0) flush_line();
+  g_wrap_layout.update(str, size, maxWidthPx);
+  outNumLines = g_wrap_layout.lineCount();
+  outTotalH = (uint16_t)g_wrap_layout.totalHeight();
 }
 
 template <typename TCanvas>
@@ -595,8 +528,8 @@ static void drawStringWrapWidthScrolledTailAwareImpl(TCanvas& canvas,
                                                      uint16_t x,
                                                      uint16_t y,
                                                      const char* str,
-                                                     uint16_t color,
-                                                     uint16_t bg,
+                                                     UIColor color,
+                                                     UIColor bg,
                                                      uint8_t size,
                                                      uint16_t maxWidthPx,
                                                      uint16_t maxHeightPx,
@@ -606,10 +539,8 @@ static void drawStringWrapWidthScrolledTailAwareImpl(TCanvas& canvas,
 
   uint16_t totalH = 0;
   uint16_t numLines = 0;
-  measureWrappedTextHeightAndLines_Impl(canvas, str, size, maxWidthPx, totalH, numLines);
-
-  uint16_t baseLineH = (uint16_t)(8u * size);
-  uint16_t lineH = (uint16_t)(baseLineH + extraSpacing);
+  measureWrappedTextHeightAndLines(str, size, maxWidthPx, totalH, numLines);
+  const uint16_t lineH = g_wrap_layout.lineHeight();
 
   int32_t viewH = (int32_t)maxHeightPx;
   int32_t maxScroll = (int32_t)totalH - viewH;
@@ -632,12 +563,15 @@ void LCD_WriteCommand(uint8_t) {}
 void LCD_WriteData(uint8_t) {}
 void LCD_WriteData_Word(uint16_t) {}
 void LCD_addWindow(uint16_t, uint16_t, uint16_t, uint16_t, uint16_t*) {}
+// The backend sets the address window for each rect it sends.
+void LCD_SetCursor(uint16_t, uint16_t, uint16_t, uint16_t) {}
 
 void LCD_Reset(void) {}
 
 void LCD_SetOrientation(uint8_t rot) {
+  LCD_WaitPresent();
   g_rot = (rot & 3);
-  tft.setRotation(g_rot);
+  backend().setRotation(g_rot);
   if (g_rot == 0 || g_rot == 2) {
     g_width = LCD_WIDTH;
     g_height = LCD_HEIGHT;
@@ -655,22 +589,13 @@ uint8_t getTextRotation() { return g_text_rot; }
 void LCD_Init(void) {
   Backlight_Init();
 
-  tft.init();
-#ifdef ENABLE_TFT_DMA
-  tft.initDMA();
-#endif
-
-  tft.setTextFont(1);
-  tft.setTextSize(1);
-  tft.setSwapBytes(false);
-
+  backend().begin();
   LCD_SetOrientation(ORIENT_PORTRAIT);
-  tft.invertDisplay(true);
-  tft.fillScreen(UI_ColorBg());
+  backend().fillScreen(UI_ColorBg());
 }
 
 void LCD_BeginFrame(void) {
-  ++g_frame_hold_depth;
+  if (g_frame_hold_depth++ == 0) g_frame_begin_us = micros();
 }
 
 void LCD_EndFrame(void) {
@@ -680,46 +605,115 @@ void LCD_EndFrame(void) {
   }
   --g_frame_hold_depth;
   if (g_frame_hold_depth == 0) {
+    const uint32_t us = (uint32_t)(micros() - g_frame_begin_us);
+    g_stats.lastRenderUs = us;
+    if (us > g_stats.maxRenderUs) g_stats.maxRenderUs = us;
     LCD_Present();
   }
 }
 
-void LCD_Present(void) {
-  if (g_frame_hold_depth > 0 || !g_frame_dirty) return;
-  if (g_has_framebuffer) {
-    framebuffer.pushSprite(0, 0);
-  }
-  g_frame_dirty = false;
+const LCDStats& LCD_GetStats(void) {
+  return g_stats;
+}
+
+void LCD_ResetStats(void) {
+  memset(&g_stats, 0, sizeof(g_stats));
+}
+
+void LCD_SetStatsOverlay(bool on) {
+  if (g_stats_overlay == on) return;
+  g_stats_overlay = on;
+  // Whatever the overlay covered is gone; hand the strip back to the backdrop.
+  if (!on) LCD_FillRect(0, (uint16_t)(g_height - fontLineHeight(1)), g_width, fontLineHeight(1), UI_ColorBg());
+}
+
+bool LCD_StatsOverlay(void) {
+  return g_stats_overlay;
+}
+
+// One line of counters along the bottom edge, drawn into the frame just before
+// it is sent. Shows the previous present, since this one is not measured yet.
+static void drawStatsOverlay() {
+  if (!g_has_framebuffer) return;
+  char line[64];
+  snprintf(line, sizeof(line), "F%lu %luB %lu.%02lums R%lu.%02lums S%lu",
+           (unsigned long)g_stats.frames,
+           (unsigned long)g_stats.lastBytes,
+           (unsigned long)(g_stats.lastPresentUs / 1000), (unsigned long)(g_stats.lastPresentUs % 1000) / 10,
+           (unsigned long)(g_stats.lastRenderUs / 1000), (unsigned long)(g_stats.lastRenderUs % 1000) / 10,
+           (unsigned long)g_stats.skipped);
+  const uint16_t h = fontLineHeight(1);
+  const uint16_t y = (uint16_t)(g_height - h);
+  const uint16_t w = min<uint16_t>(g_width, fontTextWidth(line, 1));
+  framebuffer.drawText(line, 0, y, WHITE, BLACK, true, 1);
+  markDirtyRect(0, y, w, h);
+}
+
+void LCD_WaitPresent(void) {
+  if (g_backend) g_backend->waitIdle();
+}
+
+bool LCD_PresentBusy(void) {
+  return g_backend && g_backend->busy();
 }
 
-void LCD_SetCursor(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend) {
-  if (Xend >= g_width) Xend = g_width - 1;
-  if (Yend >= g_height) Yend = g_height - 1;
-  if (!g_has_framebuffer) {
-    tft.setWindow(Xstart, Ystart, Xend, Yend);
+void LCD_Present(void) {
+  if (g_frame_hold_depth > 0) return;
+  if (g_dirty_count == 0) {
+    g_stats.skipped++;
+    return;
   }
+  if (g_stats_overlay) drawStatsOverlay();
+
+  const uint32_t t0 = micros();
+  const LCDPixel* pixels = g_has_framebuffer ? framebuffer.pixels() : nullptr;
+  if (pixels) {
+    DisplayBackend& out = backend();
+    uint32_t bytes = 0;
+    out.beginPush();
+    for (uint8_t i = 0; i < g_dirty_count; ++i) {
+      const DirtyRect& r = g_dirty[i];
+      pushCanvasRect(out, r.x0, r.y0, r.x1 - r.x0, r.y1 - r.y0,
+                     pixels + (uint32_t)r.y0 * g_width + r.x0, g_width);
+      bytes += dirtyArea(r) * sizeof(uint16_t);
+    }
+    out.endPush();
+    // With DMA this is the time to queue the transfer, not to finish it.
+    const uint32_t us = (uint32_t)(micros() - t0);
+    g_stats.frames++;
+    g_stats.bytes += bytes;
+    g_stats.lastBytes = bytes;
+    g_stats.lastPresentUs = us;
+    g_stats.totalPresentUs += us;
+    if (us > g_stats.maxPresentUs) g_stats.maxPresentUs = us;
+  }
+  g_dirty_count = 0;
 }
 
-void LCD_Clear(uint16_t color) {
+void LCD_Clear(UIColor color) {
   const bool useBackdrop = uiHasRetroBackdrop() && color == UI_ColorBg();
   if (g_has_framebuffer) {
+#if LCD_INDEXED_FRAMEBUFFER
+    // Every pixel is about to be overwritten, so non-palette entries are free again.
+    framebuffer.format().resetExtras();
+#endif
     if (useBackdrop) drawRetroBackdrop(framebuffer, g_width, g_height);
-    else framebuffer.fillSprite(color);
+    else framebuffer.fill(color);
   } else {
-    if (useBackdrop) drawRetroBackdrop(tft, g_width, g_height);
-    else tft.fillScreen(color);
+    if (useBackdrop) drawRetroBackdrop(backend(), g_width, g_height);
+    else backend().fillScreen(color);
   }
   markFrameDirty();
 }
 
-void LCD_DrawPixel(uint16_t x, uint16_t y, uint16_t color) {
+void LCD_DrawPixel(uint16_t x, uint16_t y, UIColor color) {
   if (x >= g_width || y >= g_height) return;
   if (g_has_framebuffer) framebuffer.drawPixel(x, y, color);
-  else tft.drawPixel(x, y, color);
-  markFrameDirty();
+  else backend().drawPixel(x, y, color);
+  markDirtyRect(x, y, 1, 1);
 }
 
-void LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+void LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, UIColor color) {
   if (w == 0 || h == 0) return;
   if (x >= g_width || y >= g_height) return;
   if (x + w > g_width) w = g_width - x;
@@ -729,10 +723,10 @@ void LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color
     if (useBackdrop) fillBackdropRect(framebuffer, x, y, w, h);
     else framebuffer.fillRect(x, y, w, h, color);
   } else {
-    if (useBackdrop) fillBackdropRect(tft, x, y, w, h);
-    else tft.fillRect(x, y, w, h, color);
+    if (useBackdrop) fillBackdropRect(backend(), x, y, w, h);
+    else backend().fillRect(x, y, w, h, color);
   }
-  markFrameDirty();
+  markDirtyRect(x, y, w, h);
 }
 
 static uint8_t g_backlight_percent = 100;
@@ -749,99 +743,159 @@ void Set_Backlight(uint8_t Light) {
   else digitalWrite(EXAMPLE_PIN_NUM_BK_LIGHT, HIGH);
 }
 
-void LCD_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+void LCD_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, UIColor color) {
   if (g_has_framebuffer) framebuffer.drawLine(x0, y0, x1, y1, color);
-  else tft.drawLine(x0, y0, x1, y1, color);
-  markFrameDirty();
+  else backend().drawLine(x0, y0, x1, y1, color);
+  markDirtyRect(min(x0, x1), min(y0, y1), abs(x1 - x0) + 1, abs(y1 - y0) + 1);
 }
 
-void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, UIColor color) {
   if (w == 0 || h == 0) return;
   if (g_has_framebuffer) framebuffer.drawRect(x, y, w, h, color);
-  else tft.drawRect(x, y, w, h, color);
-  markFrameDirty();
+  else backend().drawRect(x, y, w, h, color);
+  // Only the outline changed; marking the box would push a large frame's whole interior.
+  markDirtyRect(x, y, w, 1);
+  markDirtyRect(x, y + h - 1, w, 1);
+  markDirtyRect(x, y, 1, h);
+  markDirtyRect(x + w - 1, y, 1, h);
 }
 
-void LCD_DrawCircle(int16_t xc, int16_t yc, int16_t r, uint16_t color) {
+void LCD_DrawCircle(int16_t xc, int16_t yc, int16_t r, UIColor color) {
   if (r < 0) return;
   if (g_has_framebuffer) framebuffer.drawCircle(xc, yc, r, color);
-  else tft.drawCircle(xc, yc, r, color);
-  markFrameDirty();
+  else backend().drawCircle(xc, yc, r, color);
+  markDirtyRect(xc - r, yc - r, 2 * r + 1, 2 * r + 1);
 }
 
-void LCD_FillCircle(int16_t xc, int16_t yc, int16_t r, uint16_t color) {
+void LCD_FillCircle(int16_t xc, int16_t yc, int16_t r, UIColor color) {
   if (r < 0) return;
   if (g_has_framebuffer) framebuffer.fillCircle(xc, yc, r, color);
-  else tft.fillCircle(xc, yc, r, color);
-  markFrameDirty();
+  else backend().fillCircle(xc, yc, r, color);
+  markDirtyRect(xc - r, yc - r, 2 * r + 1, 2 * r + 1);
 }
 
-void drawCharRot(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t size, uint8_t rot) {
+void drawCharRot(uint16_t x, uint16_t y, char c, UIColor color, UIColor bg, uint8_t size, uint8_t rot) {
   (void)rot;
   if (g_has_framebuffer) drawCharImpl(framebuffer, x, y, c, color, bg, size);
-  else drawCharImpl(tft, x, y, c, color, bg, size);
-  markFrameDirty();
+  else drawCharImpl(backend(), x, y, c, color, bg, size);
 }
 
 void drawStringRot(uint16_t x, uint16_t y, const char* str,
-                   uint16_t color, uint16_t bg, uint8_t size, bool wrap, uint8_t rot) {
+                   UIColor color, UIColor bg, uint8_t size, bool wrap, uint8_t rot) {
   (void)wrap;
   (void)rot;
   if (g_has_framebuffer) drawStringImpl(framebuffer, x, y, str, color, bg, size);
-  else drawStringImpl(tft, x, y, str, color, bg, size);
-  markFrameDirty();
+  else drawStringImpl(backend(), x, y, str, color, bg, size);
 }
 
-void drawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t size) {
+void drawChar(uint16_t x, uint16_t y, char c, UIColor color, UIColor bg, uint8_t size) {
   drawCharRot(x, y, c, color, bg, size, g_text_rot);
 }
 
-void drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, uint16_t bg, uint8_t size, bool wrap) {
+void drawString(uint16_t x, uint16_t y, const char* str, UIColor color, UIColor bg, uint8_t size, bool wrap) {
   drawStringRot(x, y, str, color, bg, size, wrap, g_text_rot);
 }
 
 void measureTextSingleLine(const char* str, uint8_t size, uint16_t& w, uint16_t& h) {
   if (g_has_framebuffer) measureTextSingleLineImpl(framebuffer, str, size, w, h);
-  else measureTextSingleLineImpl(tft, str, size, w, h);
+  else measureTextSingleLineImpl(backend(), str, size, w, h);
 }
 
 void drawStringWithPaddingRot(uint16_t x, uint16_t y,
                               const char* str,
-                              uint16_t fgColor, uint16_t bgColor,
+                              UIColor fgColor, UIColor bgColor,
                               uint8_t size,
                               uint16_t padX, uint16_t padY,
                               bool wrap, uint8_t rot) {
   (void)wrap;
   (void)rot;
   if (g_has_framebuffer) drawStringWithPaddingImpl(framebuffer, x, y, str, fgColor, bgColor, size, padX, padY);
-  else drawStringWithPaddingImpl(tft, x, y, str, fgColor, bgColor, size, padX, padY);
-  markFrameDirty();
+  else drawStringWithPaddingImpl(backend(), x, y, str, fgColor, bgColor, size, padX, padY);
 }
 
 void drawStringWithPadding(uint16_t x, uint16_t y,
                            const char* str,
-                           uint16_t fgColor, uint16_t bgColor,
+                           UIColor fgColor, UIColor bgColor,
                            uint8_t size,
                            uint16_t padX, uint16_t padY,
                            bool wrap) {
   drawStringWithPaddingRot(x, y, str, fgColor, bgColor, size, padX, padY, wrap, g_text_rot);
 }
 
+// Scratch strip for drawStringMarquee(); grows to the widest box seen, then stays.
+static LCDPixel* g_strip = nullptr;
+static size_t    g_strip_px = 0;
+
+void drawStringMarquee(uint16_t x, uint16_t y, uint16_t w,
+                       const char* str, uint8_t gapChars, uint16_t scrollPx,
+                       UIColor fgColor, UIColor bgColor, uint8_t size) {
+  if (!str || !*str || size == 0 || x >= g_width || y >= g_height) return;
+  if ((uint32_t)x + w > g_width) w = (uint16_t)(g_width - x);
+  uint16_t h = fontLineHeight(size);
+  if ((uint32_t)y + h > g_height) h = (uint16_t)(g_height - y);
+  if (w == 0 || h == 0) return;
+
+  const size_t need = (size_t)w * h;
+  if (need > g_strip_px) {
+    LCDPixel* grown = (LCDPixel*)realloc(g_strip, need * sizeof(LCDPixel));
+    if (!grown) return;
+    g_strip = grown;
+    g_strip_px = need;
+  }
+
+  // Background first: the backdrop itself when text sits on it, so glyphs stay
+  // transparent exactly as drawString would draw them.
+  const bool onBackdrop = uiHasRetroBackdrop() && bgColor == UI_ColorBg() && backdropRowsReady();
+  const LCDPixel bgPx = framebuffer.toBuffer(bgColor);
+  for (uint16_t row = 0; row < h; ++row) {
+    LCDPixel* dst = g_strip + (size_t)row * w;
+    if (onBackdrop) {
+      backdropSpan(dst, x, (uint16_t)(y + row), w);
+    } else {
+      for (uint16_t i = 0; i < w; ++i) dst[i] = bgPx;
+    }
+  }
+
+  // The content is str followed by gapChars blanks, repeated. Only the cells
+  // that overlap the box are drawn.
+  const uint32_t len = (uint32_t)strlen(str);
+  const uint32_t cellW = fontCharWidth(' ', size);
+  const uint32_t period = (len + gapChars) * cellW;
+  const uint32_t start = scrollPx % period;
+  uint32_t k = start / cellW;
+  const LCDPixel fgPx = framebuffer.toBuffer(fgColor);
+  for (int32_t cx = -(int32_t)(start % cellW); cx < (int32_t)w; cx += (int32_t)cellW, ++k) {
+    if (k >= len + gapChars) k = 0;
+    if (k >= len) continue;
+    const char glyph[2] = { str[k], '\0' };
+    fontDrawString(g_strip, w, h, cx, 0, glyph, fgPx, bgPx, false, size);
+  }
+
+  if (g_has_framebuffer) {
+    framebuffer.pushImage(x, y, w, h, g_strip);
+    markDirtyRect(x, y, w, h);
+  } else {
+    DisplayBackend& out = backend();
+    out.beginPush();
+    pushCanvasRect(out, x, y, w, h, g_strip, w);
+    out.endPush();
+  }
+}
+
 void drawStringWrapWidth(uint16_t x, uint16_t y,
                          const char* str,
-                         uint16_t color, uint16_t bg,
+                         UIColor color, UIColor bg,
                          uint8_t size,
                          uint16_t maxWidthPx,
                          uint8_t rot) {
   (void)rot;
   if (g_has_framebuffer) drawStringWrapWidthImpl(framebuffer, x, y, str, color, bg, size, maxWidthPx);
-  else drawStringWrapWidthImpl(tft, x, y, str, color, bg, size, maxWidthPx);
-  markFrameDirty();
+  else drawStringWrapWidthImpl(backend(), x, y, str, color, bg, size, maxWidthPx);
 }
 
 void drawStringWrapWidth(uint16_t x, uint16_t y,
                          const char* str,
-                         uint16_t color, uint16_t bg,
+                         UIColor color, UIColor bg,
                          uint8_t size,
                          uint16_t maxWidthPx) {
   drawStringWrapWidth(x, y, str, color, bg, size, maxWidthPx, g_text_rot);
@@ -849,7 +903,7 @@ void drawStringWrapWidth(uint16_t x, uint16_t y,
 
 void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
                                  const char* str,
-                                 uint16_t color, uint16_t bg,
+                                 UIColor color, UIColor bg,
                                  uint8_t size,
                                  uint16_t maxWidthPx,
                                  uint16_t maxHeightPx,
@@ -857,13 +911,12 @@ void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
                                  uint8_t rot) {
   (void)rot;
   if (g_has_framebuffer) drawStringWrapWidthScrolledImpl(framebuffer, x, y, str, color, bg, size, maxWidthPx, maxHeightPx, scrollPosY);
-  else drawStringWrapWidthScrolledImpl(tft, x, y, str, color, bg, size, maxWidthPx, maxHeightPx, scrollPosY);
-  markFrameDirty();
+  else drawStringWrapWidthScrolledImpl(backend(), x, y, str, color, bg, size, maxWidthPx, maxHeightPx, scrollPosY);
 }
 
 void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
                                  const char* str,
-                                 uint16_t color, uint16_t bg,
+                                 UIColor color, UIColor bg,
                                  uint8_t size,
                                  uint16_t maxWidthPx,
                                  uint16_t maxHeightPx,
@@ -874,14 +927,13 @@ void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
 uint16_t measureWrappedTextHeight(const char* str, uint8_t size, uint16_t maxWidthPx) {
   uint16_t totalH = 0;
   uint16_t lines = 0;
-  if (g_has_framebuffer) measureWrappedTextHeightAndLines_Impl(framebuffer, str, size, maxWidthPx, totalH, lines);
-  else measureWrappedTextHeightAndLines_Impl(tft, str, size, maxWidthPx, totalH, lines);
+  measureWrappedTextHeightAndLines(str, size, maxWidthPx, totalH, lines);
   return totalH;
 }
 
 void drawStringWrapWidthScrolledTailAware(uint16_t x, uint16_t y,
                                           const char* str,
-                                          uint16_t color, uint16_t bg,
+                                          UIColor color, UIColor bg,
                                           uint8_t size,
                                           uint16_t maxWidthPx,
                                           uint16_t maxHeightPx,
@@ -891,8 +943,7 @@ void drawStringWrapWidthScrolledTailAware(uint16_t x, uint16_t y,
     drawStringWrapWidthScrolledTailAwareImpl(framebuffer, x, y, str, color, bg, size,
                                              maxWidthPx, maxHeightPx, ioScrollPosY, visibleLines);
   } else {
-    drawStringWrapWidthScrolledTailAwareImpl(tft, x, y, str, color, bg, size,
+    drawStringWrapWidthScrolledTailAwareImpl(backend(), x, y, str, color, bg, size,
                                              maxWidthPx, maxHeightPx, ioScrollPosY, visibleLines);
   }
-  markFrameDirty();
 }
@@ -3,6 +3,7 @@
 #pragma once
 #include <Arduino.h>
 #include <stdint.h>
+#include "UIColor.h"
 
 // =========================
 // Panel / Orientation defines
@@ -74,21 +75,49 @@ void LCD_WriteData_Word(uint16_t data);
 void LCD_addWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* ptr);
 
 void LCD_Reset(void);
+// Where presents go (see DisplayBackend.h). Call before LCD_Init() to replace
+// the default panel, e.g. with a HostDisplayBackend. nullptr restores it.
+class DisplayBackend;
+void LCD_SetBackend(DisplayBackend* backend);
 void LCD_Init(void);
 void LCD_BeginFrame(void);
 void LCD_EndFrame(void);
 void LCD_Present(void);
+// With ENABLE_TFT_DMA, LCD_Present() may return while the last strip is still
+// being sent. The framebuffer is free to draw into at once; only direct panel
+// access must wait. Both are no-ops for a backend that sends synchronously.
+void LCD_WaitPresent(void);
+bool LCD_PresentBusy(void);
+
+// Present/render counters since boot or the last LCD_ResetStats().
+struct LCDStats {
+  uint32_t frames;         // presents that sent pixels
+  uint32_t skipped;        // presents with nothing dirty
+  uint64_t bytes;          // pixel bytes sent to the panel
+  uint32_t lastBytes;
+  uint32_t lastPresentUs;  // time spent in LCD_Present (queueing only, with DMA)
+  uint32_t maxPresentUs;
+  uint64_t totalPresentUs;
+  uint32_t lastRenderUs;   // outermost LCD_BeginFrame() to LCD_EndFrame()
+  uint32_t maxRenderUs;
+};
+const LCDStats& LCD_GetStats(void);
+void LCD_ResetStats(void);
+// Draws the counters along the bottom edge of every presented frame.
+void LCD_SetStatsOverlay(bool on);
+bool LCD_StatsOverlay(void);
 
 uint8_t UI_PaletteCount(void);
 const char* UI_PaletteName(uint8_t idx);
 uint8_t UI_GetPalette(void);
 void UI_SetPalette(uint8_t idx);
 const UIColorPalette& UI_GetPaletteDef(void);
-uint16_t UI_ColorBg(void);
-uint16_t UI_ColorFg(void);
-uint16_t UI_ColorAccent(void);
-uint16_t UI_ColorSelectedBg(void);
-uint16_t UI_ColorSelectedFg(void);
+// The current palette's colours, tagged with their roles (see UIColor.h).
+UIColor UI_ColorBg(void);
+UIColor UI_ColorFg(void);
+UIColor UI_ColorAccent(void);
+UIColor UI_ColorSelectedBg(void);
+UIColor UI_ColorSelectedFg(void);
 
 // Orientation control
 void LCD_SetOrientation(uint8_t rot);
@@ -101,48 +130,55 @@ void Set_Backlight(uint8_t Light); // 0=OFF, 1..100=ON
 
 // Primitives
 void LCD_SetCursor(uint16_t Xstart, uint16_t Ystart, uint16_t Xend, uint16_t Yend);
-void LCD_Clear(uint16_t color);
-void LCD_DrawPixel(uint16_t x, uint16_t y, uint16_t color);
-void LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
-void LCD_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
-void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
-void LCD_DrawCircle(int16_t xc, int16_t yc, int16_t r, uint16_t color);
-void LCD_FillCircle(int16_t xc, int16_t yc, int16_t r, uint16_t color);
+void LCD_Clear(UIColor color);
+void LCD_DrawPixel(uint16_t x, uint16_t y, UIColor color);
+void LCD_FillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, UIColor color);
+void LCD_DrawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, UIColor color);
+void LCD_DrawRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, UIColor color);
+void LCD_DrawCircle(int16_t xc, int16_t yc, int16_t r, UIColor color);
+void LCD_FillCircle(int16_t xc, int16_t yc, int16_t r, UIColor color);
 
 // Text helpers
-void drawCharRot(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t size, uint8_t rot);
+void drawCharRot(uint16_t x, uint16_t y, char c, UIColor color, UIColor bg, uint8_t size, uint8_t rot);
 void drawStringRot(uint16_t x, uint16_t y, const char* str,
-                   uint16_t color, uint16_t bg, uint8_t size, bool wrap, uint8_t rot);
+                   UIColor color, UIColor bg, uint8_t size, bool wrap, uint8_t rot);
 
-void drawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, uint8_t size);
-void drawString(uint16_t x, uint16_t y, const char* str, uint16_t color, uint16_t bg, uint8_t size, bool wrap);
+void drawChar(uint16_t x, uint16_t y, char c, UIColor color, UIColor bg, uint8_t size);
+void drawString(uint16_t x, uint16_t y, const char* str, UIColor color, UIColor bg, uint8_t size, bool wrap);
 
 void measureTextSingleLine(const char* str, uint8_t size, uint16_t& w, uint16_t& h);
 
 void drawStringWithPaddingRot(uint16_t x, uint16_t y,
                               const char* str,
-                              uint16_t fgColor, uint16_t bgColor,
+                              UIColor fgColor, UIColor bgColor,
                               uint8_t size,
                               uint16_t padX, uint16_t padY,
                               bool wrap, uint8_t rot);
 
 void drawStringWithPadding(uint16_t x, uint16_t y,
                            const char* str,
-                           uint16_t fgColor, uint16_t bgColor,
+                           UIColor fgColor, UIColor bgColor,
                            uint8_t size,
                            uint16_t padX, uint16_t padY,
                            bool wrap);
 
+// One line of scrolling text clipped to the box (x, y, w, font height): str
+// followed by gapChars blanks, repeated, shifted left by scrollPx pixels.
+// The box is composed off-screen and copied in, so each step is one blit.
+void drawStringMarquee(uint16_t x, uint16_t y, uint16_t w,
+                       const char* str, uint8_t gapChars, uint16_t scrollPx,
+                       UIColor fgColor, UIColor bgColor, uint8_t size);
+
 // Word-wrap (line spacing applied internally in .cpp)
 void drawStringWrapWidth(uint16_t x, uint16_t y,
                          const char* str,
-                         uint16_t color, uint16_t bg,
+                         UIColor color, UIColor bg,
                          uint8_t size,
                          uint16_t maxWidthPx);
 
 void drawStringWrapWidth(uint16_t x, uint16_t y,
                          const char* str,
-                         uint16_t color, uint16_t bg,
+                         UIColor color, UIColor bg,
                          uint8_t size,
                          uint16_t maxWidthPx,
                          uint8_t rot);
@@ -153,7 +189,7 @@ void drawStringWrapWidth(uint16_t x, uint16_t y,
 
 void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
                                  const char* str,
-                                 uint16_t color, uint16_t bg,
+                                 UIColor color, UIColor bg,
                                  uint8_t size,
                                  uint16_t maxWidthPx,
                                  uint16_t maxHeightPx,
@@ -161,7 +197,7 @@ void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
 
 void drawStringWrapWidthScrolled(uint16_t x, uint16_t y,
                                  const char* str,
-                                 uint16_t color, uint16_t bg,
+                                 UIColor color, UIColor bg,
                                  uint8_t size,
                                  uint16_t maxWidthPx,
                                  uint16_t maxHeightPx,
@@ -175,7 +211,7 @@ uint16_t measureWrappedTextHeight(const char* str,
 
 void drawStringWrapWidthScrolledTailAware(uint16_t x, uint16_t y,
                                           const char* str,
-                                          uint16_t color, uint16_t bg,
+                                          UIColor color, UIColor bg,
                                           uint8_t size,
                                           uint16_t maxWidthPx,
                                           uint16_t maxHeightPx,
@@ -185,3 +221,32 @@ void drawStringWrapWidthScrolledTailAware(uint16_t x, uint16_t y,
 #ifndef TEXT_EXTRA_SPACING
 #define TEXT_EXTRA_SPACING 6
 #endif
+
+// Dirty-region tracking: LCD_Present() sends only the rectangles drawn since
+// the last present. Rects closer than MERGE_SLACK pixels of overdraw are merged.
+#ifndef LCD_DIRTY_MAX_RECTS
+#define LCD_DIRTY_MAX_RECTS 8
+#endif
+#ifndef LCD_DIRTY_MERGE_SLACK
+#define LCD_DIRTY_MERGE_SLACK 1024
+#endif
+
+// DMA staging holds two strips of this many rows along the long side. Set it
+// to half the panel height or more to stage a whole frame per present.
+#ifndef LCD_DMA_STRIP_ROWS
+#define LCD_DMA_STRIP_ROWS 16
+#endif
+
+// 1 = keep the framebuffer as 8-bit indices into a colour table (half the
+// RAM). Rows are expanded to RGB565, STRIP_ROWS at a time, during present.
+#ifndef LCD_INDEXED_FRAMEBUFFER
+#define LCD_INDEXED_FRAMEBUFFER 0
+#endif
+#ifndef LCD_INDEXED_STRIP_ROWS
+#define LCD_INDEXED_STRIP_ROWS 16
+#endif
+
+// Start with the stats overlay on (see LCD_SetStatsOverlay).
+#ifndef LCD_STATS_OVERLAY
+#define LCD_STATS_OVERLAY 0
+#endif
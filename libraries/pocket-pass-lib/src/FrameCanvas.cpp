@@ -0,0 +1,41 @@
+// FrameCanvas.cpp
+
+#include "FrameCanvas.h"
+
+void IndexedFormat::setEntry(uint8_t i, uint16_t c) {
+  colors_[i] = c;
+  wire_[i] = Rgb565Format::toBuffer(c);
+}
+
+void IndexedFormat::setRoles(const uint16_t* colors, uint8_t n) {
+  roles_ = (n < kRoleCount) ? n : kRoleCount;
+  for (uint8_t i = 0; i < roles_; ++i) setEntry(i, colors[i]);
+}
+
+IndexedFormat::Pixel IndexedFormat::lookup(uint16_t c) {
+  for (uint16_t i = kRoleCount; i < used_; ++i) {
+    if (colors_[i] == c) return (Pixel)i;
+  }
+  if (used_ < 256) {
+    setEntry((uint8_t)used_, c);
+    return (Pixel)used_++;
+  }
+
+  // Table full: nearest extra by squared distance in 5/6/5 space. Role entries
+  // are left out, since they change colour with the palette.
+  const int32_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+  Pixel best = kRoleCount;
+  int32_t bestD = INT32_MAX;
+  for (uint16_t i = kRoleCount; i < 256; ++i) {
+    const uint16_t e = colors_[i];
+    const int32_t dr = r - ((e >> 11) & 0x1F);
+    const int32_t dg = g - ((e >> 5) & 0x3F);
+    const int32_t db = b - (e & 0x1F);
+    const int32_t d = 4 * dr * dr + dg * dg + 4 * db * db;
+    if (d < bestD) {
+      bestD = d;
+      best = (Pixel)i;
+    }
+  }
+  return best;
+}
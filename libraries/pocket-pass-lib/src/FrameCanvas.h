@@ -0,0 +1,257 @@
+// FrameCanvas.h
+#pragma once
+#include <Arduino.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "UIColor.h"
+#include "fonts/BitmapFont.h"
+
+// A heap pixel buffer with the drawing primitives the UI uses. Nothing here
+// touches a panel, so the same code renders on the device and on a host.
+// Every colour argument is a UIColor; the Format turns it into a stored pixel
+// (toBuffer) and back into the panel's wire order (toWire).
+
+// 16 bits per pixel, stored byte-swapped (high byte first in memory), the
+// order the ST7789 reads over SPI, so dirty rows can be sent as they are.
+struct Rgb565Format {
+  typedef uint16_t Pixel;
+  static Pixel toBuffer(uint16_t c) { return (uint16_t)((c >> 8) | (c << 8)); }
+  static uint16_t toWire(Pixel p) { return p; }
+  static uint16_t toColor(Pixel p) { return toBuffer(p); }
+};
+
+// 8 bits per pixel, an index into a 256-entry colour table. The first
+// kRoleCount entries are the UI palette roles (setRoles): a colour tagged with
+// a role is stored as that role's entry, never searched for by value, so a
+// palette switch rewrites those entries and every pixel drawn in a palette
+// role changes with it, even where two roles share a colour. Untagged colours
+// get the next free entry after the roles, or the nearest one once the table
+// is full.
+class IndexedFormat {
+public:
+  typedef uint8_t Pixel;
+  static const uint8_t kRoleCount = 8;
+
+  Pixel toBuffer(UIColor c) { return c.role < roles_ ? c.role : lookup(c.rgb); }
+  uint16_t toWire(Pixel p) const { return wire_[p]; }
+  uint16_t toColor(Pixel p) const { return colors_[p]; }
+  const uint16_t* wireTable() const { return wire_; }
+
+  void setRoles(const uint16_t* colors, uint8_t n);
+  // Drops the non-role entries. Only safe when no pixel still uses them.
+  void resetExtras() { used_ = kRoleCount; }
+
+private:
+  uint16_t colors_[256] = {};
+  uint16_t wire_[256] = {};
+  uint8_t  roles_ = 0;
+  uint16_t used_ = kRoleCount;
+
+  void setEntry(uint8_t i, uint16_t c);
+  Pixel lookup(uint16_t c);
+};
+
+template <typename Format>
+class BasicFrameCanvas {
+public:
+  typedef typename Format::Pixel Pixel;
+
+  ~BasicFrameCanvas() { destroy(); }
+
+  // Allocates w x h pixels, cleared to pixel value 0. Returns false if out of memory.
+  bool create(uint16_t w, uint16_t h) {
+    destroy();
+    if (w == 0 || h == 0) return false;
+    pixels_ = (Pixel*)calloc((size_t)w * h, sizeof(Pixel));
+    if (!pixels_) return false;
+    w_ = w;
+    h_ = h;
+    return true;
+  }
+
+  void destroy() {
+    free(pixels_);
+    pixels_ = nullptr;
+    w_ = 0;
+    h_ = 0;
+  }
+
+  Pixel* pixels() { return pixels_; }
+  const Pixel* pixels() const { return pixels_; }
+  uint16_t width() const { return w_; }
+  uint16_t height() const { return h_; }
+
+  Format& format() { return fmt_; }
+  const Format& format() const { return fmt_; }
+  Pixel toBuffer(UIColor c) { return fmt_.toBuffer(c); }
+  uint16_t toWire(Pixel p) const { return fmt_.toWire(p); }
+  uint16_t toColor(Pixel p) const { return fmt_.toColor(p); }
+
+  // All primitives clip to the canvas.
+  void fill(UIColor color) {
+    if (!pixels_) return;
+    fillSpan(pixels_, (int32_t)w_ * h_, toBuffer(color));
+  }
+
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, UIColor color) {
+    if (!pixels_) return;
+    int32_t x1 = x + w;
+    int32_t y1 = y + h;
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 > (int32_t)w_) x1 = w_;
+    if (y1 > (int32_t)h_) y1 = h_;
+    if (x >= x1 || y >= y1) return;
+
+    const Pixel px = toBuffer(color);
+    Pixel* row = pixels_ + (uint32_t)y * w_ + x;
+    if (x == 0 && x1 == (int32_t)w_) {
+      fillSpan(row, (x1 - x) * (y1 - y), px);
+      return;
+    }
+    for (int32_t yy = y; yy < y1; ++yy, row += w_) fillSpan(row, x1 - x, px);
+  }
+
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, UIColor color) { fillRect(x, y, w, 1, color); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, UIColor color) { fillRect(x, y, 1, h, color); }
+
+  void drawPixel(int32_t x, int32_t y, UIColor color) {
+    if (!pixels_ || x < 0 || y < 0 || x >= (int32_t)w_ || y >= (int32_t)h_) return;
+    pixels_[(uint32_t)y * w_ + x] = toBuffer(color);
+  }
+
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, UIColor color) {
+    if (y0 == y1) {
+      if (x1 < x0) { const int32_t t = x0; x0 = x1; x1 = t; }
+      drawFastHLine(x0, y0, x1 - x0 + 1, color);
+      return;
+    }
+    if (x0 == x1) {
+      if (y1 < y0) { const int32_t t = y0; y0 = y1; y1 = t; }
+      drawFastVLine(x0, y0, y1 - y0 + 1, color);
+      return;
+    }
+
+    // Bresenham, one pixel per step of the major axis.
+    const Pixel px = toBuffer(color);
+    const int32_t dx = abs(x1 - x0);
+    const int32_t dy = -abs(y1 - y0);
+    const int32_t sx = (x0 < x1) ? 1 : -1;
+    const int32_t sy = (y0 < y1) ? 1 : -1;
+    int32_t err = dx + dy;
+    while (true) {
+      plot(x0, y0, px);
+      if (x0 == x1 && y0 == y1) break;
+      const int32_t e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x0 += sx; }
+      if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+  }
+
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, UIColor color) {
+    if (w <= 0 || h <= 0) return;
+    drawFastHLine(x, y, w, color);
+    drawFastHLine(x, y + h - 1, w, color);
+    drawFastVLine(x, y, h, color);
+    drawFastVLine(x + w - 1, y, h, color);
+  }
+
+  void drawCircle(int32_t xc, int32_t yc, int32_t r, UIColor color) {
+    if (r < 0) return;
+    // Midpoint circle, eight octants per step.
+    const Pixel px = toBuffer(color);
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t f = 1 - r;
+    while (x <= y) {
+      plot(xc + x, yc + y, px);
+      plot(xc - x, yc + y, px);
+      plot(xc + x, yc - y, px);
+      plot(xc - x, yc - y, px);
+      plot(xc + y, yc + x, px);
+      plot(xc - y, yc + x, px);
+      plot(xc + y, yc - x, px);
+      plot(xc - y, yc - x, px);
+      ++x;
+      if (f < 0) {
+        f += 2 * x + 1;
+      } else {
+        --y;
+        f += 2 * (x - y) + 1;
+      }
+    }
+  }
+
+  void fillCircle(int32_t xc, int32_t yc, int32_t r, UIColor color) {
+    if (r < 0) return;
+    // Same walk as drawCircle, filling the spans between mirrored points.
+    int32_t x = 0;
+    int32_t y = r;
+    int32_t f = 1 - r;
+    while (x <= y) {
+      drawFastHLine(xc - y, yc + x, 2 * y + 1, color);
+      drawFastHLine(xc - y, yc - x, 2 * y + 1, color);
+      drawFastHLine(xc - x, yc + y, 2 * x + 1, color);
+      drawFastHLine(xc - x, yc - y, 2 * x + 1, color);
+      ++x;
+      if (f < 0) {
+        f += 2 * x + 1;
+      } else {
+        --y;
+        f += 2 * (x - y) + 1;
+      }
+    }
+  }
+
+  // 5x7 font text at (x, y); bg is painted only when opaque. Returns the advance.
+  int16_t drawText(const char* str, int32_t x, int32_t y,
+                   UIColor fg, UIColor bg, bool opaque, uint8_t size) {
+    if (!pixels_) return 0;
+    const Pixel fgPx = toBuffer(fg);
+    const Pixel bgPx = opaque ? toBuffer(bg) : fgPx;
+    return (int16_t)fontDrawString(pixels_, w_, h_, x, y, str, fgPx, bgPx, opaque, size);
+  }
+
+  // Copies a w x h block of stored pixels, clipped.
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const Pixel* src) {
+    if (!pixels_ || !src || w <= 0 || h <= 0) return;
+    const int32_t srcW = w;
+    int32_t sx = 0;
+    int32_t sy = 0;
+    if (x < 0) { sx = -x; w += x; x = 0; }
+    if (y < 0) { sy = -y; h += y; y = 0; }
+    if (x + w > (int32_t)w_) w = (int32_t)w_ - x;
+    if (y + h > (int32_t)h_) h = (int32_t)h_ - y;
+    if (w <= 0 || h <= 0) return;
+
+    for (int32_t row = 0; row < h; ++row) {
+      memcpy(pixels_ + (uint32_t)(y + row) * w_ + x,
+             src + (uint32_t)(sy + row) * srcW + sx,
+             (size_t)w * sizeof(Pixel));
+    }
+  }
+
+private:
+  Pixel*   pixels_ = nullptr;
+  uint16_t w_ = 0;
+  uint16_t h_ = 0;
+  Format   fmt_;
+
+  void plot(int32_t x, int32_t y, Pixel px) {
+    if (x < 0 || y < 0 || x >= (int32_t)w_ || y >= (int32_t)h_) return;
+    pixels_[(uint32_t)y * w_ + x] = px;
+  }
+
+  static void fillSpan(Pixel* dst, int32_t n, Pixel px) {
+    // One-byte pixels, or a colour whose two bytes match (black, white), are a memset.
+    if (sizeof(Pixel) == 1 || (px >> 8) == (px & 0xFF)) {
+      memset(dst, px & 0xFF, (size_t)n * sizeof(Pixel));
+      return;
+    }
+    for (int32_t i = 0; i < n; ++i) dst[i] = px;
+  }
+};
+
+typedef BasicFrameCanvas<Rgb565Format> FrameCanvas;
+typedef BasicFrameCanvas<IndexedFormat> IndexedFrameCanvas;
@@ -0,0 +1,173 @@
+// HostDisplayBackend.cpp
+
+#ifdef LCD_HOST_BACKEND
+
+#include "HostDisplayBackend.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+void HostDisplayBackend::begin() {
+  setRotation(0);
+}
+
+void HostDisplayBackend::setRotation(uint8_t rot) {
+  const bool portrait = (rot & 1) == 0;
+  const uint16_t w = portrait ? LCD_WIDTH : LCD_HEIGHT;
+  const uint16_t h = portrait ? LCD_HEIGHT : LCD_WIDTH;
+  // Like the real controller, GRAM keeps its contents across a rotation only
+  // when the shape does not change.
+  if (w != panel_.width() || h != panel_.height()) panel_.create(w, h);
+}
+
+void HostDisplayBackend::pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                  const uint16_t* pixels, uint16_t stride) {
+  const uint64_t t0 = nowNs();
+  for (uint16_t row = 0; row < h; ++row) {
+    panel_.pushImage(x, y + row, w, 1, pixels + (uint32_t)row * stride);
+  }
+  timing_.rects++;
+  timing_.pixels += (uint64_t)w * h;
+  timing_.ns += nowNs() - t0;
+}
+
+uint16_t HostDisplayBackend::pixel(uint16_t x, uint16_t y) const {
+  if (!panel_.pixels() || x >= panel_.width() || y >= panel_.height()) return 0;
+  return panel_.toColor(panel_.pixels()[(uint32_t)y * panel_.width() + x]);
+}
+
+uint32_t HostDisplayBackend::diff(const HostDisplayBackend& other) const {
+  if (width() != other.width() || height() != other.height()) return UINT32_MAX;
+  const uint32_t n = (uint32_t)width() * height();
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < n; ++i) {
+    if (panel_.pixels()[i] != other.panel_.pixels()[i]) count++;
+  }
+  return count;
+}
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* p, size_t n) {
+  crc = ~crc;
+  for (size_t i = 0; i < n; ++i) {
+    crc ^= p[i];
+    for (uint8_t k = 0; k < 8; ++k) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+  }
+  return ~crc;
+}
+
+uint32_t HostDisplayBackend::crc32() const {
+  uint32_t crc = 0;
+  std::vector<uint8_t> row((size_t)width() * 2);
+  for (uint16_t y = 0; y < height(); ++y) {
+    for (uint16_t x = 0; x < width(); ++x) {
+      const uint16_t c = pixel(x, y);
+      row[2 * x] = (uint8_t)c;
+      row[2 * x + 1] = (uint8_t)(c >> 8);
+    }
+    crc = crc32Update(crc, row.data(), row.size());
+  }
+  return crc;
+}
+
+// Expands one row to 8-bit RGB, replicating the high bits into the low ones so
+// full-scale 565 maps to 255.
+void HostDisplayBackend::rgbRow(uint16_t y, uint8_t* out) const {
+  for (uint16_t x = 0; x < width(); ++x) {
+    const uint16_t c = pixel(x, y);
+    const uint8_t r = (uint8_t)((c >> 11) & 0x1F);
+    const uint8_t g = (uint8_t)((c >> 5) & 0x3F);
+    const uint8_t b = (uint8_t)(c & 0x1F);
+    *out++ = (uint8_t)((r << 3) | (r >> 2));
+    *out++ = (uint8_t)((g << 2) | (g >> 4));
+    *out++ = (uint8_t)((b << 3) | (b >> 2));
+  }
+}
+
+bool HostDisplayBackend::writePPM(const char* path) const {
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  fprintf(f, "P6\n%u %u\n255\n", (unsigned)width(), (unsigned)height());
+  std::vector<uint8_t> row((size_t)width() * 3);
+  bool ok = true;
+  for (uint16_t y = 0; y < height() && ok; ++y) {
+    rgbRow(y, row.data());
+    ok = fwrite(row.data(), 1, row.size(), f) == row.size();
+  }
+  return (fclose(f) == 0) && ok;
+}
+
+static void pngPut32(std::vector<uint8_t>& out, uint32_t v) {
+  out.push_back((uint8_t)(v >> 24));
+  out.push_back((uint8_t)(v >> 16));
+  out.push_back((uint8_t)(v >> 8));
+  out.push_back((uint8_t)v);
+}
+
+static void pngChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+  pngPut32(out, (uint32_t)data.size());
+  const size_t typeAt = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  pngPut32(out, crc32Update(0, out.data() + typeAt, out.size() - typeAt));
+}
+
+// Uncompressed PNG: the zlib stream uses stored deflate blocks, which keeps the
+// writer tiny. Panel-sized images are a few hundred KB, fine for test output.
+bool HostDisplayBackend::writePNG(const char* path) const {
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)height() * ((size_t)width() * 3 + 1));
+  std::vector<uint8_t> row((size_t)width() * 3);
+  for (uint16_t y = 0; y < height(); ++y) {
+    rgbRow(y, row.data());
+    raw.push_back(0); // filter: none
+    raw.insert(raw.end(), row.begin(), row.end());
+  }
+
+  std::vector<uint8_t> z = { 0x78, 0x01 };
+  size_t off = 0;
+  do {
+    const size_t n = (raw.size() - off > 65535) ? 65535 : raw.size() - off;
+    z.push_back(off + n == raw.size() ? 1 : 0); // BFINAL, BTYPE = stored
+    z.push_back((uint8_t)n);
+    z.push_back((uint8_t)(n >> 8));
+    z.push_back((uint8_t)~n);
+    z.push_back((uint8_t)(~n >> 8));
+    z.insert(z.end(), raw.begin() + off, raw.begin() + off + n);
+    off += n;
+  } while (off < raw.size());
+  uint32_t a = 1, b = 0;
+  for (uint8_t v : raw) {
+    a = (a + v) % 65521u;
+    b = (b + a) % 65521u;
+  }
+  pngPut32(z, (b << 16) | a);
+
+  std::vector<uint8_t> ihdr;
+  pngPut32(ihdr, width());
+  pngPut32(ihdr, height());
+  ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 }); // 8-bit RGB, no interlace
+
+  static const uint8_t kSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  std::vector<uint8_t> png(kSignature, kSignature + 8);
+  pngChunk(png, "IHDR", ihdr);
+  pngChunk(png, "IDAT", z);
+  pngChunk(png, "IEND", std::vector<uint8_t>());
+
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+  const bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+  return (fclose(f) == 0) && ok;
+}
+
+uint64_t HostDisplayBackend::nowNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+DisplayBackend& LCD_DefaultBackend() {
+  static HostDisplayBackend backend;
+  return backend;
+}
+
+#endif // LCD_HOST_BACKEND
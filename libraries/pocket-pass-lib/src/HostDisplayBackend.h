@@ -0,0 +1,81 @@
+// HostDisplayBackend.h
+#pragma once
+
+#ifdef LCD_HOST_BACKEND
+
+#include "DisplayBackend.h"
+#include "Display_ST7789.h"
+#include "FrameCanvas.h"
+
+// An in-memory ST7789 for host builds: presents land in a RGB565 buffer that
+// can be inspected, compared against golden images or written out as PPM/PNG.
+// The host supplies its own Arduino.h (millis, micros, String, pgm_read_byte).
+//
+//   HostDisplayBackend panel;
+//   LCD_SetBackend(&panel);
+//   LCD_Init();
+//   ... draw, LCD_Present() ...
+//   panel.writePNG("menu.png");
+class HostDisplayBackend : public DisplayBackend {
+public:
+  // Cost of every pushRect() since construction or resetTiming().
+  struct Timing {
+    uint32_t rects;
+    uint64_t pixels;
+    uint64_t ns;
+  };
+
+  void begin() override;
+  void setRotation(uint8_t rot) override;
+
+  void pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                const uint16_t* pixels, uint16_t stride) override;
+
+  void fillScreen(uint16_t color) override { panel_.fill(color); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override { panel_.fillRect(x, y, w, h, color); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint16_t color) override { panel_.drawFastHLine(x, y, w, color); }
+  void drawPixel(int32_t x, int32_t y, uint16_t color) override { panel_.drawPixel(x, y, color); }
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) override { panel_.drawLine(x0, y0, x1, y1, color); }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override { panel_.drawRect(x, y, w, h, color); }
+  void drawCircle(int32_t xc, int32_t yc, int32_t r, uint16_t color) override { panel_.drawCircle(xc, yc, r, color); }
+  void fillCircle(int32_t xc, int32_t yc, int32_t r, uint16_t color) override { panel_.fillCircle(xc, yc, r, color); }
+  int16_t drawText(const char* str, int32_t x, int32_t y,
+                   uint16_t fg, uint16_t bg, bool opaque, uint8_t size) override {
+    return panel_.drawText(str, x, y, fg, bg, opaque, size);
+  }
+
+  uint16_t width() const { return panel_.width(); }
+  uint16_t height() const { return panel_.height(); }
+  // Plain RGB565 as the panel would show it; 0 if out of range.
+  uint16_t pixel(uint16_t x, uint16_t y) const;
+  // Pixels that differ from other's, or UINT32_MAX if the sizes differ.
+  uint32_t diff(const HostDisplayBackend& other) const;
+  // CRC-32 of the plain RGB565 pixels (little-endian, row by row): a compact
+  // golden value for a whole frame.
+  uint32_t crc32() const;
+
+  // 8-bit RGB dumps of the panel. Return false if the file can't be written.
+  bool writePPM(const char* path) const;
+  bool writePNG(const char* path) const;
+
+  const Timing& timing() const { return timing_; }
+  void resetTiming() { timing_ = Timing(); }
+
+  // Monotonic clock, and the mean ns per call of fn over reps calls.
+  static uint64_t nowNs();
+  template <typename Fn>
+  static uint64_t timeNs(Fn fn, uint32_t reps) {
+    if (reps == 0) return 0;
+    const uint64_t t0 = nowNs();
+    for (uint32_t i = 0; i < reps; ++i) fn();
+    return (nowNs() - t0) / reps;
+  }
+
+private:
+  FrameCanvas panel_;
+  Timing timing_ = {};
+
+  void rgbRow(uint16_t y, uint8_t* out) const;
+};
+
+#endif // LCD_HOST_BACKEND
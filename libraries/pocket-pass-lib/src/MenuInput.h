@@ -0,0 +1,18 @@
+// MenuInput.h
+#pragma once
+
+// The input events RotaryMarqueeMenu reads. SimpleRotaryController supplies
+// them on the device; host tests drive the menu through a scripted one.
+class MenuInput {
+public:
+  virtual ~MenuInput() {}
+
+  // Polled once per menu loop, before the was*() edges are read.
+  virtual void update() = 0;
+
+  // Edge flags: true once per event, cleared by the read.
+  virtual bool wasTurnedCW() = 0;
+  virtual bool wasTurnedCCW() = 0;
+  virtual bool wasPressedA() = 0; // back
+  virtual bool wasPressedB() = 0; // select
+};
@@ -2,10 +2,12 @@
 // RotaryMarqueeMenu.cpp
 #include "RotaryMarqueeMenu.h"
 #include <vector>
+#include "TextLayout.h"
+#include "fonts/BitmapFont.h"
 
 // ============== Public API ==============
 
-void RotaryMarqueeMenu::begin(SimpleRotaryController& encoder,
+void RotaryMarqueeMenu::begin(MenuInput& encoder,
                               uint8_t lcdOrientation,
                               uint8_t backlight) {
   // Bind external encoder (must already be initialized by caller)
@@ -162,8 +164,8 @@ void RotaryMarqueeMenu::setSelectedIndex(int8_t idx) {
 }
 
 void RotaryMarqueeMenu::redrawHeader() {
-  const uint16_t bg = UI_ColorBg();
-  const uint16_t fg = UI_ColorFg();
+  const UIColor bg = UI_ColorBg();
+  const UIColor fg = UI_ColorFg();
   // Clear header band and redraw stripes and text
   LCD_FillRect(0, startY - 2, LCD_Width(), 46, bg);
   LCD_DrawLine(0, startY + 8,  LCD_Width() - 1, startY + 8,  fg);
@@ -197,8 +199,8 @@ void RotaryMarqueeMenu::calcRowMetrics() {
 }
 
 void RotaryMarqueeMenu::drawStaticUI() {
-  const uint16_t bg = UI_ColorBg();
-  const uint16_t fg = UI_ColorFg();
+  const UIColor bg = UI_ColorBg();
+  const UIColor fg = UI_ColorFg();
   LCD_DrawLine(0, startY + 8,  LCD_Width() - 1, startY + 8,  fg);
   LCD_DrawLine(0, startY + 10, LCD_Width() - 1, startY + 10, fg);
 
@@ -232,10 +234,10 @@ void RotaryMarqueeMenu::drawVisibleWindow() {
 }
 
 void RotaryMarqueeMenu::drawVisibleItem(uint8_t visRow, uint8_t absIndex, bool selected) {
-  const uint16_t bg = UI_ColorBg();
-  const uint16_t fg = UI_ColorFg();
-  const uint16_t selectedBg = UI_ColorSelectedBg();
-  const uint16_t selectedFg = UI_ColorSelectedFg();
+  const UIColor bg = UI_ColorBg();
+  const UIColor fg = UI_ColorFg();
+  const UIColor selectedBg = UI_ColorSelectedBg();
+  const UIColor selectedFg = UI_ColorSelectedFg();
 
   clearRow(visRow, selected ? selectedBg : bg);
   uint16_t y = rowY(visRow);
@@ -250,12 +252,12 @@ void RotaryMarqueeMenu::drawVisibleItem(uint8_t visRow, uint8_t absIndex, bool s
   }
 }
 
-void RotaryMarqueeMenu::clearRow(uint8_t visRow, uint16_t bgColor) {
+void RotaryMarqueeMenu::clearRow(uint8_t visRow, UIColor bgColor) {
   // Slightly taller to cover font ascent/descenders
   LCD_FillRect(MENU_ROW_X, rowY(visRow) - 4, 300, MENU_ROW_H + 4, bgColor);
 }
 
-void RotaryMarqueeMenu::clearTextArea(uint8_t visRow, uint16_t bgColor) {
+void RotaryMarqueeMenu::clearTextArea(uint8_t visRow, UIColor bgColor) {
   uint16_t y = rowY(visRow);
   uint16_t w = MENU_ROW_W - (MENU_TEXT_X - MENU_ROW_X);
   LCD_FillRect(MENU_TEXT_X, y, w, MENU_ROW_H, bgColor);
@@ -340,10 +342,24 @@ void RotaryMarqueeMenu::handleBack() {
 }
 
 // ===== Row (menu items) Marquee =====
+// Both marquees scroll by whole pixels over a circular view of the label
+// (label + gap, repeated); nothing is copied or allocated per step.
+static const uint8_t kMarqueeTextSize = 2;
+
+// Pixels due since lastStep when scrolling one character per stepIntervalMs.
+// Moves lastStep forward by the time consumed; returns false when none are due.
+static bool advanceMarquee(unsigned long now, uint16_t stepIntervalMs,
+                           unsigned long& lastStep, uint32_t& pixels) {
+  const unsigned long pxMs = max<unsigned long>(1UL, stepIntervalMs / fontCharWidth(' ', kMarqueeTextSize));
+  if (now - lastStep < pxMs) return false;
+  pixels = (uint32_t)((now - lastStep) / pxMs);
+  lastStep += pixels * pxMs;
+  return true;
+}
+
 void RotaryMarqueeMenu::resetMarquee() {
   marqueeActive = false;
   marqueeOffset = 0;
-  marqueeLoop = "";
   marqueeLoopLen = 0;
   marqueeStartTime = millis();
   lastMarqueeStep = millis();
@@ -364,67 +380,44 @@ void RotaryMarqueeMenu::maybeStartOrStepMarquee() {
   if (!marqueeActive) {
     if (now - marqueeStartTime < marqueeStartDelayMs) return;
 
-    marqueeLoop = String(text) + MARQUEE_GAP + String(text) + MARQUEE_GAP;
-    marqueeLoopLen = marqueeLoop.length();
-
-    marqueeWindowChars = max<uint8_t>(marqueeThreshold, 21);
+    // Two passes over label + gap, then pause at the start again.
+    marqueeLoopLen = (uint16_t)(2u * (len + strlen(MARQUEE_GAP)) * fontCharWidth(' ', kMarqueeTextSize));
     marqueeOffset = 0;
     marqueeActive = true;
     lastMarqueeStep = now;
   }
 
-  if (now - lastMarqueeStep < marqueeStepIntervalMs) return;
-  lastMarqueeStep = now;
+  uint32_t pixels = 0;
+  if (!advanceMarquee(now, marqueeStepIntervalMs, lastMarqueeStep, pixels)) return;
 
-  marqueeOffset++;
-  if (marqueeOffset >= marqueeLoopLen) {
+  uint8_t visRow = selectedIndex - topIndex;
+  if ((uint32_t)marqueeOffset + pixels >= marqueeLoopLen) {
     marqueeOffset = 0;
     marqueeActive = false;
     marqueeStartTime = now;
     // Draw one frame at offset 0 immediately
-    if (selectedIndex >= topIndex && selectedIndex < topIndex + visibleRows) {
-      uint8_t visRow = selectedIndex - topIndex;
-      drawSelectedWithMarquee(visRow);
-    }
+    drawSelectedWithMarquee(visRow);
     return;
   }
 
   // Draw current marquee frame
-  uint8_t visRow = selectedIndex - topIndex;
+  marqueeOffset = (uint16_t)(marqueeOffset + pixels);
   drawSelectedWithMarquee(visRow);
 }
 
 void RotaryMarqueeMenu::drawSelectedWithMarquee(uint8_t visRow) {
   if (marqueeLoopLen == 0) return;
 
-  const uint8_t MAX_BUF = 64;
-  uint8_t n = marqueeWindowChars;
-  if (n > MAX_BUF - 1) n = MAX_BUF - 1;
-
-  char buf[MAX_BUF];
-  for (uint8_t i = 0; i < n; i++) {
-    uint16_t idx = (marqueeOffset + i) % marqueeLoopLen;
-    buf[i] = marqueeLoop[idx];
-  }
-  buf[n] = '\0';
-
-  // Clear only text area with WHITE (selected bg), keep cursor area
-  clearTextArea(visRow, UI_ColorSelectedBg());
-
-  uint16_t y = rowY(visRow);
-
-  // Ensure cursor is visible
-  drawString(mStartX, y, "> ", UI_ColorSelectedFg(), UI_ColorSelectedBg(), 2, false);
-
-  drawStringWithPadding(MENU_TEXT_X, y, buf, UI_ColorSelectedFg(), UI_ColorSelectedBg(), 2, 8, 4, false);
+  // The cursor sits left of MENU_TEXT_X, so only the text box is redrawn.
+  drawStringMarquee(MENU_TEXT_X, rowY(visRow), LCD_Width() - MENU_TEXT_X,
+                    itemAt(selectedIndex), (uint8_t)strlen(MARQUEE_GAP), marqueeOffset,
+                    UI_ColorSelectedFg(), UI_ColorSelectedBg(), kMarqueeTextSize);
 }
 
 // ===== Subtitle Marquee =====
 void RotaryMarqueeMenu::resetSubMarquee() {
   subMarqueeActive = false;
   subMarqueeOffset = 0;
-  subMarqueeLoop = "";
-  subMarqueeLoopLen = 0;
   subMarqueeStartTime = millis();
   lastSubMarqueeStep = millis();
 }
@@ -438,9 +431,8 @@ void RotaryMarqueeMenu::maybeStartOrStepSubMarquee() {
   if (!subMarqueeActive) {
     if (now - subMarqueeStartTime < subMarqueeStartDelayMs) return;
 
-    // Build loop
-    subMarqueeLoop = subTitle + String(SUB_MARQUEE_GAP) + subTitle + String(SUB_MARQUEE_GAP);
-    subMarqueeLoopLen = subMarqueeLoop.length();
+    subMarqueeLoopLen = (uint16_t)(2u * (subTitle.length() + strlen(SUB_MARQUEE_GAP)) *
+                                   fontCharWidth(' ', kMarqueeTextSize));
     subMarqueeOffset = 0;
     subMarqueeActive = true;
     lastSubMarqueeStep = now;
@@ -450,11 +442,10 @@ void RotaryMarqueeMenu::maybeStartOrStepSubMarquee() {
     return;
   }
 
-  if (now - lastSubMarqueeStep < subMarqueeStepIntervalMs) return;
-  lastSubMarqueeStep = now;
+  uint32_t pixels = 0;
+  if (!advanceMarquee(now, subMarqueeStepIntervalMs, lastSubMarqueeStep, pixels)) return;
 
-  subMarqueeOffset++;
-  if (subMarqueeOffset >= subMarqueeLoopLen) {
+  if ((uint32_t)subMarqueeOffset + pixels >= subMarqueeLoopLen) {
     subMarqueeOffset = 0;
     subMarqueeActive = false;
     subMarqueeStartTime = now;
@@ -464,6 +455,7 @@ void RotaryMarqueeMenu::maybeStartOrStepSubMarquee() {
     return;
   }
 
+  subMarqueeOffset = (uint16_t)(subMarqueeOffset + pixels);
   drawSubtitleFrame();
 }
 
@@ -472,37 +464,18 @@ void RotaryMarqueeMenu::drawSubtitleFrame() {
   uint16_t x = startX + 20;
   uint16_t y = startY + 25;
 
-  // Clear the subtitle text area (keep header background as BLACK)
-  LCD_FillRect(x, y, LCD_Width() - x, 20, UI_ColorBg());
-
   // If short, just draw normally
   if ((uint16_t)subTitle.length() <= subMarqueeThreshold) {
+    LCD_FillRect(x, y, LCD_Width() - x, 20, UI_ColorBg());
     drawStringWithPadding(x, y, subTitle.c_str(), UI_ColorFg(), UI_ColorBg(), 2, 8, 4, false);
     return;
   }
 
-  // Draw marquee slice
-  const uint8_t MAX_BUF = 80; // subtitle slice buffer
-  uint8_t windowChars = 28;
-  if (windowChars > MAX_BUF - 1) windowChars = MAX_BUF - 1;
-
-  if (subMarqueeLoopLen == 0) {
-    // Safety: build loop if not built (should be built by maybeStartOrStepSubMarquee)
-    subMarqueeLoop = subTitle + String(SUB_MARQUEE_GAP) + subTitle + String(SUB_MARQUEE_GAP);
-    subMarqueeLoopLen = subMarqueeLoop.length();
-  }
-
-  char buf[MAX_BUF];
-  for (uint8_t i = 0; i < windowChars; i++) {
-    uint16_t idx = (subMarqueeOffset + i) % subMarqueeLoopLen;
-    buf[i] = subMarqueeLoop[idx];
-  }
-  buf[windowChars] = '\0';
-
-  drawStringWithPadding(x, y, buf, UI_ColorFg(), UI_ColorBg(), 2, 8, 4, false);
+  drawStringMarquee(x, y, LCD_Width() - x, subTitle.c_str(), (uint8_t)strlen(SUB_MARQUEE_GAP),
+                    subMarqueeOffset, UI_ColorFg(), UI_ColorBg(), kMarqueeTextSize);
 }
 
-void RotaryMarqueeMenu::clearScreen(uint16_t bgColor) {
+void RotaryMarqueeMenu::clearScreen(UIColor bgColor) {
   if (bgColor == BLACK) bgColor = UI_ColorBg();
   LCD_Clear(bgColor);
   LCD_FillRect(0, startY - 2, LCD_Width(), 46, bgColor);
@@ -529,65 +502,29 @@ void RotaryMarqueeMenu::clearScreen(uint16_t bgColor) {
 }
 
 // ===== Internal: wrap text and modal =====
-void RotaryMarqueeMenu::wrapTextNoBreak(const String& text, uint8_t maxWidth, std::vector<String>& outLines) {
-  outLines.clear();
-
-  size_t i = 0;
-  const size_t n = text.length();
-
-  auto readToken = [&](String& tok)->bool {
-    while (i < n && (text[i] == ' ' || text[i] == '\t' || text[i] == '\r')) i++;
-    if (i < n && text[i] == '\n') { i++; tok = "\n"; return true; }
-    if (i >= n) return false;
-
-    size_t start = i;
-    while (i < n && text[i] != ' ' && text[i] != '\t' && text[i] != '\r' && text[i] != '\n') i++;
-    tok = text.substring(start, i);
-    return true;
-  };
-
-  String current;
-  auto flushLine = [&]() {
-    if (current.length() > 0) {
-      outLines.push_back(current);
-      current = "";
-    }
-  };
-
-  String tok;
-  while (readToken(tok)) {
-    if (tok == "\n") {
-      flushLine();
-      continue;
-    }
-
-    if ((uint8_t)tok.length() > maxWidth) {
-      flushLine();
-      size_t pos = 0;
-      while (pos < tok.length()) {
-        size_t len = std::min((size_t)maxWidth, (size_t)(tok.length() - pos));
-        outLines.push_back(tok.substring(pos, pos + len));
-        pos += len;
-      }
-      continue;
-    }
-
-    if (current.length() == 0) {
-      current = tok;
-      continue;
-    }
-
-    if ((uint8_t)(current.length() + 1 + tok.length()) > maxWidth) {
-      flushLine();
-      current = tok;
-    } else {
-      current += " ";
-      current += tok;
-    }
+uint8_t RotaryMarqueeMenu::wrapTextNoBreak(const String& text, uint8_t maxWidth,
+                                           std::vector<char>& rowText,
+                                           const char** rows, uint8_t maxRows) {
+  // Menu rows wrap by character count; at size 1 a column is one font cell.
+  TextLayout layout;
+  layout.update(text.c_str(), 1, (uint16_t)(maxWidth * fontCharWidth(' ', 1)));
+
+  size_t bytes = 1;
+  for (uint16_t i = 0; i < layout.lineCount(); ++i) bytes += layout.line(i).len + 1u;
+  rowText.assign(bytes, '\0');
+
+  // Rows point into one NUL-separated buffer, sized up front so it never moves.
+  uint8_t count = 0;
+  size_t used = 0;
+  for (uint16_t i = 0; i < layout.lineCount() && count < maxRows; ++i) {
+    char* row = rowText.data() + used;
+    const uint16_t n = layout.lineText(i, row, (uint16_t)(bytes - used));
+    if (n == 0) continue; // blank lines are not worth a menu row
+    rows[count++] = row;
+    used += n + 1u;
   }
-  flushLine();
-
-  if (outLines.empty()) outLines.push_back("");
+  if (count == 0 && maxRows > 0) rows[count++] = rowText.data();
+  return count;
 }
 
 bool RotaryMarqueeMenu::showInfoModal(const char* ttl,
@@ -596,18 +533,11 @@ bool RotaryMarqueeMenu::showInfoModal(const char* ttl,
                                       const char* finalAction,
                                       uint8_t maxWidth,
                                       bool disableBack) {
-  // Wrap the long text into menu rows
-  std::vector<String> lines;
-  wrapTextNoBreak(longText, maxWidth, lines);
-
-  // Build pointers array (truncate to fit)
+  // Wrap the long text into menu rows (truncate to fit)
   static const uint8_t MAX_ITEMS = 64;
   static const char* itemsBuf[MAX_ITEMS];
-  uint8_t count = 0;
-
-  for (size_t k = 0; k < lines.size() && count + 1 < MAX_ITEMS; ++k) {
-    itemsBuf[count++] = lines[k].c_str();
-  }
+  std::vector<char> rowText;
+  uint8_t count = wrapTextNoBreak(longText, maxWidth, rowText, itemsBuf, MAX_ITEMS - 1);
   itemsBuf[count++] = finalAction && finalAction[0] ? finalAction : "[ NEXT ]";
 
   // Save state that the app might have set
@@ -633,20 +563,19 @@ bool RotaryMarqueeMenu::showInfoModal(const char* ttl,
     enc->update();
 
     // Navigation
-    bool moved = false;
     if (!invertDir_) {
       if (enc->wasTurnedCW()) {
-        if (selectedIndex < (int8_t)count - 1) { setSelectedIndex(selectedIndex + 1); moved = true; }
+        if (selectedIndex < (int8_t)count - 1) { setSelectedIndex(selectedIndex + 1); }
       }
       if (enc->wasTurnedCCW()) {
-        if (selectedIndex > 0) { setSelectedIndex(selectedIndex - 1); moved = true; }
+        if (selectedIndex > 0) { setSelectedIndex(selectedIndex - 1); }
       }
     } else {
       if (enc->wasTurnedCW()) {
-        if (selectedIndex > 0) { setSelectedIndex(selectedIndex - 1); moved = true; }
+        if (selectedIndex > 0) { setSelectedIndex(selectedIndex - 1); }
       }
       if (enc->wasTurnedCCW()) {
-        if (selectedIndex < (int8_t)count - 1) { setSelectedIndex(selectedIndex + 1); moved = true; }
+        if (selectedIndex < (int8_t)count - 1) { setSelectedIndex(selectedIndex + 1); }
       }
     }
 
@@ -1,9 +1,9 @@
 // RotaryMarqueeMenu.h
 #pragma once
 #include <Arduino.h>
-#include <SPI.h>
+#include <vector>
 #include <Display_ST7789.h>
-#include "SimpleRotaryController.h"
+#include "MenuInput.h"
 
 class RotaryMarqueeMenu {
 public:
@@ -21,12 +21,12 @@ public:
   // Row marquee (menu items) config
   uint8_t  marqueeThreshold      = 21;     // characters for row marquee
   uint16_t marqueeStartDelayMs   = 1000;   // ms
-  uint16_t marqueeStepIntervalMs = 400;    // ms
+  uint16_t marqueeStepIntervalMs = 400;    // ms per character, scrolled a pixel at a time
 
   // Subtitle marquee config
   uint8_t  subMarqueeThreshold      = 25;   // characters before subtitle scrolls
   uint16_t subMarqueeStartDelayMs   = 1000; // ms
-  uint16_t subMarqueeStepIntervalMs = 400;  // ms
+  uint16_t subMarqueeStepIntervalMs = 400;  // ms per character
   const char* SUB_MARQUEE_GAP = "          "; // 10 spaces
 
   // Callbacks
@@ -35,8 +35,8 @@ public:
   void setOnSelect(SelectCallback cb) { onSelectCb = cb; }
   void setOnBack(BackCallback cb) { onBackCb = cb; }
 
-  // Life-cycle: pass an already-initialized encoder
-  void begin(SimpleRotaryController& encoder,
+  // Life-cycle: pass an already-initialized encoder (SimpleRotaryController on the device)
+  void begin(MenuInput& encoder,
              uint8_t lcdOrientation = 3, uint8_t backlight = 80);
 
   // Call in loop()
@@ -54,7 +54,7 @@ public:
   // Redraw header if title/subtitle changed externally
   void redrawHeader();
   // Clear the display and redraw UI/menu
-  void clearScreen(uint16_t bgColor = BLACK);
+  void clearScreen(UIColor bgColor = BLACK);
   void setInvertDirection(bool inv) { invertDir_ = inv; }
 
   // Reusable long-text modal (wrapped info screen)
@@ -68,7 +68,7 @@ public:
 
 private:
   // External encoder pointer (not owned)
-  SimpleRotaryController* enc = nullptr;
+  MenuInput* enc = nullptr;
   bool invertDir_ = false;
   const char** menuItems = nullptr;
   uint8_t menuCount = 0;
@@ -90,21 +90,18 @@ private:
 
   // Row marquee (menu items)
   bool           marqueeActive = false;
-  uint16_t       marqueeOffset = 0;
+  uint16_t       marqueeOffset = 0;      // px
   unsigned long  marqueeStartTime = 0;
   unsigned long  lastMarqueeStep  = 0;
-  String         marqueeLoop;
-  uint16_t       marqueeLoopLen = 0;
-  uint8_t        marqueeWindowChars = 21;
+  uint16_t       marqueeLoopLen = 0;  // px per run (two passes of label + gap)
   const char*    MARQUEE_GAP = "                   "; // 19 spaces
 
   // Subtitle marquee
   bool           subMarqueeActive = false;
-  uint16_t       subMarqueeOffset = 0;
+  uint16_t       subMarqueeOffset = 0;   // px
   unsigned long  subMarqueeStartTime = 0;
   unsigned long  lastSubMarqueeStep  = 0;
-  String         subMarqueeLoop;
-  uint16_t       subMarqueeLoopLen = 0;
+  uint16_t       subMarqueeLoopLen = 0;  // px per run
 
   // Callbacks
   SelectCallback onSelectCb = nullptr;
@@ -116,8 +113,8 @@ private:
   void drawStaticUI();
   void drawVisibleWindow();
   void drawVisibleItem(uint8_t visRow, uint8_t absIndex, bool selected);
-  void clearRow(uint8_t visRow, uint16_t bgColor);
-  void clearTextArea(uint8_t visRow, uint16_t bgColor);
+  void clearRow(uint8_t visRow, UIColor bgColor);
+  void clearTextArea(uint8_t visRow, UIColor bgColor);
   void ensureSelectionVisible();
   void redrawSelectionInWindow(int8_t oldAbsIdx, int8_t newAbsIdx);
 
@@ -142,5 +139,7 @@ private:
   }
 
   // Internal helpers for the modal
-  static void wrapTextNoBreak(const String& text, uint8_t maxWidth, std::vector<String>& outLines);
+  static uint8_t wrapTextNoBreak(const String& text, uint8_t maxWidth,
+                                 std::vector<char>& rowText,
+                                 const char** rows, uint8_t maxRows);
 };
\ No newline at end of file
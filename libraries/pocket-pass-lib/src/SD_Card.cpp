@@ -37,9 +37,9 @@ void SD_Init() {
     uint64_t totalBytes = SD_MMC.totalBytes();
     uint64_t usedBytes = SD_MMC.usedBytes();
     SDCard_Size = totalBytes/(1024*1024);
-    printf("Total space: %llu\n", totalBytes);
-    printf("Used space: %llu\n", usedBytes);
-    printf("Free space: %llu\n", totalBytes - usedBytes);
+    printf("Total space: %llu\n", (unsigned long long)totalBytes);
+    printf("Used space: %llu\n", (unsigned long long)usedBytes);
+    printf("Free space: %llu\n", (unsigned long long)(totalBytes - usedBytes));
   }
 }
 
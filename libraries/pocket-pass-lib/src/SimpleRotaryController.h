@@ -1,8 +1,9 @@
 //SimpleRotaryController.h
 #pragma once
 #include <Arduino.h>
+#include "MenuInput.h"
 
-class SimpleRotaryController {
+class SimpleRotaryController : public MenuInput {
 public:
   SimpleRotaryController();
 
@@ -13,24 +14,24 @@ public:
   void begin(uint8_t pinA, uint8_t pinB, uint8_t btnA, uint8_t btnB, uint8_t btnUp, uint8_t btnDown);
 
   // Call this frequently (each loop). Handles decoding and debouncing.
-  void update();
+  void update() override;
 
   // Counter API
   int getCount() const { return _count; }
   void setCount(int v) { _count = v; _stepAccum = 0; }
 
   // Turn edge flags (true only on the loop after a detected detent)
-  bool wasTurnedCW()  { bool f = _turnCW;  _turnCW = false;  return f; }
-  bool wasTurnedCCW() { bool f = _turnCCW; _turnCCW = false; return f; }
+  bool wasTurnedCW() override  { bool f = _turnCW;  _turnCW = false;  return f; }
+  bool wasTurnedCCW() override { bool f = _turnCCW; _turnCCW = false; return f; }
 
   // Button A state/edges
   bool isPressedA() const { return _btnAStable == LOW; }
-  bool wasPressedA()  { bool f = _btnAEventPress;   _btnAEventPress = false;   return f; }
+  bool wasPressedA() override  { bool f = _btnAEventPress;   _btnAEventPress = false;   return f; }
   bool wasReleasedA() { bool f = _btnAEventRelease; _btnAEventRelease = false; return f; }
 
   // Button B state/edges
   bool isPressedB() const { return _btnBStable == LOW; }
-  bool wasPressedB()  { bool f = _btnBEventPress;   _btnBEventPress = false;   return f; }
+  bool wasPressedB() override  { bool f = _btnBEventPress;   _btnBEventPress = false;   return f; }
   bool wasReleasedB() { bool f = _btnBEventRelease; _btnBEventRelease = false; return f; }
 
   // UP/DOWN substitute buttons (optional)
@@ -0,0 +1,160 @@
+// TFTDisplayBackend.cpp (ST7789 panel through TFT_eSPI, optional DMA)
+
+#ifndef LCD_HOST_BACKEND
+
+#include "DisplayBackend.h"
+#include "Display_ST7789.h"
+#include <TFT_eSPI.h>
+#include <string.h>
+#ifdef ENABLE_TFT_DMA
+#include <esp_heap_caps.h>
+#endif
+
+static TFT_eSPI tft = TFT_eSPI();
+
+class TFTDisplayBackend : public DisplayBackend {
+public:
+  void begin() override {
+    tft.init();
+#ifdef ENABLE_TFT_DMA
+    if (tft.initDMA()) dmaStageInit();
+#endif
+    tft.setTextFont(1);
+    tft.setTextSize(1);
+    tft.setSwapBytes(false);
+    tft.invertDisplay(true);
+  }
+
+  void setRotation(uint8_t rot) override {
+    waitIdle();
+    tft.setRotation(rot);
+  }
+
+  void beginPush() override {
+#ifdef ENABLE_TFT_DMA
+    if (dma_stage_) {
+      if (!dma_open_) {
+        tft.startWrite();
+        dma_open_ = true;
+      }
+      return;
+    }
+#endif
+    tft.startWrite();
+  }
+
+  void pushRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                const uint16_t* pixels, uint16_t stride) override {
+#ifdef ENABLE_TFT_DMA
+    if (dma_stage_) {
+      pushRectDma(x, y, w, h, pixels, stride);
+      return;
+    }
+#endif
+    tft.setWindow(x, y, x + w - 1, y + h - 1);
+    // Framebuffer rows are contiguous, so a full-width region goes out in one burst.
+    if (w == stride) {
+      tft.pushPixels(pixels, (uint32_t)w * h);
+    } else {
+      for (uint16_t row = 0; row < h; ++row) tft.pushPixels(pixels + (uint32_t)row * stride, w);
+    }
+  }
+
+  void endPush() override {
+#ifdef ENABLE_TFT_DMA
+    if (dma_stage_) return; // held open until waitIdle()
+#endif
+    tft.endWrite();
+  }
+
+  void waitIdle() override {
+#ifdef ENABLE_TFT_DMA
+    if (!dma_open_) return;
+    tft.dmaWait();
+    tft.endWrite();
+    dma_open_ = false;
+    dma_busy_len_ = 0;
+#endif
+  }
+
+  bool busy() override {
+#ifdef ENABLE_TFT_DMA
+    return dma_open_ && tft.dmaBusy();
+#else
+    return false;
+#endif
+  }
+
+  void fillScreen(uint16_t color) override { waitIdle(); tft.fillScreen(color); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override { waitIdle(); tft.fillRect(x, y, w, h, color); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint16_t color) override { waitIdle(); tft.drawFastHLine(x, y, w, color); }
+  void drawPixel(int32_t x, int32_t y, uint16_t color) override { waitIdle(); tft.drawPixel(x, y, color); }
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint16_t color) override { waitIdle(); tft.drawLine(x0, y0, x1, y1, color); }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t color) override { waitIdle(); tft.drawRect(x, y, w, h, color); }
+  void drawCircle(int32_t xc, int32_t yc, int32_t r, uint16_t color) override { waitIdle(); tft.drawCircle(xc, yc, r, color); }
+  void fillCircle(int32_t xc, int32_t yc, int32_t r, uint16_t color) override { waitIdle(); tft.fillCircle(xc, yc, r, color); }
+
+  int16_t drawText(const char* str, int32_t x, int32_t y,
+                   uint16_t fg, uint16_t bg, bool opaque, uint8_t size) override {
+    waitIdle();
+    tft.setTextFont(1);
+    tft.setTextSize(size);
+    if (opaque) tft.setTextColor(fg, bg);
+    else tft.setTextColor(fg);
+    tft.setTextDatum(TL_DATUM);
+    return tft.drawString(str, x, y);
+  }
+
+private:
+#ifdef ENABLE_TFT_DMA
+  // DMA staging area. Present copies dirty rows here and returns while the last
+  // chunk is still on the bus, so drawing into the framebuffer overlaps the
+  // transfer. Only the most recently queued chunk can be in flight (pushImageDMA
+  // waits for the previous one), so that is the only range a new chunk must not
+  // overwrite.
+  uint16_t* dma_stage_ = nullptr;
+  uint32_t  dma_stage_px_ = 0;
+  uint32_t  dma_pos_ = 0;
+  uint32_t  dma_busy_off_ = 0;
+  uint32_t  dma_busy_len_ = 0;
+  bool      dma_open_ = false; // startWrite() held until waitIdle()
+
+  void dmaStageInit() {
+    if (dma_stage_) return;
+    const uint32_t longSide = (LCD_WIDTH > LCD_HEIGHT) ? LCD_WIDTH : LCD_HEIGHT;
+    dma_stage_px_ = 2UL * LCD_DMA_STRIP_ROWS * longSide;
+    dma_stage_ = (uint16_t*)heap_caps_malloc(dma_stage_px_ * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!dma_stage_) dma_stage_px_ = 0;
+  }
+
+  void pushRectDma(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                   const uint16_t* pixels, uint16_t stride) {
+    const uint16_t chunkRows = (uint16_t)((dma_stage_px_ / 2) / w);
+    for (uint16_t done = 0; done < h; ) {
+      const uint16_t rows = (uint16_t)min<uint32_t>(chunkRows, h - done);
+      const uint32_t n = (uint32_t)w * rows;
+      if (dma_pos_ + n > dma_stage_px_) dma_pos_ = 0;
+      if (dma_busy_len_ && dma_pos_ < dma_busy_off_ + dma_busy_len_ && dma_busy_off_ < dma_pos_ + n) {
+        tft.dmaWait();
+      }
+
+      uint16_t* dst = dma_stage_ + dma_pos_;
+      for (uint16_t row = 0; row < rows; ++row) {
+        memcpy(dst + (uint32_t)row * w, pixels + (uint32_t)(done + row) * stride, w * sizeof(uint16_t));
+      }
+      tft.pushImageDMA(x, y + done, w, rows, dst);
+      dma_busy_off_ = dma_pos_;
+      dma_busy_len_ = n;
+      dma_pos_ += n;
+      done = (uint16_t)(done + rows);
+    }
+  }
+#endif
+};
+
+DisplayBackend& LCD_DefaultBackend() {
+  static TFTDisplayBackend backend;
+  return backend;
+}
+
+#endif // LCD_HOST_BACKEND
@@ -236,7 +236,10 @@ void TextInputUI::setInputMode(InputMode m) {
 }
 
 void TextInputUI::clear() {
-  _inputLen = 0; _buf[0] = '\0';
+  // Wipe the whole buffer, not just the terminator: it may have held a secret.
+  volatile char* p = _buf;
+  for (size_t i = 0; i < sizeof(_buf); ++i) p[i] = 0;
+  _inputLen = 0;
   morseResetSeq();
   //drawInputText(); 
   //drawRemainingLabel();
@@ -244,8 +247,8 @@ void TextInputUI::clear() {
 
 // ==== UI drawing ====
 void TextInputUI::drawStaticUI() {
-  const uint16_t bg = UI_ColorBg();
-  const uint16_t fg = UI_ColorFg();
+  const UIColor bg = UI_ColorBg();
+  const UIColor fg = UI_ColorFg();
   LCD_Clear(bg);
   LCD_DrawLine(0, _layout.startY + 8,  LCD_Width() - 1, _layout.startY + 8,  fg);
   LCD_DrawLine(0, _layout.startY + 10, LCD_Width() - 1, _layout.startY + 10, fg);
@@ -0,0 +1,136 @@
+// TextLayout.cpp
+
+#include "TextLayout.h"
+#include "fonts/BitmapFont.h"
+#include <string.h>
+
+static inline bool isWrapSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// FNV-1a; only used to notice that the caller's text changed in place.
+static uint32_t layoutHash(const char* s, uint32_t n) {
+  uint32_t h = 2166136261u;
+  for (uint32_t i = 0; i < n; ++i) {
+    h ^= (uint8_t)s[i];
+    h *= 16777619u;
+  }
+  return h;
+}
+
+bool TextLayout::update(const char* text, uint8_t size, uint16_t maxWidthPx) {
+  if (!text) text = "";
+  if (size == 0) size = 1;
+  const uint32_t n = (uint32_t)strlen(text);
+  const uint32_t h = layoutHash(text, n);
+  text_ = text;
+  if (valid_ && n == textLen_ && h == hash_ && size == size_ && maxWidthPx == maxWidth_) return false;
+
+  textLen_ = n;
+  hash_ = h;
+  size_ = size;
+  maxWidth_ = maxWidthPx;
+  rebuild();
+  valid_ = true;
+  return true;
+}
+
+void TextLayout::clear() {
+  lines_.clear();
+  text_ = nullptr;
+  textLen_ = 0;
+  valid_ = false;
+}
+
+void TextLayout::rebuild() {
+  lines_.clear();
+  if (maxWidth_ == 0 || textLen_ == 0) return;
+
+  const int32_t maxW = maxWidth_;
+  const uint16_t spaceW = fontCharWidth(' ', size_);
+
+  Line cur = { 0, 0, 0 };
+  uint16_t chars = 0;        // rendered characters on the current line
+  bool pendingSpace = false; // a space run waits to be emitted before the next word
+  bool wrapped = false;      // the current (empty) line exists only because the last one wrapped
+
+  auto flush = [&](uint32_t at, bool byWrap) {
+    if (chars == 0) cur.start = at;
+    lines_.push_back(cur);
+    cur.start = at;
+    cur.len = 0;
+    cur.width = 0;
+    chars = 0;
+    pendingSpace = false;
+    wrapped = byWrap;
+  };
+
+  uint32_t p = 0;
+  while (p < textLen_) {
+    const char c = text_[p];
+    if (c == '\n') {
+      // A newline right after an automatic wrap only ends that wrap.
+      if (chars > 0 || !wrapped) flush(p + 1, false);
+      else wrapped = false;
+      ++p;
+      continue;
+    }
+
+    if (isWrapSpace(c)) {
+      while (p < textLen_ && isWrapSpace(text_[p])) ++p;
+      if (chars == 0) continue;
+      if (cur.width + spaceW > maxW) flush(p, true);
+      else pendingSpace = true;
+      continue;
+    }
+
+    const uint32_t wordStart = p;
+    int32_t wordW = 0;
+    while (p < textLen_ && !isWrapSpace(text_[p]) && text_[p] != '\n') {
+      wordW += fontCharWidth(text_[p], size_);
+      ++p;
+    }
+
+    const int32_t lead = pendingSpace ? spaceW : 0;
+    if (chars > 0 && cur.width + lead + wordW > maxW) flush(wordStart, true);
+
+    for (uint32_t q = wordStart; q < p; ++q) {
+      const uint16_t cw = fontCharWidth(text_[q], size_);
+      const uint16_t sp = pendingSpace ? spaceW : 0;
+      if (chars > 0 && (cur.width + sp + cw > maxW || chars + (sp ? 2 : 1) > kMaxLineChars)) flush(q, true);
+      if (chars == 0) {
+        cur.start = q;
+      } else if (pendingSpace) {
+        cur.width = (uint16_t)(cur.width + spaceW);
+        chars++;
+      }
+      pendingSpace = false;
+      cur.width = (uint16_t)(cur.width + cw);
+      cur.len = (uint16_t)(q + 1 - cur.start);
+      chars++;
+      wrapped = false;
+    }
+  }
+  if (chars > 0) flush(textLen_, false);
+}
+
+uint16_t TextLayout::lineText(uint16_t i, char* buf, uint16_t cap) const {
+  if (!buf || cap == 0) return 0;
+  uint16_t out = 0;
+  if (text_ && i < lines_.size()) {
+    const Line& ln = lines_[i];
+    bool inSpace = false;
+    for (uint32_t k = ln.start; k < ln.start + ln.len && out + 1 < cap; ++k) {
+      const char c = text_[k];
+      if (isWrapSpace(c)) {
+        if (!inSpace) buf[out++] = ' ';
+        inSpace = true;
+      } else {
+        buf[out++] = c;
+        inSpace = false;
+      }
+    }
+  }
+  buf[out] = '\0';
+  return out;
+}
@@ -0,0 +1,48 @@
+// TextLayout.h
+#pragma once
+#include <Arduino.h>
+#include <vector>
+#include <Display_ST7789.h>
+
+// Word-wrapped line breaks for one string, kept until the text, size or width
+// changes. Lines are stored as offsets into the caller's text, so scrolling
+// renders only the visible lines instead of re-wrapping from the top.
+//
+// Wrapping rules: words break at spaces (tab and CR count as spaces), a word
+// wider than the line is split by character, runs of spaces render as one,
+// and '\n' ends the line. An explicit "\n\n" yields an empty line.
+class TextLayout {
+public:
+  struct Line {
+    uint32_t start;  // first source byte
+    uint16_t len;    // source bytes, including collapsed space runs
+    uint16_t width;  // rendered width in px, trailing space excluded
+  };
+
+  static const uint16_t kMaxLineChars = 255;
+
+  // Re-wraps only if the key changed. Returns true when the layout was rebuilt.
+  // text must stay valid until the next update() or lineText() call.
+  bool update(const char* text, uint8_t size, uint16_t maxWidthPx);
+  void clear();
+
+  uint16_t lineCount() const { return (uint16_t)lines_.size(); }
+  const Line& line(uint16_t i) const { return lines_[i]; }
+  uint16_t lineHeight() const { return (uint16_t)(8u * size_ + TEXT_EXTRA_SPACING); }
+  uint32_t totalHeight() const { return (uint32_t)lineCount() * lineHeight(); }
+
+  // Copies line i into buf as drawn (space runs collapsed), NUL-terminated.
+  // Returns the number of characters written.
+  uint16_t lineText(uint16_t i, char* buf, uint16_t cap) const;
+
+private:
+  const char* text_ = nullptr;
+  uint32_t textLen_ = 0;
+  uint32_t hash_ = 0;
+  uint8_t  size_ = 1;
+  uint16_t maxWidth_ = 0;
+  bool     valid_ = false;
+  std::vector<Line> lines_;
+
+  void rebuild();
+};
@@ -0,0 +1,19 @@
+// UIColor.h
+#pragma once
+#include <stdint.h>
+
+// A colour argument to the drawing calls: RGB565, plus the palette role it was
+// taken from when it came from UI_ColorBg() and friends. An indexed
+// framebuffer stores a role colour as that role's table entry, so two roles
+// with the same colour keep separate entries and a palette switch recolours
+// each one correctly. Plain RGB565 values convert implicitly, with no role.
+struct UIColor {
+  static const uint8_t kNoRole = 0xFF;
+
+  uint16_t rgb;
+  uint8_t  role;
+
+  UIColor(uint16_t c = 0) : rgb(c), role(kNoRole) {}
+  UIColor(uint16_t c, uint8_t r) : rgb(c), role(r) {}
+  operator uint16_t() const { return rgb; }
+};
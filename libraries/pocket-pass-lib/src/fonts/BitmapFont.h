@@ -0,0 +1,134 @@
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+#include "font5x7.h"
+
+// 1bpp cell font blitted straight into an RGB565 buffer. Metrics match
+// TFT_eSPI font 1 (the same 5x7 glyphs in a 6x8 cell), so text drawn here and
+// text drawn through tft.drawString() line up pixel for pixel.
+
+static constexpr uint8_t FONT_FIRST_CHAR  = 32;
+static constexpr uint8_t FONT_GLYPH_COUNT = 95; // ASCII 32..126, then the fallback box
+static constexpr uint8_t FONT_GLYPH_W     = 5;
+static constexpr uint8_t FONT_CELL_W      = 6;
+static constexpr uint8_t FONT_CELL_H      = 8;
+
+// Advance of one character in unscaled pixels. The 5x7 set is monospaced, so
+// this is a constant and string widths need no per-character walk.
+static constexpr uint8_t fontAdvance(char) { return FONT_CELL_W; }
+
+static constexpr uint16_t fontCharWidth(char c, uint8_t size) {
+  return (uint16_t)(fontAdvance(c) * size);
+}
+
+static constexpr uint16_t fontLineHeight(uint8_t size) {
+  return (uint16_t)(FONT_CELL_H * size);
+}
+
+static inline uint16_t fontTextWidth(const char* str, size_t len, uint8_t size) {
+  (void)str;
+  return (uint16_t)(len * FONT_CELL_W * size);
+}
+
+static inline uint16_t fontTextWidth(const char* str, uint8_t size) {
+  return str ? fontTextWidth(str, strlen(str), size) : 0;
+}
+
+// The 8 row masks of c's glyph (see font5x7.h), in PROGMEM, or nullptr for a
+// blank cell. Control characters (below 32, and 127) are blank; bytes 128..255,
+// such as the halves of a UTF-8 sequence, draw the fallback box so unsupported
+// text shows up instead of vanishing. Every byte still advances one cell.
+static inline const uint8_t* fontGlyph(char c) {
+  const uint8_t u = (uint8_t)c;
+  if (u >= 128) return font5x7Rows[FONT_GLYPH_COUNT];
+  if (u < FONT_FIRST_CHAR || u >= FONT_FIRST_CHAR + FONT_GLYPH_COUNT) return nullptr;
+  return font5x7Rows[u - FONT_FIRST_CHAR];
+}
+
+// Row r of a glyph as a bit mask, bit c = column c.
+static inline uint8_t fontGlyphRow(char c, uint8_t r) {
+  const uint8_t* g = fontGlyph(c);
+  return g ? pgm_read_byte(&g[r]) : 0;
+}
+
+// One scaled glyph row into row, for a cell starting at column x, written as
+// runs of equal bits clipped to cell pixels [cx0, cx1). Clear bits are
+// written only when opaque.
+template <typename Pixel>
+static inline void fontBlitRow(Pixel* row, int32_t x, uint8_t bits, uint8_t size,
+                               int32_t cx0, int32_t cx1, Pixel fg, Pixel bg, bool opaque) {
+  if (!opaque) {
+    // Only the set runs: skip to each one with a count of trailing zeros.
+    while (bits) {
+      const uint8_t col = (uint8_t)__builtin_ctz(bits);
+      const uint8_t len = (uint8_t)__builtin_ctz(~(unsigned)(bits >> col));
+      bits = (uint8_t)(bits & ~(((1U << len) - 1U) << col));
+      const int32_t a = max<int32_t>((int32_t)col * size, cx0);
+      const int32_t b = min<int32_t>((int32_t)(col + len) * size, cx1);
+      for (int32_t i = a; i < b; ++i) row[x + i] = fg;
+    }
+    return;
+  }
+  uint8_t col = 0;
+  while (col < FONT_CELL_W) {
+    const uint8_t on = (uint8_t)((bits >> col) & 1U);
+    uint8_t end = (uint8_t)(col + 1);
+    while (end < FONT_CELL_W && ((bits >> end) & 1U) == on) ++end;
+    const int32_t a = max<int32_t>((int32_t)col * size, cx0);
+    const int32_t b = min<int32_t>((int32_t)end * size, cx1);
+    const Pixel px = on ? fg : bg;
+    for (int32_t i = a; i < b; ++i) row[x + i] = px;
+    col = end;
+  }
+}
+
+// Draws str with its top-left at (x, y) into buf (bufW x bufH pixels, row-major).
+// fg and bg must already be stored pixel values for buf. bg is painted only when
+// opaque, otherwise unset glyph pixels are left alone. Returns the advance in px.
+template <typename Pixel>
+static inline uint16_t fontDrawString(Pixel* buf, uint16_t bufW, uint16_t bufH,
+                                      int32_t x, int32_t y, const char* str,
+                                      Pixel fg, Pixel bg, bool opaque, uint8_t size) {
+  if (!buf || !str || size == 0) return 0;
+  const int32_t cellW = (int32_t)FONT_CELL_W * size;
+  const int32_t x0 = x;
+
+  for (const char* p = str; *p; ++p, x += cellW) {
+    if (x >= (int32_t)bufW) {
+      x += cellW * (int32_t)strlen(p);
+      break;
+    }
+    if (x + cellW <= 0) continue;
+    const uint8_t* glyph = fontGlyph(*p);
+    if (!glyph && !opaque) continue;
+
+    // Horizontal clip of this cell, in cell pixels.
+    const int32_t cx0 = (x < 0) ? -x : 0;
+    const int32_t cx1 = (x + cellW > (int32_t)bufW) ? (int32_t)bufW - x : cellW;
+
+    for (uint8_t r = 0; r < FONT_CELL_H; ++r) {
+      const uint8_t bits = glyph ? pgm_read_byte(&glyph[r]) : 0;
+      if (!bits && !opaque) continue;
+
+      // An opaque row covers the whole clipped cell, so its scaled copies are
+      // plain copies of the first one drawn.
+      const Pixel* drawn = nullptr;
+      for (uint8_t sy = 0; sy < size; ++sy) {
+        const int32_t yy = y + (int32_t)r * size + sy;
+        if (yy < 0) continue;
+        if (yy >= (int32_t)bufH) break;
+        Pixel* row = buf + (uint32_t)yy * bufW;
+        if (drawn && opaque) {
+          memcpy(row + x + cx0, drawn + x + cx0, (size_t)(cx1 - cx0) * sizeof(Pixel));
+        } else if (size == 1 && opaque) {
+          // Runs are a pixel or two long at size 1; a straight select is cheaper.
+          for (int32_t i = cx0; i < cx1; ++i) row[x + i] = ((bits >> i) & 1U) ? fg : bg;
+        } else {
+          fontBlitRow(row, x, bits, size, cx0, cx1, fg, bg, opaque);
+          drawn = row;
+        }
+      }
+    }
+  }
+  return (uint16_t)(x - x0);
+}
@@ -38,6 +38,11 @@ static constexpr const char* AUTH_FAIL_KEY = "pin_fail";
 static constexpr const char* AUTH_LOCK_KEY = "pin_lock";
 static constexpr const char* UI_NS         = "ui";
 static constexpr const char* UI_PALETTE_KEY = "palette";
+// Newest integrity root this device wrote (84_db_integrity); survives the SD card
+static constexpr const char* INTEG_NS       = "integ";
+static constexpr const char* INTEG_GEN_KEY  = "gen";
+static constexpr const char* INTEG_ROOT_KEY = "root";
+static constexpr const char* INTEG_UUID_KEY = "uuid";
 
 // 0 = lockout only (recommended)
 // 1 = lockout + scramble meta so recovery is impossible (self-destruct)
@@ -49,6 +54,67 @@ static constexpr const char* UI_PALETTE_KEY = "palette";
 #define PP_WIPE_PLAINTEXT_NAMES 1   // 1 = wipe categories.name + items.label_plain after migration
 #endif
 
+// PBKDF2 inner loop: 1 = mbedTLS SHA-256 (S3 SHA accelerator when the core enables it)
+//                    0 = in-tree software compression
+#ifndef PP_PBKDF2_HW_SHA
+  #if defined(CONFIG_MBEDTLS_HARDWARE_SHA)
+    #define PP_PBKDF2_HW_SHA 1
+  #else
+    #define PP_PBKDF2_HW_SHA 0
+  #endif
+#endif
+
+// Main menu: read the highlighted category's items once the selection has rested this long
+#ifndef PP_PREFETCH_IDLE_MS
+#define PP_PREFETCH_IDLE_MS 400   // 0 = no prefetch, load on open only
+#endif
+
+// Rows re-encrypted per SQLite transaction during vault-key rotation
+#ifndef PP_REKEY_BATCH_ROWS
+#define PP_REKEY_BATCH_ROWS 32
+#endif
+
+// Longest password CSV import accepts; longer rows are skipped and counted
+#ifndef PP_PASSWORD_MAX
+#define PP_PASSWORD_MAX 256
+#endif
+
+// Cipher suite for new vaults (1 = AES-256-GCM, 2 = ChaCha20-Poly1305); see CipherSuite
+#ifndef PP_DEFAULT_CIPHER_SUITE
+#define PP_DEFAULT_CIPHER_SUITE 1
+#endif
+
+// Bytes fetched from the hardware RNG per refill of a PwEntropy pool
+#ifndef PP_PWGEN_POOL_BYTES
+#define PP_PWGEN_POOL_BYTES 64
+#endif
+
+// Integrity tree: leaf buckets, and the idle background re-check (84_db_integrity)
+#ifndef PP_INTEG_BUCKETS
+#define PP_INTEG_BUCKETS 16
+#endif
+#ifndef PP_INTEG_IDLE_MS
+#define PP_INTEG_IDLE_MS 1500      // 0 = no background re-check
+#endif
+#ifndef PP_INTEG_SLICE_LEAVES
+#define PP_INTEG_SLICE_LEAVES 4    // leaves hashed per idle slice
+#endif
+
+// Passwords entered by hand scoring below this (0..4) get a warning before saving
+#ifndef PP_STRENGTH_WARN_BELOW
+#define PP_STRENGTH_WARN_BELOW 3
+#endif
+
+// Longest the locked screensaver sleeps before checking the keys again
+#ifndef PP_SAVER_POLL_MS
+#define PP_SAVER_POLL_MS 20
+#endif
+
+// 1 = show display counters (frames, bytes, present/render time) along the bottom edge
+#ifndef PP_DISPLAY_STATS
+#define PP_DISPLAY_STATS 0
+#endif
+
 // SD Paths
 #define BASE_DIR       "/pocketPass"
 #define FW_DIR         "/pocketPass/firmware"
@@ -119,6 +185,7 @@ struct PasswordItem {
   String label_nonce_b64;    // unused now
   String pw_ct_b64;          // Base64 of password ciphertext (includes tag)
   String pw_nonce_b64;       // Base64 of 12-byte nonce
+  String pw_fp;              // password_fingerprint(); written with the row, not loaded back
   std::vector<PasswordVersion> pw_history; // archived passwords
   // For convenience in RAM:
   String label_plain;        // stored and loaded from DB
@@ -129,6 +196,8 @@ struct Category {
   std::vector<PasswordItem> items;
   std::vector<String> item_names_decrypted; // decrypted names in RAM after unlock (here just label_plain)
   int32_t db_id = -1;                    // category row id in DB
+  bool items_loaded = false;             // items/labels read on first open (ensureCategoryLoaded)
+  uint8_t pw_policy = 0;                 // index into kPwPolicies; 0 = follow g_settings
 };
 
 struct Vault {
@@ -143,6 +212,35 @@ struct PwSettings {
   uint8_t palette   = 0;
 };
 
+// Generator template. words > 0 selects passphrase mode and ignores the counts.
+struct PwPolicy {
+  const char* name;
+  uint8_t uppercase;
+  uint8_t lowercase;
+  uint8_t number;
+  uint8_t symbol;
+  uint8_t words;
+};
+static constexpr uint8_t PW_POLICY_COUNT = 5;
+
+// Block of hardware-RNG output consumed a byte at a time. Keep one alive
+// across pwgen_next() calls when minting many passwords (import).
+struct PwEntropy {
+  uint8_t  buf[PP_PWGEN_POOL_BYTES];
+  uint16_t pos = PP_PWGEN_POOL_BYTES;
+  PwEntropy() = default;
+  PwEntropy(const PwEntropy&) = delete;
+  PwEntropy& operator=(const PwEntropy&) = delete;
+  ~PwEntropy() { secure_zero(buf, sizeof(buf)); }
+};
+
+// estimate_strength() output. score is zxcvbn's 0..4 scale over log10(guesses).
+struct StrengthResult {
+  uint8_t score = 0;
+  float   log10_guesses = 0;
+  const char* hint = "";   // weakest pattern found, "" if none
+};
+
 // ==== Security / Crypto Meta ====
 static constexpr const char* DEVSEC_NS  = "devsec";
 static constexpr const char* DEVSEC_KEY = "device_secret";
@@ -154,6 +252,122 @@ struct SecureBuf {
   void clear() { if (!b.empty()) secure_zero(b.data(), b.size()); b.clear(); }
 };
 
+// ==== Secure arena ====
+// Fixed slots for plaintext secrets. Plain .bss, so internal SRAM (never PSRAM); release
+// zeroes a slot. A value longer than one slot takes a run of adjacent slots; growing past
+// its run moves it to a longer one and zeroes the old run, so no stale copy is left behind.
+#ifndef PP_SECURE_SLOTS
+#define PP_SECURE_SLOTS 12
+#endif
+static constexpr size_t SECURE_SLOT_SIZE = 128;
+static_assert(PP_SECURE_SLOTS <= 32, "slot bitmap is 32 bits");
+
+static uint8_t  g_secure_arena[PP_SECURE_SLOTS][SECURE_SLOT_SIZE];
+static uint32_t g_secure_used = 0; // bit per slot
+
+static uint32_t secure_run_mask(uint8_t slots) {
+  return slots >= 32 ? 0xFFFFFFFFu : ((1u << slots) - 1);
+}
+
+static char* secure_alloc(uint8_t slots = 1) {
+  const uint32_t run = secure_run_mask(slots);
+  for (uint8_t i = 0; slots && i + slots <= PP_SECURE_SLOTS; ++i) {
+    if (g_secure_used & (run << i)) continue;
+    g_secure_used |= (run << i);
+    return (char*)g_secure_arena[i];
+  }
+  Serial.printf("[SECURE] arena exhausted (%u slots)\n", (unsigned)slots);
+  return nullptr;
+}
+
+static void secure_free(char* p, uint8_t slots = 1) {
+  if (!p) return;
+  size_t i = (size_t)((uint8_t*)p - &g_secure_arena[0][0]) / SECURE_SLOT_SIZE;
+  secure_zero(p, (size_t)slots * SECURE_SLOT_SIZE);
+  g_secure_used &= ~(secure_run_mask(slots) << i);
+}
+
+// Move-only string backed by arena slots; holds up to CAPACITY bytes + NUL.
+class SecureString {
+public:
+  static constexpr size_t CAPACITY = (size_t)PP_SECURE_SLOTS * SECURE_SLOT_SIZE - 1;
+
+  SecureString() {}
+  ~SecureString() { clear(); }
+  SecureString(const SecureString&) = delete;
+  SecureString& operator=(const SecureString&) = delete;
+  SecureString(SecureString&& o) : p_(o.p_), n_(o.n_), slots_(o.slots_) { o.p_ = nullptr; o.n_ = 0; o.slots_ = 0; }
+  SecureString& operator=(SecureString&& o) {
+    if (this != &o) {
+      clear();
+      p_ = o.p_; n_ = o.n_; slots_ = o.slots_;
+      o.p_ = nullptr; o.n_ = 0; o.slots_ = 0;
+    }
+    return *this;
+  }
+
+  // Writable buffer of exactly n bytes (NUL placed after); nullptr if too long or no slot.
+  char* prepare(size_t n) {
+    if (!reserve(n)) { clear(); return nullptr; }
+    if (n < n_) secure_zero(p_ + n, n_ - n);
+    n_ = n;
+    p_[n_] = 0;
+    return p_;
+  }
+  bool assign(const char* s, size_t n) {
+    char* d = prepare(n);
+    if (!d) return false;
+    if (n) memcpy(d, s, n);
+    return true;
+  }
+  bool assign(const char* s) { return assign(s, s ? strlen(s) : 0); }
+  bool push_back(char c) {
+    if (!reserve(n_ + 1)) return false;
+    p_[n_++] = c;
+    p_[n_] = 0;
+    return true;
+  }
+  void trim() {
+    if (!p_) return;
+    size_t a = 0, b = n_;
+    while (a < b && isspace((unsigned char)p_[a])) ++a;
+    while (b > a && isspace((unsigned char)p_[b - 1])) --b;
+    if (a) memmove(p_, p_ + a, b - a);
+    prepare(b - a);
+  }
+  void clear() { secure_free(p_, slots_); p_ = nullptr; n_ = 0; slots_ = 0; }
+
+  const char* c_str() const { return p_ ? p_ : ""; }
+  const uint8_t* bytes() const { return (const uint8_t*)c_str(); }
+  size_t length() const { return n_; }
+  bool isEmpty() const { return n_ == 0; }
+  char operator[](size_t i) const { return i < n_ ? p_[i] : 0; }
+
+private:
+  char*   p_ = nullptr;
+  size_t  n_ = 0;
+  uint8_t slots_ = 0;
+
+  // Room for n bytes + NUL, keeping the current contents.
+  bool reserve(size_t n) {
+    if (n > CAPACITY) return false;
+    const uint8_t need = (uint8_t)((n + SECURE_SLOT_SIZE) / SECURE_SLOT_SIZE);
+    if (p_ && need <= slots_) return true;
+    char* q = secure_alloc(need);
+    if (!q) return false;
+    if (p_) {
+      memcpy(q, p_, n_ + 1);
+      secure_free(p_, slots_);
+    } else {
+      q[0] = 0;
+    }
+    p_ = q;
+    slots_ = need;
+    return true;
+  }
+};
+static_assert(PP_PASSWORD_MAX <= SecureString::CAPACITY, "imported passwords must fit the arena");
+
 struct Meta {
   uint32_t version = 1;
   String db_uuid;
@@ -170,14 +384,105 @@ struct Meta {
   String vault_wrap_normal_nonce_b64;
   String vault_wrap_recovery_ct_b64;
   String vault_wrap_recovery_nonce_b64;
+
+  // Vault-key rotation marker (82_db_rekey). rekey_phase != 0 means the wraps above
+  // already hold the new key and rows up to rekey_cursor in that phase are re-encrypted.
+  uint8_t rekey_phase = 0;
+  String rekey_cursor;
+  String rekey_prev_ct_b64;     // old vault_key wrapped under the new one; empty for a suite switch
+  String rekey_prev_nonce_b64;
+
+  // AEAD for everything under the vault subkeys (CipherSuite). Key wraps stay AES-GCM.
+  uint8_t cipher_suite = PP_DEFAULT_CIPHER_SUITE;
+  uint8_t rekey_prev_suite = PP_DEFAULT_CIPHER_SUITE;  // suite of the old ring during a rotation
+
+  // Integrity tree root (84_db_integrity). Empty = not sealed yet / invalidated by a rotation.
+  uint32_t integ_gen = 0;
+  String integ_root;
+};
+
+// AAD is built on the stack; the longest current format is
+// "item-field v1|" + 32-char uuid + "|" + 16-char id + "|password" (72 bytes).
+static constexpr size_t AAD_MAX     = 128;
+static constexpr size_t DB_UUID_MAX = 64;
+
+struct AadBuf {
+  uint8_t b[AAD_MAX];
+  size_t len = 0;
+  bool overflow = false;
+  void put(const char* s, size_t n) {
+    if (overflow || len + n > AAD_MAX) { overflow = true; return; }
+    memcpy(b + len, s, n);
+    len += n;
+  }
+  void put(const char* s) { put(s, strlen(s)); }
+  const uint8_t* data() const { return b; }
+  size_t size() const { return len; }
+};
+
+// KDF progress / cancel hook. Only the task that installed it is reported to
+// (the recovery KDF may be running on the other core at the same time).
+typedef bool (*KdfProgressFn)(uint32_t done, uint32_t total); // return false = cancel
+static constexpr uint32_t PBKDF2_SLICE_ITERS = 2048;
+
+static KdfProgressFn g_kdf_progress = nullptr;
+static TaskHandle_t  g_kdf_progress_task = nullptr;
+static bool          g_kdf_canceled = false;
+
+struct KdfProgressScope {
+  explicit KdfProgressScope(KdfProgressFn fn) {
+    g_kdf_progress = fn;
+    g_kdf_progress_task = xTaskGetCurrentTaskHandle();
+    g_kdf_canceled = false;
+  }
+  ~KdfProgressScope() { g_kdf_progress = nullptr; g_kdf_progress_task = nullptr; }
+};
+
+// Subkeys derived from vault_key (HKDF-SHA256, salt "subkey salt")
+enum class SubKey : uint8_t { Fields = 0, Db, Meta, Session, Fingerprint, Integrity, Count };
+static constexpr uint8_t SUBKEY_COUNT = (uint8_t)SubKey::Count;
+
+// Same 12-byte nonce and 16-byte tag for both, so stored ciphertext has one layout.
+enum class CipherSuite : uint8_t { AesGcm = 1, ChaChaPoly = 2 };
+
+static inline bool cipher_suite_valid(uint8_t s) {
+  return s == (uint8_t)CipherSuite::AesGcm || s == (uint8_t)CipherSuite::ChaChaPoly;
+}
+
+// One keyed AEAD context; which union member is live follows `suite`.
+struct AeadCtx {
+  CipherSuite suite;
+  union {
+    mbedtls_gcm_context gcm;
+    mbedtls_chachapoly_context chacha;
+  };
+};
+
+// Fixed buffers only, so keyring_wipe() reaches every copy of the key material.
+struct KeyRing {
+  uint8_t vault_key[32];
+  uint8_t prk[32];                        // HKDF extract, done once per load
+  uint8_t sub[SUBKEY_COUNT][32];          // expanded on first use
+  AeadCtx aead[SUBKEY_COUNT];             // keyed on first use
+  CipherSuite suite = CipherSuite::AesGcm;
+  bool    loaded = false;
+  uint8_t sub_ready = 0;                  // bit per SubKey
+  uint8_t aead_ready = 0;                 // bit per SubKey
+};
+
+// In-session PIN check. key = HMAC(K_session, random salt) is fixed at unlock,
+// tag = HMAC(key, pin). Never persisted; crypto_lock() wipes it.
+struct SessionAuth {
+  uint8_t key[32];
+  uint8_t tag[32];
+  bool    armed = false;
 };
 
 struct CryptoState {
   std::vector<uint8_t> device_secret; // from NVS
-  std::vector<uint8_t> vault_key;     // 32 bytes
-  std::vector<uint8_t> K_fields;      // 32 bytes (still derived, used for password encryption)
-  std::vector<uint8_t> K_db;          // 32 bytes
-  std::vector<uint8_t> K_meta;
+  KeyRing keys;                       // see keyring_* in 60_crypto
+  KeyRing rekey_prev;                 // old ring while a vault-key rotation is pending
+  SessionAuth session;                // see session_auth_* in 60_crypto
   bool unlocked = false;
 };
 
@@ -193,6 +498,9 @@ Vault g_vault;
 PwSettings g_settings;
 Meta g_meta;
 CryptoState g_crypto;
+static char   g_db_uuid_c[DB_UUID_MAX + 1] = {0}; // cached copy of g_meta.db_uuid for AAD
+static size_t g_db_uuid_len = 0;
+static bool   g_db_uuid_cached = false; // also set when the uuid was too long to cache
 
 UiState g_state = UiState::Locked;
 static volatile MenuContext g_menuCtx = MenuContext::None;
@@ -211,6 +519,7 @@ static volatile bool g_welcome_done = false;
 static volatile bool g_ti_done = false;
 static volatile bool g_ti_canceled = false;
 static String g_ti_result;
+static SecureString* g_ti_secret = nullptr; // runSecretInput target; bypasses g_ti_result
 
 // SQLite globals
 static sqlite3* g_db = nullptr;
@@ -229,6 +538,7 @@ static void updateLoading(const char* subtitle);
 static void hideLoading();
 static void waitForButtonB(const char* title, const char* message, const char* btn);
 static String runTextInput(const char* title, const char* description, uint8_t maxLen, TextInputUI::InputMode mode, bool mask);
+static bool runSecretInput(const char* title, const char* description, uint8_t maxLen, SecureString& out);
 static String promptPasscode6(const char* title, const char* desc);
 static String promptExact(const char* title, const char* desc, const char* expect, uint8_t maxLen);
 static bool selectDestinationCategory(size_t sourceCidx, size_t& outDestCidx);
@@ -244,7 +554,13 @@ static void deleteCategoryIfEmpty(size_t cidx);
 static void addPasswordToCategory(size_t cidx);
 static void editPasswordName(size_t cidx, size_t pidx);
 static void deletePassword(size_t cidx, size_t pidx);
-static String generatePassword(const PwSettings& s);
+static bool generatePassword(const PwSettings& s, SecureString& out);
+static bool generatePassword(const PwPolicy& p, SecureString& out);
+static bool pwgen_next(PwEntropy& e, const PwPolicy& p, SecureString& out);
+static PwPolicy pwpolicy_resolve(uint8_t id);
+static PwPolicy pwpolicy_for_category(const Category& c);
+static const char* pwpolicy_name(uint8_t id);
+static void editCategoryPolicy(size_t cidx);
 
 static void showArchivesForItem(Category& cat, size_t pwdIdx);
 // Storage
@@ -253,6 +569,9 @@ static bool ensureVaultDir();
 static bool loadMeta();
 static bool saveMeta();
 static bool loadItems();
+static bool loadCategoryItems(Category& c);
+static bool ensureCategoryLoaded(Category& c);
+static bool ensureAllCategoriesLoaded();
 static bool saveItems();
 static uint8_t loadPaletteSetting();
 static bool loadConfig();
@@ -275,36 +594,61 @@ static bool b64decode(const String& s, std::vector<uint8_t>& out);
 // Crypto primitives
 static void random_bytes(uint8_t* buf, size_t len);
 static bool consttime_eq(const uint8_t* a, const uint8_t* b, size_t len);
-static bool pbkdf2_hmac_sha256(const uint8_t* pw, size_t pw_len, const uint8_t* salt, size_t salt_len, uint32_t iters, uint8_t* out, size_t out_len);
+// cancel, if given, is polled between slices; setting it makes the call return false.
+static bool pbkdf2_hmac_sha256(const uint8_t* pw, size_t pw_len, const uint8_t* salt, size_t salt_len, uint32_t iters, uint8_t* out, size_t out_len, const volatile bool* cancel = nullptr);
 static bool hmac_sha256(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t msg_len, uint8_t out[32]);
 static bool hkdf_sha256_extract_expand(const uint8_t* ikm, size_t ikm_len, const uint8_t* salt, size_t salt_len, const uint8_t* info, size_t info_len, uint8_t* out, size_t out_len);
 static bool aes256_gcm_encrypt(const uint8_t* key, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* plaintext, size_t pt_len, std::vector<uint8_t>& out_ct_with_tag);
 static bool aes256_gcm_decrypt(const uint8_t* key, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, std::vector<uint8_t>& out_plain);
+static bool aes256_gcm_encrypt_ctx(mbedtls_gcm_context* ctx, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* plaintext, size_t pt_len, std::vector<uint8_t>& out_ct_with_tag);
+static bool aes256_gcm_decrypt_ctx_raw(mbedtls_gcm_context* ctx, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, uint8_t* out);
+static bool aes256_gcm_decrypt_ctx(mbedtls_gcm_context* ctx, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, std::vector<uint8_t>& out_plain);
+static bool aead_setkey(AeadCtx& a, CipherSuite suite, const uint8_t key[32]);
+static void aead_free(AeadCtx& a);
+static bool aead_encrypt(AeadCtx* a, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* plaintext, size_t pt_len, std::vector<uint8_t>& out_ct_with_tag);
+static bool aead_decrypt_raw(AeadCtx* a, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, uint8_t* out);
+static bool aead_decrypt(AeadCtx* a, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, std::vector<uint8_t>& out_plain);
+static const char* cipher_suite_name(uint8_t suite);
+static uint32_t aead_benchmark_kbps(CipherSuite suite);
 
 // KDF/wrapping compositions
 static bool derive_W(const String& pin_concat, const uint8_t salt1[16], const uint8_t salt2[16], uint32_t iters, std::vector<uint8_t>& out32);
+static bool kdf_was_canceled();
+static bool derive_W_pair(const String& pin, const String& pin_plus_rk, const uint8_t salt1[16], const uint8_t salt2[16], uint32_t iters, std::vector<uint8_t>& Wn, std::vector<uint8_t>& Wr);
 static bool make_verifier(const std::vector<uint8_t>& W, String& out_b64);
 static bool check_verifier(const std::vector<uint8_t>& W, const String& verifier_b64);
-static bool wrap_vault_key(const std::vector<uint8_t>& W, const std::vector<uint8_t>& vault_key, String& out_ct_b64, String& out_nonce_b64);
+static bool wrap_vault_key(const std::vector<uint8_t>& W, const uint8_t* vault_key, String& out_ct_b64, String& out_nonce_b64);
 static bool unwrap_vault_key(const std::vector<uint8_t>& W, const String& ct_b64, const String& nonce_b64, std::vector<uint8_t>& out_vault_key);
 
-// Subkeys
-static bool derive_subkeys_from_vault();
+// KeyRing
+static bool keyring_load(KeyRing& k, const uint8_t vault_key[32], CipherSuite suite);
+static const uint8_t* keyring_subkey(KeyRing& k, SubKey id);
+static AeadCtx* keyring_aead(KeyRing& k, SubKey id);
+static void keyring_wipe(KeyRing& k);
+static bool keyring_load(const uint8_t vault_key[32]);
+static bool keyring_generate();
+static bool keyring_loaded();
+static const uint8_t* keyring_vault_key();
+static const uint8_t* keyring_subkey(SubKey id);
+static AeadCtx* keyring_aead(SubKey id);
+static void keyring_wipe();
+static void crypto_lock();
 
 // AAD builders
-static void make_item_field_aad(const String& db_uuid, const String& item_id, const char* field, std::vector<uint8_t>& aad);
-static void make_category_field_aad(const String& db_uuid, int32_t cat_id, const char* field, std::vector<uint8_t>& aad);
-static void make_item_label_aad(const String& db_uuid, const String& item_id, std::vector<uint8_t>& aad);
+static void cache_db_uuid();
+static bool make_item_field_aad(const String& item_id, const char* field, AadBuf& aad);
+static bool make_category_field_aad(int32_t cat_id, const char* field, AadBuf& aad);
+static bool make_item_label_aad(const String& item_id, AadBuf& aad);
 
 // Item crypto
-static bool encrypt_label_password(const String& label_plain, const String& pw_plain, String item_id, String& out_label_ct_b64, String& out_label_nonce_b64, String& out_pw_ct_b64, String& out_pw_nonce_b64);
+static bool encrypt_label_password(const String& label_plain, const SecureString& pw_plain, const String& item_id, String& out_label_ct_b64, String& out_label_nonce_b64, String& out_pw_ct_b64, String& out_pw_nonce_b64);
 static bool decrypt_label(const PasswordItem& it, const String& item_id, String& out_label);
-static bool decrypt_password(const PasswordItem& it, const String& item_id, String& out_pw);
-static bool decrypt_password_bytes(const PasswordItem& it, const String& item_id, SecureBuf& out);
-static bool encrypt_password_only_for_item(const String& item_id, const String& pw_plain, String& out_ct_b64, String& out_nonce_b64);
-static bool decrypt_password_history_version(const PasswordItem& it, const PasswordVersion& v, String& out_pw);
-static bool encrypt_string_meta_b64(const std::vector<uint8_t>& aad,const String& plain,String& out_ct_b64,String& out_nonce_b64);
-static bool decrypt_string_meta_b64(const std::vector<uint8_t>& aad,const String& ct_b64,const String& nonce_b64,String& out_plain);
+static bool decrypt_password_ct(const String& ct_b64, const String& nonce_b64, const String& item_id, SecureString& out_pw);
+static bool decrypt_password(const PasswordItem& it, const String& item_id, SecureString& out_pw);
+static bool encrypt_password_only_for_item(const String& item_id, const SecureString& pw_plain, String& out_ct_b64, String& out_nonce_b64);
+static bool decrypt_password_history_version(const PasswordItem& it, const PasswordVersion& v, SecureString& out_pw);
+static bool encrypt_string_meta_b64(const AadBuf& aad,const String& plain,String& out_ct_b64,String& out_nonce_b64);
+static bool decrypt_string_meta_b64(const AadBuf& aad,const String& ct_b64,const String& nonce_b64,String& out_plain);
 
 // JSON vault model helpers
 static void refreshDecryptedItemNames();
@@ -313,17 +657,25 @@ void sortItemsByName(Category& c);
 
 // Recovery key
 static String generate_recovery_key_b64();
-static bool derive_W_recovery_only(const String& pin_plus_rk, const uint8_t salt1[16], const uint8_t salt2[16], uint32_t iters, std::vector<uint8_t>& out32);
+static bool derive_W_recovery_only(const String& pin_plus_rk, const uint8_t salt1[16], const uint8_t salt2[16], uint32_t iters, std::vector<uint8_t>& out32, const volatile bool* cancel = nullptr);
 static bool update_kdf_iters(uint32_t new_iters, const String& current_pin, const String& recovery_key_b64);
 
 // Misc
 static String make_id_16();
 static void hidKeyboardTypeString(const String& s);
+static void hidKeyboardTypeString(const SecureString& s);
 static void hidKeyboardTypeBytes(const uint8_t* p, size_t n);
 static void mountSD();
 static void showRecoveryKeyOnce(const String& rk_b64);
 static void showWelcomeInfoScreen();
 static uint8_t showUnlockFailedMenu();
+static void showAboutScreen();
+static void showLicenseScreen();
+static void showPrivacyScreen();
+static void showCreditsMenu();
+static void serviceAutoLogout();
+static inline void menuLoopAuto();
+static void log_heap(const char* tag);
 
 // Security level
 static uint32_t map_security_level_to_iters(uint8_t lvl);
@@ -339,9 +691,17 @@ static void check_and_apply_sd_ota_if_present();
 static bool initializeNewVaultWithPIN(const String& pin);
 static bool unlockWithPIN(const String& pin);
 static bool recoverWithPINandRecovery(const String& pin, const String& recovery_key_b64);
-static bool auth_with_current_pin_get(String& out_pin);
+static bool auth_with_current_pin_get(String& out_pin, const char* prompt = "Enter current PIN");
+static bool session_auth_arm(const String& pin);
+static bool session_auth_check(const String& pin);
+static void session_auth_wipe();
+static uint8_t auth_getFailCount();
+static bool auth_isLockedOut();
+static void auth_resetPinFailures();
+static void auth_recordPinFailure_andMaybeLockout();
 
 // SQLite helpers
+static void db_log_sqlite_error(const char* ctx, int rc);
 static bool db_open();
 static void db_close();
 static bool db_exec(const char* sql);
@@ -357,10 +717,11 @@ static bool db_load_vault();
 static bool db_save_vault(); // used when we need a full rewrite; generally we do incremental updates
 static bool db_insert_category(const String& name, int32_t& out_id);
 static bool db_update_category_name(int32_t id, const String& name);
+static bool db_update_category_policy(int32_t id, uint8_t policy);
 static bool db_delete_category_if_empty(int32_t id, bool& deleted);
 static bool db_insert_item(int32_t category_id, const PasswordItem& it);
 static bool db_update_item_label(const String& item_id, const String& new_label_plain);
-static bool db_update_item_password(const String& item_id, const String& new_ct_b64, const String& new_nonce_b64, const PasswordVersion* oldVersionOrNull);
+static bool db_update_item_password(const String& item_id, const String& new_ct_b64, const String& new_nonce_b64, const String& new_fp, const PasswordVersion* oldVersionOrNull);
 static bool db_delete_item(const String& item_id);
 static bool db_move_item(const String& item_id, int32_t new_category_id);
 static bool db_column_exists(const char* table, const char* col);
@@ -371,6 +732,63 @@ static bool db_upsert_item_meta_label(const String& item_id,const String& label_
 static bool db_upsert_item_meta_label_plain(const String& item_id, const String& plain_label);
 static bool db_migrate_encrypt_names_labels_if_needed(bool wipe_plaintext);
 
+// Vault-key rotation
+static bool rekey_begin(const String& pin, String& out_recovery_key_b64);
+static bool rekey_run();
+static bool rekey_resume_if_pending();
+static void settingsRotateVaultKey();
+static bool rekey_begin_suite(CipherSuite suite);
+static void settingsCipherSuite();
+
+// Password-reuse index
+static bool password_fingerprint(const uint8_t* pw, size_t len, String& out_hex);
+static bool password_fingerprint(const SecureString& pw, String& out_hex);
+static bool fp_index_backfill();
+static bool fp_index_invalidate();
+static void settingsReuseAudit();
+
+// Auto-lock
+static inline void touchActivity();
+static void lockAndReboot(const char* reason);
+
+// Integrity tree
+// Wraps one CRUD transaction: construct after db_begin() (before the row changes),
+// then commit() folds the leaf's new value into the tree and commits.
+class IntegTouch {
+public:
+  explicit IntegTouch(const String& item_id);
+  explicit IntegTouch(int32_t category_id, bool is_new = false);
+  bool commit();
+private:
+  bool leaf(uint8_t out[32]);
+  String  item_;
+  int32_t cat_ = -1;
+  bool    active_ = false;
+  bool    ok_ = true;
+  uint8_t before_[32] = {0};
+};
+
+// Holds back the NVS write of the root until the outermost batch ends (import).
+struct IntegBatch {
+  IntegBatch();
+  ~IntegBatch();
+};
+
+static bool integ_sealed();
+static bool integ_seal_if_needed();
+static bool integ_rebuild();
+static bool integ_invalidate();
+static void integ_unseal_for_rekey();
+static void integ_check_at_unlock();
+static bool integ_idle_slice();
+
+// Password strength
+static StrengthResult estimate_strength(const char* pw, size_t n);
+static StrengthResult estimate_strength(const SecureString& pw);
+static const char* strength_label(uint8_t score);
+static bool confirmPasswordStrength(const SecureString& pw);
+static void settingsStrengthAudit();
+
 // ADDED: MSC mode helpers
 static bool consumeMSCFlag();
 static void setMSCFlagAndReboot();
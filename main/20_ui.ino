@@ -19,7 +19,11 @@ static void build_masked_preview(char* out, size_t out_size, size_t len) {
 }
 
 // ==== UI Callbacks for text input ====
-static void TI_OnSave(const char* s) { g_ti_result = String(s); g_ti_done = true; }
+static void TI_OnSave(const char* s) {
+  if (g_ti_secret) g_ti_secret->assign(s);
+  else g_ti_result = String(s);
+  g_ti_done = true;
+}
 static void TI_OnCancel() { g_ti_canceled = true; g_ti_done = true; }
 
 // Welcome/Unlock helpers
@@ -79,6 +83,45 @@ static void updateLoading(const char* subtitle) {
   menuLoopAuto();
 }
 
+// Progress bar drawn in the (empty) menu area of the loading screen.
+static int  g_loading_last_pm = -1;
+static bool g_loading_back_armed = false;
+
+static void drawLoadingProgress(uint32_t done, uint32_t total) {
+  int pm = total ? (int)((uint64_t)done * 1000 / total) : 1000;
+  if (pm / 10 == g_loading_last_pm / 10 && g_loading_last_pm >= 0) return; // redraw per 1%
+  g_loading_last_pm = pm;
+
+  const uint16_t x = menu.mStartX;
+  const uint16_t y = menu.mStartY + 8;
+  const uint16_t w = (LCD_Width() > 2 * x) ? (uint16_t)(LCD_Width() - 2 * x) : 0;
+  const uint16_t h = 12;
+  if (w < 8) return;
+  uint16_t fillW = (uint16_t)((uint32_t)(w - 4) * (uint32_t)pm / 1000);
+  LCD_DrawRect(x, y, w, h, UI_ColorFg());
+  if (fillW) LCD_FillRect(x + 2, y + 2, fillW, h - 4, UI_ColorAccent());
+  LCD_Present();
+}
+
+// KdfProgressFn hooks: the cancelable one stops on a fresh BACK press.
+static bool loadingKdfProgress(uint32_t done, uint32_t total) {
+  if (done == 0) {
+    g_loading_last_pm = -1;
+    g_loading_back_armed = false;
+    pinMode(BTN_BACK, INPUT_PULLUP);
+  }
+  drawLoadingProgress(done, total);
+  int a = digitalRead(BTN_BACK);
+  if (a == HIGH) g_loading_back_armed = true;
+  return !(g_loading_back_armed && a == LOW);
+}
+
+static bool loadingKdfProgressNoCancel(uint32_t done, uint32_t total) {
+  if (done == 0) g_loading_last_pm = -1;
+  drawLoadingProgress(done, total);
+  return true;
+}
+
 static void hideLoading() {
   menu.clearScreen(BLACK);
   menuLoopAuto();
@@ -174,26 +217,28 @@ static bool selectDestinationCategory(size_t sourceCidx, size_t& outDestCidx) {
 
 enum class PwGenMode : uint8_t { Auto = 0, Manual, Cancel };
 
-static volatile bool g_pw_mode_done = false;
-static volatile uint8_t g_pw_mode_choice = 2;
+static volatile bool g_choice_done = false;
+static volatile uint8_t g_choice_idx = 0;
+static uint8_t g_choice_cancel = 0;
 
-static void PW_MODE_OnSelect(uint8_t idx, const char* /*label*/) {
-  g_pw_mode_choice = idx;
-  g_pw_mode_done = true;
+static void CHOICE_OnSelect(uint8_t idx, const char* /*label*/) {
+  g_choice_idx = idx;
+  g_choice_done = true;
 }
-static void PW_MODE_OnBack() {
-  g_pw_mode_choice = 2; // CANCEL
-  g_pw_mode_done = true;
+static void CHOICE_OnBack() {
+  g_choice_idx = g_choice_cancel;
+  g_choice_done = true;
 }
 
-static PwGenMode promptPwGenMode(const char* title = "Password Mode") {
+// Modal pick-one list; the last entry is the cancel item and Back selects it.
+static uint8_t promptChoice(const char* title, const char* subtitle,
+                            const char** items, uint8_t count, uint8_t initial = 0) {
   // Build modal screen
   menu.clearScreen(BLACK);
   menu.setTitle(title);
-  menu.setSubTitle("Choose method");
-  static const char* items[] = { "[ AUTO GENERATE ]", "[ MANUAL DEFINE ]", "[ CANCEL ]" };
-  menu.setMenu(items, 3);
-  menu.setSelectedIndex(0);
+  menu.setSubTitle(subtitle);
+  menu.setMenu(items, count);
+  menu.setSelectedIndex(initial < count ? initial : 0);
 
   // Save state to restore after modal
   MenuContext savedCtx = g_menuCtx;
@@ -205,22 +250,23 @@ static PwGenMode promptPwGenMode(const char* title = "Password Mode") {
   menu.setOnBack(nullptr);
 
   // Modal handlers
-  g_pw_mode_done = false;
-  g_pw_mode_choice = 2; // default: CANCEL
-  menu.setOnSelect(PW_MODE_OnSelect);
-  menu.setOnBack(PW_MODE_OnBack);
+  g_choice_done = false;
+  g_choice_cancel = count - 1;
+  g_choice_idx = g_choice_cancel;
+  menu.setOnSelect(CHOICE_OnSelect);
+  menu.setOnBack(CHOICE_OnBack);
 
   pinMode(BTN_SELECT, INPUT_PULLUP);
   int lastB = digitalRead(BTN_SELECT);
 
-  while (!g_pw_mode_done) {
+  while (!g_choice_done) {
     menuLoopAuto();
     int b = digitalRead(BTN_SELECT);
     if (lastB == HIGH && b == LOW) {
       // Treat physical press as "select current"
       int sel = menu.getSelectedIndex();
-      g_pw_mode_choice = (sel >= 0 && sel < 3) ? sel : 2;
-      g_pw_mode_done = true;
+      g_choice_idx = (sel >= 0 && sel < count) ? sel : g_choice_cancel;
+      g_choice_done = true;
     }
     lastB = b;
     delay(5);
@@ -248,12 +294,30 @@ static PwGenMode promptPwGenMode(const char* title = "Password Mode") {
 
   // Restore context last
   g_menuCtx = savedCtx;
+  return g_choice_idx;
+}
 
-  if (g_pw_mode_choice == 0) return PwGenMode::Auto;
-  if (g_pw_mode_choice == 1) return PwGenMode::Manual;
+static PwGenMode promptPwGenMode(const char* title = "Password Mode") {
+  static const char* items[] = { "[ AUTO GENERATE ]", "[ MANUAL DEFINE ]", "[ CANCEL ]" };
+  uint8_t choice = promptChoice(title, "Choose method", items, 3);
+  if (choice == 0) return PwGenMode::Auto;
+  if (choice == 1) return PwGenMode::Manual;
   return PwGenMode::Cancel;
 }
 
+// Returns the chosen policy index, or -1 when cancelled.
+static int promptPwPolicy(uint8_t current) {
+  static char labels[PW_POLICY_COUNT][24];
+  static const char* items[PW_POLICY_COUNT + 1];
+  for (uint8_t i = 0; i < PW_POLICY_COUNT; ++i) {
+    snprintf(labels[i], sizeof(labels[i]), "%s%s", i == current ? "* " : "", pwpolicy_name(i));
+    items[i] = labels[i];
+  }
+  items[PW_POLICY_COUNT] = "[ CANCEL ]";
+  uint8_t choice = promptChoice("Password Policy", "Auto-generate uses", items, PW_POLICY_COUNT + 1, current);
+  return choice < PW_POLICY_COUNT ? (int)choice : -1;
+}
+
 // OK modal state + callbacks
 static volatile bool g_ok_modal_done = false;
 
@@ -371,24 +435,19 @@ static void showArchivesForItem(Category& cat, size_t pwdIdx) {
     menu.setTitle(tbuf);
 
     // Subtitle: masked preview of archived password
-    String masked = "<decrypt err>";
+    static char sbuf[160];
     {
-      String tmp;
+      SecureString tmp;
       if (decrypt_password_history_version(it, hist[order[posIdx]], tmp)) {
-        if (tmp.length() <= 4) masked = tmp;
-        else {
-          masked = tmp.substring(0, 4);
-          for (size_t i = 4; i < tmp.length(); ++i) masked += '*';
-        }
-        for (size_t i = 0; i < tmp.length(); ++i) tmp.setCharAt(i, 0);
-        tmp = "";
+        size_t total = min(tmp.length(), sizeof(sbuf) - 1);
+        size_t shown = min((size_t)4, total);
+        if (shown) memcpy(sbuf, tmp.c_str(), shown);
+        build_masked_preview(sbuf + shown, sizeof(sbuf) - shown, total - shown);
+      } else {
+        strncpy(sbuf, "<decrypt err>", sizeof(sbuf) - 1);
+        sbuf[sizeof(sbuf) - 1] = 0;
       }
     }
-
-    static char sbuf[160];
-    size_t n = min(sizeof(sbuf) - 1, (size_t)masked.length());
-    memcpy(sbuf, masked.c_str(), n);
-    sbuf[n] = 0;
     menu.setSubTitle(sbuf);
 
     // Build menu: SEND, SHOW, (NEXT), (PREV), BACK
@@ -446,20 +505,16 @@ static void showArchivesForItem(Category& cat, size_t pwdIdx) {
     if (lastB == HIGH && b == LOW) {
       String L = currentLabel();
       if (L == "[ SEND PASSWORD ]") {
-        String pw;
+        SecureString pw;
         if (decrypt_password_history_version(it, hist[order[pos]], pw)) {
           hidKeyboardTypeString(pw);
-          for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-          pw = "";
         } else {
           waitForButtonB("Error", "Decrypt failed", "OK");
         }
       } else if (L == "[ SHOW PASSWORD ]") {
-        String pw;
+        SecureString pw;
         if (decrypt_password_history_version(it, hist[order[pos]], pw)) {
           waitForButtonB("Archived", pw.c_str(), "OK");
-          for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-          pw = "";
         } else {
           waitForButtonB("Error", "Decrypt failed", "OK");
         }
@@ -616,6 +671,17 @@ static String runTextInput(const char* title,
   return g_ti_result;
 }
 
+// Same UI as runTextInput, but the typed text goes straight into an arena slot.
+static bool runSecretInput(const char* title, const char* description, uint8_t maxLen, SecureString& out) {
+  out.clear();
+  g_ti_secret = &out;
+  runTextInput(title, description, maxLen, TextInputUI::InputMode::STANDARD, false);
+  g_ti_secret = nullptr;
+  input.clear();  // the widget's edit buffer still holds the typed text
+  if (g_ti_canceled) out.clear();
+  return !out.isEmpty();
+}
+
 static String promptPasscode6(const char* title, const char* desc) {
   Serial.printf("[UI] promptPasscode6: %s | %s\n", title, desc);
   return runTextInput(title, desc, 6, TextInputUI::InputMode::PASSCODE, true);
@@ -645,133 +711,8 @@ static void hidKeyboardTypeBytes(const uint8_t* p, size_t n) {
   delay(5);
 }
 
-static bool passcodeScreensaverWakeRequested() {
-  g_rotary.update();
-  return g_rotary.wasTurnedCW() || g_rotary.wasTurnedCCW() ||
-         g_rotary.wasPressedA() || g_rotary.wasPressedB() ||
-         g_rotary.wasReleasedA();
-}
-
-static void drawPasscodeScreensaverFrame(uint8_t palette, unsigned long tick) {
-  const uint16_t bg = UI_ColorBg();
-  const uint16_t fg = UI_ColorFg();
-  const uint16_t accent = UI_ColorAccent();
-  const uint16_t selBg = UI_ColorSelectedBg();
-  const char* paletteName = UI_PaletteName(palette);
-
-  LCD_BeginFrame();
-  LCD_Clear(bg);
-
-  if (strcmp(paletteName, "MATRIX") == 0) {
-    static const char glyphs[] = "0123456789ABCDEF#%+*?@";
-    static const uint8_t glyphCount = sizeof(glyphs) - 1;
-    const uint16_t colStep = 9;
-    const uint16_t rowStep = 10;
-
-    for (uint16_t x = 6; x < LCD_Width(); x += colStep) {
-      const uint16_t columnSeed = (uint16_t)(x * 10U);
-      const uint16_t trailLen = (uint16_t)(10 + ((x / colStep) % 6));
-      const uint16_t speed = (uint16_t)(2 + ((x / colStep) % 3));
-      const uint16_t head = (uint16_t)(((tick / speed) + columnSeed) % (LCD_Height() + trailLen * rowStep + 40));
-
-      for (uint8_t i = 0; i < trailLen; ++i) {
-        int16_t y = (int16_t)head - (int16_t)(i * rowStep);
-        if (y < -12 || y > (int16_t)LCD_Height() - 12) continue;
-
-        uint16_t glyphIdx = (uint16_t)((tick / 2 + columnSeed + i * 7U) % glyphCount);
-        char c[2] = { glyphs[glyphIdx], 0 };
-
-        uint16_t color = accent;
-        if (i == 0) color = selBg;
-        else if (i <= 8) color = fg;
-
-        drawString(x, (uint16_t)y, c, color, bg, 1, false);
-      }
-    }
-
-    //drawString(18, (uint16_t)(LCD_Height() - 28), "", accent, bg, 1, false);
-
-  } else if (strcmp(paletteName, "PIPBOY") == 0) {
-    drawString(18, 36, "PIP-OS 3000", fg, bg, 2, false);
-    drawString(18, 62, "VAULT ACCESS LOCKED", accent, bg, 1, false);
-
-    const uint16_t graphX = 16;
-    const uint16_t graphY = 104;
-    const uint16_t graphW = 138;
-    const uint16_t graphH = 72;
-    LCD_DrawRect(graphX, graphY, graphW, graphH, fg);
-    for (uint16_t x = graphX + 4; x < graphX + graphW - 4; x += 10) LCD_DrawLine(x, graphY + 1, x, graphY + graphH - 2, accent);
-    for (uint16_t y = graphY + 10; y < graphY + graphH - 2; y += 10) LCD_DrawLine(graphX + 1, y, graphX + graphW - 2, y, accent);
-
-    uint16_t prevX = graphX + 4;
-    uint16_t prevY = graphY + graphH / 2;
-    for (uint16_t x = 0; x < graphW - 10; x += 6) {
-      uint16_t px = graphX + 4 + x;
-      uint16_t wave = (uint16_t)((tick / 3 + x * 5U) % 48U);
-      uint16_t py = (uint16_t)(graphY + 10 + (wave < 24 ? wave : 48 - wave));
-      LCD_DrawLine(prevX, prevY, px, py, selBg);
-      prevX = px;
-      prevY = py;
-    }
-
-    char statA[24];
-    char statB[24];
-    snprintf(statA, sizeof(statA), "SIG %02u%%", (unsigned)((tick / 5) % 100));
-    snprintf(statB, sizeof(statB), "RAD %02u", (unsigned)((tick / 7) % 40));
-    drawString(18, 196, statA, fg, bg, 2, false);
-    drawString(18, 224, statB, fg, bg, 2, false);
-    drawString(18, 262, "TAP ANY KEY TO WAKE", accent, bg, 1, false);
-
-  } else if (strcmp(paletteName, "TERMINAL") == 0) {
-    drawString(18, 70, "POCKET PASS", fg, bg, 2, false);
-    drawString(18, 110, "SYSTEM LOCKED", fg, bg, 2, false);
-    drawString(18, 150, "> ENTER PASSCODE_", (tick / 20) % 2 ? fg : accent, bg, 2, false);
-    for (uint16_t y = 200; y < 280; y += 16) {
-      char line[20];
-      snprintf(line, sizeof(line), "CHK %02u  OK", (unsigned)((tick / 7 + y) % 100));
-      drawString(18, y, line, accent, bg, 1, false);
-    }
-
-  } else if (strcmp(paletteName, "MONO") == 0) {
-    uint16_t box = 28;
-    uint16_t x = (uint16_t)((tick / 2) % (LCD_Width() - box));
-    uint16_t y = (uint16_t)((tick / 3) % (LCD_Height() - box));
-    LCD_DrawRect(x, y, box, box, fg);
-    drawString(26, 145, "LOCKED", fg, bg, 3, false);
-
-  } else if (strcmp(paletteName, "ICE") == 0) {
-    for (uint16_t y = 20; y < LCD_Height(); y += 26) {
-      uint16_t w = (uint16_t)(30 + ((tick + y * 7U) % 90));
-      LCD_FillRect(10, y, w, 4, accent);
-    }
-    drawString(24, 140, "ICE LOCK", fg, bg, 3, false);
-
-  } else if (strcmp(paletteName, "AMBER") == 0) {
-    drawString(24, 70, "AMBER CRT", fg, bg, 3, false);
-    for (uint16_t y = 120; y < 250; y += 18) {
-      char hexline[18];
-      snprintf(hexline, sizeof(hexline), "%04X %04X", (unsigned)((tick + y) & 0xFFFF), (unsigned)((tick * 3 + y * 9) & 0xFFFF));
-      drawString(32, y, hexline, accent, bg, 2, false);
-    }
-
-  } else {
-    uint16_t radius = (uint16_t)(18 + ((tick / 4) % 24));
-    LCD_DrawCircle(LCD_Width() / 2, LCD_Height() / 2, radius, fg);
-    LCD_DrawCircle(LCD_Width() / 2, LCD_Height() / 2, radius + 12, accent);
-    drawString(28, 142, UI_PaletteName(palette), selBg, bg, 2, false);
-    drawString(40, 172, "LOCKED", fg, bg, 2, false);
-  }
-
-  LCD_EndFrame();
-}
-
-static void runPasscodeScreensaver() {
-  const uint8_t palette = UI_GetPalette();
-  while (true) {
-    if (passcodeScreensaverWakeRequested()) break;
-    drawPasscodeScreensaverFrame(palette, millis() / 4UL);
-    delay(40);
-  }
+static void hidKeyboardTypeString(const SecureString& s) {
+  hidKeyboardTypeBytes(s.bytes(), s.length());
 }
 
 // ==== Menu Bridges ====
@@ -818,6 +759,8 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
         waitForButtonB("Limit Reached", "Max passwords is 60", "OK");
       } else if (Ls == "[ EDIT CATEGORY ]") {
         editCategory(g_ctx_categoryIndex);
+      } else if (Ls == "[ PASSWORD POLICY ]") {
+        editCategoryPolicy(g_ctx_categoryIndex);
       } else if (Ls == "[ DELETE CATEGORY ]") {
         deleteCategoryIfEmpty(g_ctx_categoryIndex);
       } else if (Ls == "[ BACK ]") {
@@ -841,20 +784,18 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
       }
 
       if (L == "[ SEND PASSWORD ]") {
-        SecureBuf pw;
-        if (decrypt_password_bytes(cat.items[pwdIdx], cat.items[pwdIdx].id, pw)) {
-          hidKeyboardTypeBytes(pw.b.data(), pw.b.size());
-          pw.clear();  // wipes + frees
+        SecureString pw;
+        if (decrypt_password(cat.items[pwdIdx], cat.items[pwdIdx].id, pw)) {
+          hidKeyboardTypeString(pw);
         } else {
           waitForButtonB("Error", "Decrypt failed", "OK");
           restoreFromReturnState();
         }
       } else if (L == "[ SHOW PASSWORD ]") {
-        String pw;
+        SecureString pw;
         if (decrypt_password(cat.items[pwdIdx], cat.items[pwdIdx].id, pw)) {
           waitForButtonB("Password", pw.c_str(), "OK");
-          for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-          pw = "";
+          pw.clear();
           restoreFromReturnState();
         } else {
           waitForButtonB("Error", "Decrypt failed", "OK");
@@ -867,13 +808,22 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
           break;
         }
       
-        String newpw;
+        SecureString newpw;
         if (mode == PwGenMode::Auto) {
-          newpw = generatePassword(g_settings);
+          if (!generatePassword(pwpolicy_for_category(cat), newpw)) {
+            waitForButtonB("Error", "Generate failed", "OK");
+            restoreFromReturnState();
+            break;
+          }
         } else {
-          newpw = runTextInput("Manual Password", "Enter password", 64, TextInputUI::InputMode::STANDARD, false);
-          newpw.trim();
-          if (newpw.length() == 0) {
+          bool keep = false;
+          while (!keep) {
+            runSecretInput("Manual Password", "Enter password", 64, newpw);
+            newpw.trim();
+            if (newpw.length() == 0) break;
+            keep = confirmPasswordStrength(newpw);
+          }
+          if (!keep) {
             restoreFromReturnState();
             break;
           }
@@ -888,12 +838,13 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
           oldv.ts = millis();
           hadOld = true;
         }
-        String new_ct_b64, new_nonce_b64;
+        String new_ct_b64, new_nonce_b64, new_fp;
+        password_fingerprint(newpw, new_fp);
         if (!encrypt_password_only_for_item(it.id, newpw, new_ct_b64, new_nonce_b64)) {
           waitForButtonB("Error", "Rotate failed", "OK");
           restoreFromReturnState();
         } else {
-          if (!db_update_item_password(it.id, new_ct_b64, new_nonce_b64, hadOld ? &oldv : nullptr)) {
+          if (!db_update_item_password(it.id, new_ct_b64, new_nonce_b64, new_fp, hadOld ? &oldv : nullptr)) {
             waitForButtonB("Error", "DB update failed", "OK");
             restoreFromReturnState();
           } else {
@@ -904,8 +855,7 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
             restoreFromReturnState();
           }
         }
-        for (size_t i = 0; i < newpw.length(); ++i) newpw.setCharAt(i, 0);
-        newpw = "";
+        newpw.clear();
       } else if (L == "[ SHOW ARCHIVES ]") {
         showArchivesForItem(cat, pwdIdx);
       } else if (L == "[ MOVE TO CATEGORY ]") {
@@ -964,22 +914,11 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
         return; // reboots into MSC
 
       } else if (L == "[ UPDATE SECURITY ]") {
-        String cur = promptPasscode6("Auth", "Enter current passcode");
-        LoadingScope loading("LOADING", "Checking...");
-        if (cur.length() != 6) { 
-          rebuildSettingsScreen(); return; 
-        }
-      
-        std::vector<uint8_t> Wcur;
-        if (!derive_W(cur, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wcur)) {
-          waitForButtonB("Error", "KDF derive failed", "OK");
-          rebuildSettingsScreen(); return;
-        }
-        if (!check_verifier(Wcur, g_meta.verifier_normal_b64)) {
-          waitForButtonB("Error", "Wrong passcode", "OK");
+        String cur;
+        if (!auth_with_current_pin_get(cur, "Enter current passcode")) {
           rebuildSettingsScreen(); return;
         }
-        std::fill(Wcur.begin(), Wcur.end(), 0);
+        LoadingScope loading("LOADING", "Preparing...");
       
         uint8_t lvl = 0; uint32_t new_iters = 0;
         if (!promptSecurityLevel(lvl, new_iters, "Security Level")) {
@@ -998,42 +937,34 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
         updateLoading("Deriving key...");
         String rkey = generate_recovery_key_b64();
       
-        std::vector<uint8_t> WnNew;
-        if (!derive_W(p1, g_meta.kdf_salt1, g_meta.kdf_salt2, new_iters, WnNew)) {
-          waitForButtonB("Error", "KDF derive failed", "OK");
+        String pin_plus_rk_new = p1 + rkey;
+        SecureBuf WnNew, WrNew;
+        bool derivedNew;
+        {
+          KdfProgressScope progress(loadingKdfProgress);
+          derivedNew = derive_W_pair(p1, pin_plus_rk_new, g_meta.kdf_salt1, g_meta.kdf_salt2, new_iters, WnNew.b, WrNew.b);
+        }
+        if (!derivedNew) {
+          waitForButtonB("Error", kdf_was_canceled() ? "Canceled" : "KDF derive failed", "OK");
           rebuildSettingsScreen(); return;
         }
         String ver_n_b64;
-        if (!make_verifier(WnNew, ver_n_b64)) {
-          std::fill(WnNew.begin(), WnNew.end(), 0);
+        if (!make_verifier(WnNew.b, ver_n_b64)) {
           waitForButtonB("Error", "Verifier fail (normal)", "OK");
           rebuildSettingsScreen(); return;
         }
         String ct_n_b64, nonce_n_b64;
-        if (!wrap_vault_key(WnNew, g_crypto.vault_key, ct_n_b64, nonce_n_b64)) {
-          std::fill(WnNew.begin(), WnNew.end(), 0);
+        if (!wrap_vault_key(WnNew.b, keyring_vault_key(), ct_n_b64, nonce_n_b64)) {
           waitForButtonB("Error", "Wrap fail (normal)", "OK");
           rebuildSettingsScreen(); return;
         }
-      
-        String pin_plus_rk_new = p1 + rkey;
-        std::vector<uint8_t> WrNew;
-        if (!derive_W_recovery_only(pin_plus_rk_new, g_meta.kdf_salt1, g_meta.kdf_salt2, new_iters, WrNew)) {
-          std::fill(WnNew.begin(), WnNew.end(), 0);
-          waitForButtonB("Error", "KDF derive failed (recovery)", "OK");
-          rebuildSettingsScreen(); return;
-        }
         String ver_r_b64;
-        if (!make_verifier(WrNew, ver_r_b64)) {
-          std::fill(WnNew.begin(), WnNew.end(), 0);
-          std::fill(WrNew.begin(), WrNew.end(), 0);
+        if (!make_verifier(WrNew.b, ver_r_b64)) {
           waitForButtonB("Error", "Verifier fail (recovery)", "OK");
           rebuildSettingsScreen(); return;
         }
         String ct_r_b64, nonce_r_b64;
-        if (!wrap_vault_key(WrNew, g_crypto.vault_key, ct_r_b64, nonce_r_b64)) {
-          std::fill(WnNew.begin(), WnNew.end(), 0);
-          std::fill(WrNew.begin(), WrNew.end(), 0);
+        if (!wrap_vault_key(WrNew.b, keyring_vault_key(), ct_r_b64, nonce_r_b64)) {
           waitForButtonB("Error", "Wrap fail (recovery)", "OK");
           rebuildSettingsScreen(); return;
         }
@@ -1047,17 +978,30 @@ static void MENU_OnSelect(uint8_t idx, const char* label) {
         g_meta.vault_wrap_recovery_nonce_b64 = nonce_r_b64;
       
         bool saved = saveMeta();
-        std::fill(WnNew.begin(), WnNew.end(), 0);
-        std::fill(WrNew.begin(), WrNew.end(), 0);
+        WnNew.clear();
+        WrNew.clear();
       
         if (!saved) {
           waitForButtonB("Error", "Save failed", "OK");
           rebuildSettingsScreen(); return;
         }
+        session_auth_arm(p1);
       
         showRecoveryKeyOnce(rkey);
         waitForButtonB("Info", "Security updated", "OK");
         rebuildSettingsScreen();
+      } else if (L == "[ ROTATE KEY ]") {
+        settingsRotateVaultKey();
+        rebuildSettingsScreen();
+      } else if (L == "[ CIPHER SUITE ]") {
+        settingsCipherSuite();
+        rebuildSettingsScreen();
+      } else if (L == "[ REUSE AUDIT ]") {
+        settingsReuseAudit();
+        rebuildSettingsScreen();
+      } else if (L == "[ STRENGTH AUDIT ]") {
+        settingsStrengthAudit();
+        rebuildSettingsScreen();
       } else if (L == "[ ACCESS SDCARD ]") {
         settingsAccessSDCardMode();
         return; // will reboot
@@ -1301,6 +1245,21 @@ static void showPrivacyScreen() {
   menu.showInfoModal(title, subtitle, content, "[ BACK ]", 21, false);
 }
 
+// Reads the highlighted category's items while the user rests on it in the main menu,
+// so opening it is instant. Runs in the UI loop: g_db and g_vault are not shared with other tasks.
+static void prefetchHighlightedCategory() {
+#if PP_PREFETCH_IDLE_MS
+  static int lastSel = -1;
+  static unsigned long since = 0;
+  int sel = menu.getSelectedIndex();
+  if (sel != lastSel) { lastSel = sel; since = millis(); return; }
+  if (sel < 0 || (size_t)sel >= g_vault.categories.size()) return;
+  Category& c = g_vault.categories[sel];
+  if (c.items_loaded || millis() - since < PP_PREFETCH_IDLE_MS) return;
+  if (!loadCategoryItems(c)) since = millis(); // retry after another idle period
+#endif
+}
+
 static void buildAndShowMainMenu() {
   Serial.println("[UI] buildAndShowMainMenu");
   menu.clearScreen(BLACK);
@@ -1330,7 +1289,14 @@ static void buildAndShowMainMenu() {
   menu.setOnSelect(MENU_OnSelect);
   menu.setOnBack(MENU_OnBack);
 
-  while (!g_menu_done) menuLoopAuto();
+  while (!g_menu_done) {
+    menuLoopAuto();
+    prefetchHighlightedCategory();
+    if (integ_idle_slice()) {
+      buildAndShowMainMenu();
+      return;
+    }
+  }
 
   menu.setOnSelect(nullptr);
   menu.setOnBack(nullptr);
@@ -1346,6 +1312,19 @@ static void categoryScreen(size_t cidx) {
   Serial.printf("[UI] categoryScreen cidx=%u\n", (unsigned)cidx);
   if (cidx >= g_vault.categories.size()) { buildAndShowMainMenu(); return; }
   Category& cat = g_vault.categories[cidx];
+  if (!cat.items_loaded) {
+    bool ok;
+    {
+      LoadingScope loading("LOADING", "Reading items...");
+      ok = loadCategoryItems(cat);
+    }
+    if (!ok) {
+      waitForButtonB("Error", "Load items failed", "OK");
+      g_state = UiState::MainMenu;
+      buildAndShowMainMenu();
+      return;
+    }
+  }
 
   auto buildMainList = [&](){
     menu.clearScreen(BLACK);
@@ -1374,6 +1353,7 @@ static void categoryScreen(size_t cidx) {
     }
 
     items[count++] = "[ EDIT CATEGORY ]";
+    items[count++] = "[ PASSWORD POLICY ]";
     if (cat.items.empty()) items[count++] = "[ DELETE CATEGORY ]";
     items[count++] = "[ BACK ]";
 
@@ -1409,19 +1389,16 @@ static void categoryScreen(size_t cidx) {
     // Subtitle: masked password preview using fixed buffer
     static char sbuf[160];
     {
-      String pw;
+      SecureString pw;
       if (pidx < cat.items.size() && decrypt_password(cat.items[pidx], cat.items[pidx].id, pw)) {
         size_t total = pw.length();
         size_t n_copy = min((size_t)4, total);
         size_t pos = 0;
-        for (; pos < n_copy && pos < sizeof(sbuf) - 1; ++pos) sbuf[pos] = pw[(int)pos];
+        for (; pos < n_copy && pos < sizeof(sbuf) - 1; ++pos) sbuf[pos] = pw[pos];
         size_t remain = total > n_copy ? total - n_copy : 0;
         size_t to_mask = min(remain, sizeof(sbuf) - 1 - pos);
         for (size_t i = 0; i < to_mask; ++i) sbuf[pos++] = '*';
         sbuf[pos] = 0;
-
-        for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-        pw = "";
       } else {
         strncpy(sbuf, "<decrypt err>", sizeof(sbuf) - 1);
         sbuf[sizeof(sbuf) - 1] = 0;
@@ -1523,6 +1500,10 @@ static void settingsMenu() {
     "[ IMPORT ]",
     "[ EXPORT ]",
     "[ UPDATE SECURITY ]",
+    "[ ROTATE KEY ]",
+    "[ CIPHER SUITE ]",
+    "[ REUSE AUDIT ]",
+    "[ STRENGTH AUDIT ]",
     "[ ACCESS SDCARD ]",
     "[ ABOUT ]",
     "[ LICENSE ]",
@@ -1530,7 +1511,7 @@ static void settingsMenu() {
     "[ CREDITS ]",
     "[ BACK ]"
   };
-  menu.setMenu(items, 11);
+  menu.setMenu(items, 15);
   menu.setSelectedIndex(0);
   g_menuCtx = MenuContext::Settings;
   g_menu_done = false;
@@ -0,0 +1,383 @@
+//21_screensaver.ino
+// ==== Passcode screensaver ====
+// Each theme paints its static layer once in begin(), then step() repaints only
+// what changed and returns the ms until its next change. The loop sleeps in
+// between, waking every PP_SAVER_POLL_MS to check the keys, so a locked device
+// spends nearly all of its time idle with the SPI bus quiet.
+
+struct SaverCtx {
+  UIColor bg, fg, accent, selBg;
+  const char* name;
+};
+
+struct SaverTheme {
+  const char* palette;  // matched once against UI_PaletteName(); nullptr = fallback
+  void (*begin)(const SaverCtx&, unsigned long now);
+  uint32_t (*step)(const SaverCtx&, unsigned long now);
+};
+
+// True once every period ms; next is advanced past now so a long stall does not replay.
+static bool saverDue(unsigned long now, unsigned long& next, uint32_t period) {
+  if ((long)(now - next) < 0) return false;
+  next += period;
+  if ((long)(now - next) >= 0) next = now + period;
+  return true;
+}
+
+static uint32_t saverUntil(unsigned long now, unsigned long next) {
+  return ((long)(next - now) > 0) ? (uint32_t)(next - now) : 0;
+}
+
+// Erase the text's box back to the backdrop and draw it again.
+static void saverText(const SaverCtx& c, uint16_t x, uint16_t y, const char* s, UIColor color, uint8_t size) {
+  uint16_t w = 0, h = 0;
+  measureTextSingleLine(s, size, w, h);
+  LCD_FillRect(x, y, w, h, c.bg);
+  drawString(x, y, s, color, c.bg, size, false);
+}
+
+static bool saverOverlaps(int16_t ax, int16_t ay, int16_t aw, int16_t ah,
+                          int16_t bx, int16_t by, int16_t bw, int16_t bh) {
+  return ax < bx + bw && bx < ax + aw && ay < by + bh && by < ay + ah;
+}
+
+// ---- MATRIX: glyph rain on a fixed grid. A head step touches four cells. ----
+static const uint8_t SAVER_MATRIX_MAX_COLS = 40;
+static const uint8_t kMatrixColStep = 9;
+static const uint8_t kMatrixRowStep = 10;
+static const char    kMatrixGlyphs[] = "0123456789ABCDEF#%+*?@";
+
+struct MatrixColumn {
+  int16_t head;
+  uint8_t trail;
+  uint8_t cycle;
+  uint16_t periodMs;
+  unsigned long next;
+};
+static MatrixColumn g_matrixCols[SAVER_MATRIX_MAX_COLS];
+static uint8_t g_matrixColCount = 0;
+static int16_t g_matrixRows = 0;
+
+static char matrixGlyph(uint8_t col, int16_t row, uint8_t cycle) {
+  uint32_t h = (uint32_t)col * 2654435761u ^ (uint32_t)(row + 64) * 40503u ^ (uint32_t)cycle * 97u;
+  h ^= h >> 13;
+  return kMatrixGlyphs[h % (sizeof(kMatrixGlyphs) - 1)];
+}
+
+// age 0 = head, 1..8 = bright trail, older = dim trail, < 0 = erased.
+static void matrixCell(const SaverCtx& c, uint8_t col, int16_t row, int16_t age) {
+  if (row < 0 || row >= g_matrixRows) return;
+  const MatrixColumn& mc = g_matrixCols[col];
+  const uint16_t x = (uint16_t)(6 + col * kMatrixColStep);
+  const uint16_t y = (uint16_t)(row * kMatrixRowStep);
+  LCD_FillRect(x, y, 6, 8, c.bg);
+  if (age < 0 || age >= mc.trail) return;
+  const UIColor color = (age == 0) ? c.selBg : (age <= 8 ? c.fg : c.accent);
+  const char s[2] = { matrixGlyph(col, row, mc.cycle), 0 };
+  drawString(x, y, s, color, c.bg, 1, false);
+}
+
+static void saverMatrixBegin(const SaverCtx& c, unsigned long now) {
+  g_matrixRows = (int16_t)(LCD_Height() / kMatrixRowStep);
+  g_matrixColCount = 0;
+  for (uint16_t x = 6; x < LCD_Width() && g_matrixColCount < SAVER_MATRIX_MAX_COLS; x += kMatrixColStep) {
+    const uint8_t i = g_matrixColCount++;
+    MatrixColumn& mc = g_matrixCols[i];
+    mc.trail = (uint8_t)(10 + i % 6);
+    mc.periodMs = (uint16_t)((2 + i % 3) * kMatrixRowStep * 4);
+    mc.cycle = 0;
+    mc.head = (int16_t)((i * 37) % (g_matrixRows + mc.trail));
+    mc.next = now + mc.periodMs;
+    for (int16_t age = 0; age < mc.trail; ++age) matrixCell(c, i, mc.head - age, age);
+  }
+}
+
+static uint32_t saverMatrixStep(const SaverCtx& c, unsigned long now) {
+  uint32_t wait = 1000;
+  for (uint8_t i = 0; i < g_matrixColCount; ++i) {
+    MatrixColumn& mc = g_matrixCols[i];
+    if (saverDue(now, mc.next, mc.periodMs)) {
+      mc.head++;
+      matrixCell(c, i, mc.head, 0);
+      matrixCell(c, i, mc.head - 1, 1);
+      matrixCell(c, i, mc.head - 9, 9);
+      matrixCell(c, i, mc.head - mc.trail, -1);
+      if (mc.head - mc.trail >= g_matrixRows + 4) {
+        mc.head = -(int16_t)(matrixGlyph(i, 0, mc.cycle) % 6);
+        mc.cycle++;
+      }
+    }
+    wait = min(wait, saverUntil(now, mc.next));
+  }
+  return wait;
+}
+
+// ---- PIPBOY: static chrome; the trace and readouts refresh on their own clocks. ----
+static const uint16_t kPipGraphX = 16, kPipGraphY = 104, kPipGraphW = 138, kPipGraphH = 72;
+static unsigned long g_pipWaveNext = 0;
+static unsigned long g_pipStatNext = 0;
+
+static void pipDrawTrace(const SaverCtx& c, unsigned long now) {
+  LCD_FillRect(kPipGraphX + 1, kPipGraphY + 1, kPipGraphW - 2, kPipGraphH - 2, c.bg);
+  for (uint16_t x = kPipGraphX + 4; x < kPipGraphX + kPipGraphW - 4; x += 10) LCD_DrawLine(x, kPipGraphY + 1, x, kPipGraphY + kPipGraphH - 2, c.accent);
+  for (uint16_t y = kPipGraphY + 10; y < kPipGraphY + kPipGraphH - 2; y += 10) LCD_DrawLine(kPipGraphX + 1, y, kPipGraphX + kPipGraphW - 2, y, c.accent);
+
+  const unsigned long phase = now / 12UL;
+  uint16_t prevX = kPipGraphX + 4;
+  uint16_t prevY = kPipGraphY + kPipGraphH / 2;
+  for (uint16_t x = 0; x < kPipGraphW - 10; x += 6) {
+    uint16_t px = kPipGraphX + 4 + x;
+    uint16_t wave = (uint16_t)((phase + x * 5U) % 48U);
+    uint16_t py = (uint16_t)(kPipGraphY + 10 + (wave < 24 ? wave : 48 - wave));
+    LCD_DrawLine(prevX, prevY, px, py, c.selBg);
+    prevX = px;
+    prevY = py;
+  }
+}
+
+static void pipDrawStats(const SaverCtx& c, unsigned long now) {
+  char statA[24];
+  char statB[24];
+  snprintf(statA, sizeof(statA), "SIG %02u%%", (unsigned)((now / 250UL) % 100));
+  snprintf(statB, sizeof(statB), "RAD %02u", (unsigned)((now / 700UL) % 40));
+  saverText(c, 18, 196, statA, c.fg, 2);
+  saverText(c, 18, 224, statB, c.fg, 2);
+}
+
+static void saverPipBegin(const SaverCtx& c, unsigned long now) {
+  drawString(18, 36, "PIP-OS 3000", c.fg, c.bg, 2, false);
+  drawString(18, 62, "VAULT ACCESS LOCKED", c.accent, c.bg, 1, false);
+  LCD_DrawRect(kPipGraphX, kPipGraphY, kPipGraphW, kPipGraphH, c.fg);
+  drawString(18, 262, "TAP ANY KEY TO WAKE", c.accent, c.bg, 1, false);
+  pipDrawTrace(c, now);
+  pipDrawStats(c, now);
+  g_pipWaveNext = now + 100;
+  g_pipStatNext = now + 250;
+}
+
+static uint32_t saverPipStep(const SaverCtx& c, unsigned long now) {
+  if (saverDue(now, g_pipWaveNext, 100)) pipDrawTrace(c, now);
+  if (saverDue(now, g_pipStatNext, 250)) pipDrawStats(c, now);
+  return min(saverUntil(now, g_pipWaveNext), saverUntil(now, g_pipStatNext));
+}
+
+// ---- TERMINAL: blinking prompt and a slow checksum ticker. ----
+static unsigned long g_termBlinkNext = 0;
+static unsigned long g_termChkNext = 0;
+
+static void termDrawPrompt(const SaverCtx& c, unsigned long now) {
+  saverText(c, 18, 150, "> ENTER PASSCODE_", ((now / 500UL) % 2) ? c.fg : c.accent, 2);
+}
+
+static void termDrawChecks(const SaverCtx& c, unsigned long now) {
+  for (uint16_t y = 200; y < 280; y += 16) {
+    char line[20];
+    snprintf(line, sizeof(line), "CHK %02u  OK", (unsigned)((now / 400UL + y) % 100));
+    saverText(c, 18, y, line, c.accent, 1);
+  }
+}
+
+static void saverTermBegin(const SaverCtx& c, unsigned long now) {
+  drawString(18, 70, "POCKET PASS", c.fg, c.bg, 2, false);
+  drawString(18, 110, "SYSTEM LOCKED", c.fg, c.bg, 2, false);
+  termDrawPrompt(c, now);
+  termDrawChecks(c, now);
+  g_termBlinkNext = now + 500;
+  g_termChkNext = now + 400;
+}
+
+static uint32_t saverTermStep(const SaverCtx& c, unsigned long now) {
+  if (saverDue(now, g_termBlinkNext, 500)) termDrawPrompt(c, now);
+  if (saverDue(now, g_termChkNext, 400)) termDrawChecks(c, now);
+  return min(saverUntil(now, g_termBlinkNext), saverUntil(now, g_termChkNext));
+}
+
+// ---- MONO: a drifting outline; only its old edges and new edges are touched. ----
+static const uint16_t kMonoBox = 28;
+static const uint16_t kMonoTextX = 26, kMonoTextY = 145;
+static int16_t g_monoX = -1, g_monoY = -1;
+static unsigned long g_monoNext = 0;
+
+static void monoText(const SaverCtx& c) {
+  drawString(kMonoTextX, kMonoTextY, "LOCKED", c.fg, c.bg, 3, false);
+}
+
+static bool monoHitsText(int16_t x, int16_t y) {
+  uint16_t w = 0, h = 0;
+  measureTextSingleLine("LOCKED", 3, w, h);
+  return saverOverlaps(x, y, kMonoBox, kMonoBox, kMonoTextX, kMonoTextY, w, h);
+}
+
+static void saverMonoBegin(const SaverCtx& c, unsigned long now) {
+  monoText(c);
+  g_monoX = g_monoY = -1;
+  g_monoNext = now;
+}
+
+static uint32_t saverMonoStep(const SaverCtx& c, unsigned long now) {
+  if (!saverDue(now, g_monoNext, 40)) return saverUntil(now, g_monoNext);
+  const int16_t x = (int16_t)((now / 8UL) % (LCD_Width() - kMonoBox));
+  const int16_t y = (int16_t)((now / 12UL) % (LCD_Height() - kMonoBox));
+  if (x == g_monoX && y == g_monoY) return saverUntil(now, g_monoNext);
+
+  bool retext = monoHitsText(x, y);
+  if (g_monoX >= 0) {
+    LCD_FillRect(g_monoX, g_monoY, kMonoBox, 1, c.bg);
+    LCD_FillRect(g_monoX, g_monoY + kMonoBox - 1, kMonoBox, 1, c.bg);
+    LCD_FillRect(g_monoX, g_monoY, 1, kMonoBox, c.bg);
+    LCD_FillRect(g_monoX + kMonoBox - 1, g_monoY, 1, kMonoBox, c.bg);
+    retext = retext || monoHitsText(g_monoX, g_monoY);
+  }
+  if (retext) monoText(c);
+  LCD_DrawRect(x, y, kMonoBox, kMonoBox, c.fg);
+  g_monoX = x;
+  g_monoY = y;
+  return saverUntil(now, g_monoNext);
+}
+
+// ---- ICE: bars that grow and shrink; each step fills or clears only the difference. ----
+static const uint8_t SAVER_ICE_MAX_BARS = 16;
+static const uint16_t kIceTextX = 24, kIceTextY = 140;
+static uint16_t g_iceWidth[SAVER_ICE_MAX_BARS];
+static unsigned long g_iceNext = 0;
+
+static uint16_t iceBarWidth(unsigned long now, uint16_t y) {
+  return (uint16_t)(30 + ((now / 4UL) + y * 7U) % 90);
+}
+
+static void saverIceBegin(const SaverCtx& c, unsigned long now) {
+  uint8_t i = 0;
+  for (uint16_t y = 20; y < LCD_Height() && i < SAVER_ICE_MAX_BARS; y += 26, ++i) {
+    g_iceWidth[i] = iceBarWidth(now, y);
+    LCD_FillRect(10, y, g_iceWidth[i], 4, c.accent);
+  }
+  drawString(kIceTextX, kIceTextY, "ICE LOCK", c.fg, c.bg, 3, false);
+  g_iceNext = now + 40;
+}
+
+static uint32_t saverIceStep(const SaverCtx& c, unsigned long now) {
+  if (!saverDue(now, g_iceNext, 40)) return saverUntil(now, g_iceNext);
+  uint16_t tw = 0, th = 0;
+  measureTextSingleLine("ICE LOCK", 3, tw, th);
+
+  bool retext = false;
+  uint8_t i = 0;
+  for (uint16_t y = 20; y < LCD_Height() && i < SAVER_ICE_MAX_BARS; y += 26, ++i) {
+    const uint16_t w = iceBarWidth(now, y);
+    const uint16_t old = g_iceWidth[i];
+    if (w == old) continue;
+    if (w > old) LCD_FillRect(10 + old, y, w - old, 4, c.accent);
+    else LCD_FillRect(10 + w, y, old - w, 4, c.bg);
+    g_iceWidth[i] = w;
+    if (saverOverlaps(10, y, max(w, old), 4, kIceTextX, kIceTextY, tw, th)) retext = true;
+  }
+  if (retext) drawString(kIceTextX, kIceTextY, "ICE LOCK", c.fg, c.bg, 3, false);
+  return saverUntil(now, g_iceNext);
+}
+
+// ---- AMBER: a hex dump that scrolls its values a few times a second. ----
+static unsigned long g_amberNext = 0;
+
+static void amberDrawLines(const SaverCtx& c, unsigned long now) {
+  const unsigned long t = now / 150UL;
+  for (uint16_t y = 120; y < 250; y += 18) {
+    char hexline[18];
+    snprintf(hexline, sizeof(hexline), "%04X %04X", (unsigned)((t + y) & 0xFFFF), (unsigned)((t * 3 + y * 9) & 0xFFFF));
+    saverText(c, 32, y, hexline, c.accent, 2);
+  }
+}
+
+static void saverAmberBegin(const SaverCtx& c, unsigned long now) {
+  drawString(24, 70, "AMBER CRT", c.fg, c.bg, 3, false);
+  amberDrawLines(c, now);
+  g_amberNext = now + 150;
+}
+
+static uint32_t saverAmberStep(const SaverCtx& c, unsigned long now) {
+  if (saverDue(now, g_amberNext, 150)) amberDrawLines(c, now);
+  return saverUntil(now, g_amberNext);
+}
+
+// ---- Fallback: pulsing rings around the palette name. ----
+static uint16_t g_orbitR = 0;
+static unsigned long g_orbitNext = 0;
+
+static void orbitDraw(const SaverCtx& c, uint16_t r) {
+  LCD_DrawCircle(LCD_Width() / 2, LCD_Height() / 2, r, c.fg);
+  LCD_DrawCircle(LCD_Width() / 2, LCD_Height() / 2, r + 12, c.accent);
+  drawString(28, 142, c.name, c.selBg, c.bg, 2, false);
+  drawString(40, 172, "LOCKED", c.fg, c.bg, 2, false);
+}
+
+static void saverOrbitBegin(const SaverCtx& c, unsigned long now) {
+  g_orbitR = (uint16_t)(18 + (now / 16UL) % 24);
+  orbitDraw(c, g_orbitR);
+  g_orbitNext = now + 60;
+}
+
+static uint32_t saverOrbitStep(const SaverCtx& c, unsigned long now) {
+  if (!saverDue(now, g_orbitNext, 60)) return saverUntil(now, g_orbitNext);
+  const uint16_t r = (uint16_t)(18 + (now / 16UL) % 24);
+  if (r == g_orbitR) return saverUntil(now, g_orbitNext);
+
+  // Restore the square the larger ring lived in, then redraw what sits inside it.
+  const int16_t reach = (int16_t)(max(r, g_orbitR) + 13);
+  LCD_FillRect((uint16_t)max(0, LCD_Width() / 2 - reach), (uint16_t)max(0, LCD_Height() / 2 - reach),
+               (uint16_t)(2 * reach + 1), (uint16_t)(2 * reach + 1), c.bg);
+  orbitDraw(c, r);
+  g_orbitR = r;
+  return saverUntil(now, g_orbitNext);
+}
+
+static const SaverTheme kSaverThemes[] = {
+  { "MATRIX",   saverMatrixBegin, saverMatrixStep },
+  { "PIPBOY",   saverPipBegin,    saverPipStep },
+  { "TERMINAL", saverTermBegin,   saverTermStep },
+  { "MONO",     saverMonoBegin,   saverMonoStep },
+  { "ICE",      saverIceBegin,    saverIceStep },
+  { "AMBER",    saverAmberBegin,  saverAmberStep },
+  { nullptr,    saverOrbitBegin,  saverOrbitStep },
+};
+
+static const SaverTheme& saverThemeFor(const char* paletteName) {
+  const uint8_t n = sizeof(kSaverThemes) / sizeof(kSaverThemes[0]);
+  for (uint8_t i = 0; i + 1 < n; ++i) {
+    if (strcmp(paletteName, kSaverThemes[i].palette) == 0) return kSaverThemes[i];
+  }
+  return kSaverThemes[n - 1];
+}
+
+static bool passcodeScreensaverWakeRequested() {
+  g_rotary.update();
+  return g_rotary.wasTurnedCW() || g_rotary.wasTurnedCCW() ||
+         g_rotary.wasPressedA() || g_rotary.wasPressedB() ||
+         g_rotary.wasReleasedA();
+}
+
+static void runPasscodeScreensaver() {
+  SaverCtx ctx;
+  ctx.bg = UI_ColorBg();
+  ctx.fg = UI_ColorFg();
+  ctx.accent = UI_ColorAccent();
+  ctx.selBg = UI_ColorSelectedBg();
+  ctx.name = UI_PaletteName(UI_GetPalette());
+  const SaverTheme& theme = saverThemeFor(ctx.name);
+
+  unsigned long now = millis();
+  LCD_BeginFrame();
+  LCD_Clear(ctx.bg);
+  theme.begin(ctx, now);
+  LCD_EndFrame();
+
+  unsigned long next = now;
+  while (!passcodeScreensaverWakeRequested()) {
+    now = millis();
+    if ((long)(now - next) >= 0) {
+      LCD_BeginFrame();
+      const uint32_t wait = theme.step(ctx, now);
+      LCD_EndFrame();
+      next = now + max<uint32_t>(wait, 1);
+    }
+    delay(min<uint32_t>(saverUntil(millis(), next) + 1, PP_SAVER_POLL_MS));
+  }
+}
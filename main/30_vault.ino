@@ -34,6 +34,7 @@ static void addCategory() {
   Category c;
   c.name = name;
   c.db_id = newId;
+  c.items_loaded = true; // new and empty
   g_vault.categories.push_back(c);
 
   // Re-sort categories alphabetically
@@ -95,6 +96,26 @@ static void editCategory(size_t cidx) {
   categoryScreen(cidx);
 }
 
+static void editCategoryPolicy(size_t cidx) {
+  Serial.printf("[VAULT] editCategoryPolicy cidx=%u\n", (unsigned)cidx);
+  if (cidx >= g_vault.categories.size()) return;
+  Category& c = g_vault.categories[cidx];
+
+  int choice = promptPwPolicy(c.pw_policy);
+  if (choice >= 0 && (uint8_t)choice != c.pw_policy) {
+    if (db_update_category_policy(c.db_id, (uint8_t)choice)) {
+      c.pw_policy = (uint8_t)choice;
+    } else {
+      waitForButtonB("Error", "DB update category failed", "OK");
+    }
+  }
+
+  g_activeCategory = cidx;
+  g_activePassword = SIZE_MAX;
+  g_state = UiState::CategoryScreen;
+  categoryScreen(cidx);
+}
+
 static bool movePasswordToCategory(size_t srcCidx, size_t srcPidx, size_t dstCidx) {
   if (srcCidx >= g_vault.categories.size()) return false;
   if (dstCidx >= g_vault.categories.size()) return false;
@@ -103,6 +124,7 @@ static bool movePasswordToCategory(size_t srcCidx, size_t srcPidx, size_t dstCid
   Category& src = g_vault.categories[srcCidx];
   Category& dst = g_vault.categories[dstCidx];
   if (srcPidx >= src.items.size()) return false;
+  if (!ensureCategoryLoaded(dst)) return false;
 
   if (dst.items.size() >= MAX_PASSWORDS_PER_CATEGORY) {
     waitForButtonB("Limit Reached", "Destination full (60)", "OK");
@@ -165,7 +187,7 @@ static void addPasswordToCategory(size_t cidx) {
     return;
   }
 
-  String pw;
+  SecureString pw;
 
   while (true) {
     PwGenMode mode = promptPwGenMode("Password Mode");
@@ -179,12 +201,15 @@ static void addPasswordToCategory(size_t cidx) {
     }
 
     if (mode == PwGenMode::Auto) {
-      pw = generatePassword(g_settings);
+      if (!generatePassword(pwpolicy_for_category(cat), pw)) {
+        waitForButtonB("Error", "Generate failed", "OK");
+        continue;
+      }
       break;
     } else {
-      pw = runTextInput("Manual Password", "Enter password", 64,TextInputUI::InputMode::STANDARD, false);
+      runSecretInput("Manual Password", "Enter password", 64, pw);
       pw.trim();
-      if (!pw.length()) {
+      if (!pw.length() || !confirmPasswordStrength(pw)) {
         continue;
       }
       break;
@@ -198,16 +223,13 @@ static void addPasswordToCategory(size_t cidx) {
   if (!encrypt_label_password(label, pw, it.id, it.label_ct_b64, it.label_nonce_b64, it.pw_ct_b64, it.pw_nonce_b64)) {
     Serial.println("[VAULT] encrypt_label_password failed");
     waitForButtonB("Error", "Encrypt failed", "OK");
-    for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-    pw = "";
     return;
   }
   it.label_plain = label;
+  password_fingerprint(pw, it.pw_fp);
 
   if (!db_insert_item(cat.db_id, it)) {
     waitForButtonB("Error", "DB insert item failed", "OK");
-    for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-    pw = "";
     return;
   }
 
@@ -225,8 +247,7 @@ static void addPasswordToCategory(size_t cidx) {
   refreshDecryptedItemNames();
   
   // Wipe the plaintext password from RAM
-  for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-  pw = "";
+  pw.clear();
 
   g_activeCategory = cidx;
   g_activePassword = newIdx;  // focus the new item in its sorted position
@@ -302,14 +323,15 @@ static bool derive_W_recovery_only(const String& pin_plus_rk,
                     const uint8_t salt1[16],
                     const uint8_t salt2[16],
                     uint32_t iters,
-                    std::vector<uint8_t>& out32) {
+                    std::vector<uint8_t>& out32,
+                    const volatile bool* cancel) {
   Serial.printf("[KDF] derive_W_recovery_only: len=%u, iters=%u\n",
                 (unsigned)pin_plus_rk.length(), (unsigned)iters);
 
   uint8_t tmp32[32];
   if (!pbkdf2_hmac_sha256(
         (const uint8_t*)pin_plus_rk.c_str(), pin_plus_rk.length(),
-        salt1, 16, iters, tmp32, 32)) {
+        salt1, 16, iters, tmp32, 32, cancel)) {
     Serial.println("[KDF] PBKDF2 (recovery-only) failed");
     return false;
   }
@@ -323,32 +345,3 @@ static bool derive_W_recovery_only(const String& pin_plus_rk,
   memset(tmp32, 0, 32);
   return true;
 }
-
-// ==== Password Generation ====
-static String generatePassword(const PwSettings& s) {
-  Serial.println("[GEN] generatePassword");
-  const char* U = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-  const char* L = "abcdefghijklmnopqrstuvwxyz";
-  const char* N = "0123456789";
-  const char* S = "!@#_.-";
-  auto rnd32 = []() -> uint32_t { return esp_random(); };
-
-  String out;
-  auto addFrom = [&](const char* set, uint8_t count) {
-    size_t len = strlen(set);
-    for (uint8_t i = 0; i < count; ++i) out += set[rnd32() % len];
-  };
-  addFrom(U, s.uppercase);
-  addFrom(L, s.lowercase);
-  addFrom(S, s.symbol);
-  addFrom(N, s.number);
-
-  // Shuffle
-  for (int i = out.length() - 1; i > 0; --i) {
-    int j = rnd32() % (i + 1);
-    char c = out[i];
-    out[i] = out[j];
-    out[j] = c;
-  }
-  return out;
-}
@@ -0,0 +1,337 @@
+//33_strength.ino
+// ==== Password strength estimate ====
+// A cut-down zxcvbn: find every dictionary word, keyboard walk, sequence,
+// repeat and year inside the password, then pick the cheapest way to cover it
+// (dynamic programming over log10 guesses). Characters no pattern explains
+// are charged as brute force over their character class.
+//
+// Everything runs on the stack; the dictionaries are read in place from flash.
+
+static constexpr uint8_t STRENGTH_MAX_LEN   = 64;   // longer input: tail is charged as brute force
+static constexpr uint8_t STRENGTH_MAX_WORD  = 15;   // longest dictionary entry (generator limit)
+static constexpr uint16_t STRENGTH_REF_YEAR = 2026;
+
+// ---- Flash dictionaries (32_strength_dict.ino) ----
+struct StrengthDict {
+  const uint8_t*  data;
+  const uint32_t* blocks;
+  uint16_t        count;   // entries; the last block may be short
+  const char*     hint;
+};
+
+static const StrengthDict kStrengthDicts[] = {
+  { kDictPasswordsData, kDictPasswordsBlocks, DICT_PASSWORDS_COUNT, "Common password" },
+  { kDictWordsData,     kDictWordsBlocks,     DICT_WORDS_COUNT,     "Dictionary word" },
+};
+static_assert(sizeof(kDictPasswordsBlocks) / sizeof(kDictPasswordsBlocks[0]) == (DICT_PASSWORDS_COUNT + DICT_BLOCK - 1) / DICT_BLOCK,
+              "password dictionary blocks out of step with its count");
+static_assert(sizeof(kDictWordsBlocks) / sizeof(kDictWordsBlocks[0]) == (DICT_WORDS_COUNT + DICT_BLOCK - 1) / DICT_BLOCK,
+              "word dictionary blocks out of step with its count");
+
+static int sdict_cmp(const char* a, uint8_t alen, const char* b, uint8_t blen) {
+  uint8_t n = alen < blen ? alen : blen;
+  int c = memcmp(a, b, n);
+  if (c) return c;
+  return (int)alen - (int)blen;
+}
+
+// Compares key against the (whole) first entry of block b.
+static int sdict_cmp_head(const StrengthDict& d, uint16_t b, const char* key, uint8_t len) {
+  const uint8_t* p = d.data + pgm_read_dword(&d.blocks[b]);
+  uint8_t hlen = pgm_read_byte(p) & 0x0F;
+  char head[STRENGTH_MAX_WORD];
+  memcpy_P(head, p + 3, hlen);
+  return sdict_cmp(key, len, head, hlen);
+}
+
+// Frequency rank (1 = most common) of key in d, 0 if absent. Binary search over
+// the block heads, then decode one block of front-coded entries.
+static uint16_t sdict_rank(const StrengthDict& d, const char* key, uint8_t len) {
+  if (len > STRENGTH_MAX_WORD || !d.count) return 0;
+  int lo = 0, hi = (int)((d.count + DICT_BLOCK - 1) / DICT_BLOCK) - 1, blk = -1;
+  while (lo <= hi) {
+    int mid = (lo + hi) / 2;
+    if (sdict_cmp_head(d, (uint16_t)mid, key, len) >= 0) { blk = mid; lo = mid + 1; }
+    else hi = mid - 1;
+  }
+  if (blk < 0) return 0;
+
+  const uint8_t* p = d.data + pgm_read_dword(&d.blocks[blk]);
+  const uint32_t first = (uint32_t)blk * DICT_BLOCK;
+  const uint8_t n = (uint8_t)(d.count - first < DICT_BLOCK ? d.count - first : DICT_BLOCK);
+  char cur[STRENGTH_MAX_WORD];
+  uint8_t curLen = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    uint8_t hdr = pgm_read_byte(p);
+    uint8_t shared = hdr >> 4, slen = hdr & 0x0F;
+    uint16_t rank = (uint16_t)pgm_read_byte(p + 1) | ((uint16_t)pgm_read_byte(p + 2) << 8);
+    if (shared + slen > STRENGTH_MAX_WORD) break;
+    memcpy_P(cur + shared, p + 3, slen);
+    curLen = shared + slen;
+    p += 3 + slen;
+
+    int c = sdict_cmp(key, len, cur, curLen);
+    if (c == 0) return rank;
+    if (c < 0) break;   // sorted: key would have been here
+  }
+  return 0;
+}
+
+// ---- Pattern helpers ----
+static float strength_log10_nck(uint8_t n, uint8_t k) {
+  if (k > n) return -1e9f;
+  float r = 0;
+  for (uint8_t i = 1; i <= k; ++i) r += log10f((float)(n - k + i) / (float)i);
+  return r;
+}
+
+// zxcvbn: all-lower / all-upper / first-only cost little; mixed case is the
+// number of ways to pick that many upper letters.
+static float strength_case_log10(const char* raw, uint8_t len) {
+  uint8_t up = 0, low = 0;
+  for (uint8_t i = 0; i < len; ++i) {
+    if (isupper((unsigned char)raw[i])) up++;
+    else if (islower((unsigned char)raw[i])) low++;
+  }
+  if (!up) return 0;
+  if (!low) return log10f(2);
+  if (up == 1 && (isupper((unsigned char)raw[0]) || isupper((unsigned char)raw[len - 1]))) return log10f(2);
+  float s = 0;
+  uint8_t lim = up < low ? up : low;
+  for (uint8_t i = 1; i <= lim; ++i) s += powf(10.0f, strength_log10_nck(up + low, i));
+  return log10f(s);
+}
+
+static char strength_unleet(char c) {
+  switch (c) {
+    case '4': case '@': return 'a';
+    case '8':           return 'b';
+    case '(':           return 'c';
+    case '3':           return 'e';
+    case '6': case '9': return 'g';
+    case '1': case '!': case '|': return 'i';
+    case '0':           return 'o';
+    case '5': case '$': return 's';
+    case '7': case '+': return 't';
+    case '2':           return 'z';
+    default:            return c;
+  }
+}
+
+static uint8_t strength_class_size(char c) {
+  if (isdigit((unsigned char)c)) return 10;
+  if (islower((unsigned char)c)) return 26;
+  if (isupper((unsigned char)c)) return 26;
+  return 33;
+}
+
+// Key position on a US QWERTY board in half-key units; false for keys off the map.
+static bool strength_key_pos(char c, int8_t& row, int8_t& x) {
+  static const char* const rows[] = { "1234567890-=", "qwertyuiop[]", "asdfghjkl;'", "zxcvbnm,./" };
+  static const int8_t offs[] = { 0, 1, 2, 3 };   // stagger, half keys
+  for (int8_t r = 0; r < 4; ++r) {
+    const char* hit = strchr(rows[r], c);
+    if (hit && c) { row = r; x = (int8_t)((hit - rows[r]) * 2 + offs[r]); return true; }
+  }
+  return false;
+}
+
+static bool strength_keys_adjacent(char a, char b) {
+  int8_t ra, xa, rb, xb;
+  if (!strength_key_pos(a, ra, xa) || !strength_key_pos(b, rb, xb)) return false;
+  int dr = rb - ra, dx = xb - xa;
+  if (dr == 0) return dx == 2 || dx == -2;
+  return (dr == 1 || dr == -1) && dx >= -2 && dx <= 2;
+}
+
+// zxcvbn spatial estimate: starting keys * average degree^turns over all shorter walks.
+static float strength_spatial_log10(uint8_t len, uint8_t turns) {
+  const float S = 47.0f, D = 4.6f;
+  float g = 0;
+  for (uint8_t i = 2; i <= len; ++i) {
+    uint8_t lim = turns < i - 1 ? turns : i - 1;
+    for (uint8_t j = 1; j <= lim; ++j) g += powf(10.0f, strength_log10_nck(i - 1, j - 1)) * S * powf(D, j);
+  }
+  return log10f(g);
+}
+
+static uint8_t strength_score(float lg) {
+  if (lg < 3)  return 0;
+  if (lg < 6)  return 1;
+  if (lg < 8)  return 2;
+  if (lg < 10) return 3;
+  return 4;
+}
+
+// ---- Estimator ----
+static StrengthResult estimate_strength(const char* pw, size_t n) {
+  StrengthResult r;
+  uint8_t len = (uint8_t)(n < STRENGTH_MAX_LEN ? n : STRENGTH_MAX_LEN);
+
+  char low[STRENGTH_MAX_LEN], leet[STRENGTH_MAX_LEN];
+  for (uint8_t i = 0; i < len; ++i) {
+    low[i]  = (char)tolower((unsigned char)pw[i]);
+    leet[i] = strength_unleet(low[i]);
+  }
+
+  float best[STRENGTH_MAX_LEN + 1];
+  const char* why[STRENGTH_MAX_LEN + 1];
+  best[0] = 0;
+  why[0] = "";
+  uint8_t rep = 0, seq = 0, walk = 0;   // run lengths ending at j-1
+  int delta = 0;
+
+  for (uint8_t j = 1; j <= len; ++j) {
+    char c = low[j - 1];
+    best[j] = best[j - 1] + log10f((float)strength_class_size(pw[j - 1]));
+    why[j] = why[j - 1];
+
+    auto offer = [&](uint8_t i, float lg, const char* hint) {
+      // zxcvbn floor: no multi-character match is guessed in under 50 tries
+      if (lg < log10f(50)) lg = log10f(50);
+      if (best[i] + lg < best[j]) { best[j] = best[i] + lg; why[j] = hint; }
+    };
+
+    rep  = (j > 1 && low[j - 2] == c) ? rep + 1 : 1;
+    int d = (j > 1) ? (int)c - (int)low[j - 2] : 0;
+    if (j > 1 && d != 0 && d >= -5 && d <= 5 && isalnum((unsigned char)c) && isalnum((unsigned char)low[j - 2])) {
+      seq = (seq >= 2 && d == delta) ? seq + 1 : 2;
+    } else {
+      seq = 1;
+    }
+    delta = d;
+    walk = (j > 1 && strength_keys_adjacent(low[j - 2], c)) ? walk + 1 : 1;
+
+    for (uint8_t k = 3; k <= rep; ++k) {
+      offer(j - k, log10f((float)strength_class_size(pw[j - 1]) * k), "Repeated characters");
+    }
+    for (uint8_t k = 3; k <= seq; ++k) {
+      char s = low[j - k];
+      float base = (s == 'a' || s == 'z' || s == '0' || s == '1' || s == '9') ? 4 : isdigit((unsigned char)s) ? 10 : 26;
+      if (delta < 0) base *= 2;
+      offer(j - k, log10f(base * k), "Sequence");
+    }
+    for (uint8_t k = 3; k <= walk; ++k) {
+      uint8_t turns = 0;
+      int prevDir = 0x7fff;
+      for (uint8_t t = j - k + 1; t < j; ++t) {
+        int8_t ra, xa, rb, xb;
+        strength_key_pos(low[t - 1], ra, xa);
+        strength_key_pos(low[t], rb, xb);
+        int dir = (rb - ra) * 16 + (xb - xa);
+        if (dir != prevDir) { turns++; prevDir = dir; }
+      }
+      offer(j - k, strength_spatial_log10(k, turns), "Keyboard pattern");
+    }
+    if (j >= 4 && isdigit((unsigned char)low[j - 4]) && isdigit((unsigned char)low[j - 3]) &&
+        isdigit((unsigned char)low[j - 2]) && isdigit((unsigned char)c)) {
+      int year = (low[j - 4] - '0') * 1000 + (low[j - 3] - '0') * 100 + (low[j - 2] - '0') * 10 + (c - '0');
+      if (year >= 1900 && year <= STRENGTH_REF_YEAR + 20) {
+        int span = abs(year - (int)STRENGTH_REF_YEAR);
+        offer(j - 4, log10f((float)(span < 20 ? 20 : span)), "Year");
+      }
+    }
+
+    for (uint8_t k = 3; k <= STRENGTH_MAX_WORD && k <= j; ++k) {
+      uint8_t i = j - k;
+      float caseLg = strength_case_log10(pw + i, k);
+      char rev[STRENGTH_MAX_WORD];
+      for (uint8_t t = 0; t < k; ++t) rev[t] = low[j - 1 - t];
+      uint8_t subs = 0;
+      for (uint8_t t = i; t < j; ++t) if (leet[t] != low[t]) subs++;
+
+      for (const auto& dict : kStrengthDicts) {
+        uint16_t rank = sdict_rank(dict, low + i, k);
+        if (rank) offer(i, log10f(rank) + caseLg, dict.hint);
+        rank = sdict_rank(dict, rev, k);
+        if (rank) offer(i, log10f(rank) + caseLg + log10f(2), dict.hint);
+        if (subs) {
+          rank = sdict_rank(dict, leet + i, k);
+          // each substitution at most doubles the search (sub or not)
+          if (rank) offer(i, log10f(rank) + caseLg + subs * log10f(2), dict.hint);
+        }
+      }
+      secure_zero(rev, sizeof(rev));
+    }
+  }
+
+  r.log10_guesses = best[len];
+  for (size_t i = len; i < n; ++i) r.log10_guesses += log10f((float)strength_class_size(pw[i]));
+  r.score = strength_score(r.log10_guesses);
+  r.hint  = why[len];
+  if (!*r.hint && r.score < PP_STRENGTH_WARN_BELOW) r.hint = "Too short";
+
+  secure_zero(low, sizeof(low));
+  secure_zero(leet, sizeof(leet));
+  return r;
+}
+
+static StrengthResult estimate_strength(const SecureString& pw) {
+  return estimate_strength(pw.c_str(), pw.length());
+}
+
+static const char* strength_label(uint8_t score) {
+  static const char* const kLabels[] = { "Very weak", "Weak", "Fair", "Strong", "Very strong" };
+  return kLabels[score > 4 ? 4 : score];
+}
+
+// Shown after a password is typed in by hand. true = keep it, false = re-enter.
+static bool confirmPasswordStrength(const SecureString& pw) {
+  StrengthResult s = estimate_strength(pw);
+  if (s.score >= PP_STRENGTH_WARN_BELOW) return true;
+
+  char sub[48];
+  snprintf(sub, sizeof(sub), "%s: %s", strength_label(s.score), s.hint);
+  static const char* items[] = { "[ USE ANYWAY ]", "[ RE-ENTER ]" };
+  return promptChoice("Weak password", sub, items, 2, 1) == 0;
+}
+
+// ==== Strength audit ====
+// Scores are computed here and thrown away: storing them would tell anyone
+// holding the database which entries are worth attacking.
+static void settingsStrengthAudit() {
+  if (!db_open() || !keyring_loaded()) return;
+
+  uint32_t total = 0;
+  for (auto& c : g_vault.categories) {
+    if (!ensureCategoryLoaded(c)) {
+      waitForButtonB("Error", "Load failed", "OK");
+      return;
+    }
+    total += (uint32_t)c.items.size();
+  }
+
+  String report;
+  uint32_t done = 0, weak = 0, unreadable = 0;
+  {
+    LoadingScope loading("AUDIT", "Scoring passwords...");
+    g_loading_last_pm = -1;
+    for (auto& c : g_vault.categories) {
+      for (auto& it : c.items) {
+        SecureString pw;
+        if (!decrypt_password(it, it.id, pw)) {
+          unreadable++;
+        } else {
+          StrengthResult s = estimate_strength(pw);
+          pw.clear();
+          if (s.score < PP_STRENGTH_WARN_BELOW) {
+            weak++;
+            report += "- " + c.name + " / " + (it.label_plain.length() ? it.label_plain : String("<unnamed>")) + "\n";
+            report += "  " + String(strength_label(s.score)) + ": " + s.hint + "\n";
+          }
+        }
+        drawLoadingProgress(++done, total);
+        touchActivity();
+      }
+    }
+  }
+
+  if (unreadable) Serial.printf("[STRENGTH] %u entries could not be decrypted\n", (unsigned)unreadable);
+  if (!weak) {
+    waitForButtonB("Strength Audit", total ? "No weak passwords" : "Vault is empty", "OK");
+    return;
+  }
+  char sub[32];
+  snprintf(sub, sizeof(sub), "%u of %u weak", (unsigned)weak, (unsigned)total);
+  menu.showInfoModal("Strength Audit", sub, report, "[ BACK ]", 21, false);
+}
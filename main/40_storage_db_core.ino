@@ -124,7 +124,15 @@ static bool db_init_schema() {
       "vault_wrap_normal_ct_b64 TEXT,"
       "vault_wrap_normal_nonce_b64 TEXT,"
       "vault_wrap_recovery_ct_b64 TEXT,"
-      "vault_wrap_recovery_nonce_b64 TEXT"
+      "vault_wrap_recovery_nonce_b64 TEXT,"
+      "rekey_phase INTEGER DEFAULT 0,"
+      "rekey_cursor TEXT DEFAULT '',"
+      "rekey_prev_ct_b64 TEXT DEFAULT '',"
+      "rekey_prev_nonce_b64 TEXT DEFAULT '',"
+      "cipher_suite INTEGER DEFAULT 1,"
+      "rekey_prev_suite INTEGER DEFAULT 1,"
+      "integ_gen INTEGER DEFAULT 0,"
+      "integ_root TEXT DEFAULT ''"
     ");",
     "CREATE TABLE IF NOT EXISTS config ("
       "uppercase INTEGER,"
@@ -135,7 +143,8 @@ static bool db_init_schema() {
     ");",
     "CREATE TABLE IF NOT EXISTS categories ("
       "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-      "name TEXT NOT NULL"
+      "name TEXT NOT NULL,"
+      "pw_policy INTEGER DEFAULT 0"
     ");",
     "CREATE TABLE IF NOT EXISTS items ("
       "id TEXT PRIMARY KEY,"
@@ -143,6 +152,7 @@ static bool db_init_schema() {
       "label_plain TEXT NOT NULL,"
       "pw_ct_b64 TEXT NOT NULL,"
       "pw_nonce_b64 TEXT NOT NULL,"
+      "pw_fp TEXT DEFAULT '',"
       "FOREIGN KEY(category_id) REFERENCES categories(id) ON DELETE CASCADE"
     ");",
     "CREATE TABLE IF NOT EXISTS pw_history ("
@@ -151,6 +161,7 @@ static bool db_init_schema() {
       "pw_ct_b64 TEXT NOT NULL,"
       "pw_nonce_b64 TEXT NOT NULL,"
       "ts INTEGER,"
+      "pw_fp TEXT DEFAULT '',"
       "FOREIGN KEY(item_id) REFERENCES items(id) ON DELETE CASCADE"
     ");",
     "PRAGMA foreign_keys=ON;",
@@ -166,11 +177,38 @@ static bool db_init_schema() {
       "label_ct_b64 TEXT NOT NULL,"
       "label_nonce_b64 TEXT NOT NULL,"
       "FOREIGN KEY(item_id) REFERENCES items(id) ON DELETE CASCADE"
+    ");",
+
+    "CREATE TABLE IF NOT EXISTS integrity ("
+      "bucket INTEGER PRIMARY KEY,"
+      "digest BLOB NOT NULL"
     ");"
   };
   for (auto s : sqls) {
     if (!db_exec(s)) return false;
   }
+
+  // Columns added after the first release
+  static const char* const addedCols[][3] = {
+    { "meta",       "rekey_phase",          "ALTER TABLE meta ADD COLUMN rekey_phase INTEGER DEFAULT 0;" },
+    { "meta",       "rekey_cursor",         "ALTER TABLE meta ADD COLUMN rekey_cursor TEXT DEFAULT '';" },
+    { "meta",       "rekey_prev_ct_b64",    "ALTER TABLE meta ADD COLUMN rekey_prev_ct_b64 TEXT DEFAULT '';" },
+    { "meta",       "rekey_prev_nonce_b64", "ALTER TABLE meta ADD COLUMN rekey_prev_nonce_b64 TEXT DEFAULT '';" },
+    { "meta",       "cipher_suite",         "ALTER TABLE meta ADD COLUMN cipher_suite INTEGER DEFAULT 1;" },
+    { "meta",       "rekey_prev_suite",     "ALTER TABLE meta ADD COLUMN rekey_prev_suite INTEGER DEFAULT 1;" },
+    { "meta",       "integ_gen",            "ALTER TABLE meta ADD COLUMN integ_gen INTEGER DEFAULT 0;" },
+    { "meta",       "integ_root",           "ALTER TABLE meta ADD COLUMN integ_root TEXT DEFAULT '';" },
+    { "categories", "pw_policy",            "ALTER TABLE categories ADD COLUMN pw_policy INTEGER DEFAULT 0;" },
+    { "items",      "pw_fp",                "ALTER TABLE items ADD COLUMN pw_fp TEXT DEFAULT '';" },
+    { "pw_history", "pw_fp",                "ALTER TABLE pw_history ADD COLUMN pw_fp TEXT DEFAULT '';" },
+  };
+  for (auto& ac : addedCols) {
+    if (!db_column_exists(ac[0], ac[1]) && !db_exec(ac[2])) return false;
+  }
+
+  // Reuse index (83_db_reuse)
+  if (!db_exec("CREATE INDEX IF NOT EXISTS idx_items_pw_fp ON items(pw_fp);")) return false;
+  if (!db_exec("CREATE INDEX IF NOT EXISTS idx_pw_history_pw_fp ON pw_history(pw_fp);")) return false;
   return true;
 }
 
@@ -194,7 +232,11 @@ static bool loadMeta() {
   const char* sql = "SELECT version, db_uuid, kdf_name, kdf_iters, salt1, salt2, "
                     "verifier_normal_b64, verifier_recovery_b64, "
                     "vault_wrap_normal_ct_b64, vault_wrap_normal_nonce_b64, "
-                    "vault_wrap_recovery_ct_b64, vault_wrap_recovery_nonce_b64 "
+                    "vault_wrap_recovery_ct_b64, vault_wrap_recovery_nonce_b64, "
+                    "COALESCE(rekey_phase,0), COALESCE(rekey_cursor,''), "
+                    "COALESCE(rekey_prev_ct_b64,''), COALESCE(rekey_prev_nonce_b64,''), "
+                    "COALESCE(cipher_suite,1), COALESCE(rekey_prev_suite,1), "
+                    "COALESCE(integ_gen,0), COALESCE(integ_root,'') "
                     "FROM meta LIMIT 1;";
   sqlite3_stmt* st = nullptr;
   int rc = sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr);
@@ -203,6 +245,7 @@ static bool loadMeta() {
   if (sqlite3_step(st) == SQLITE_ROW) {
     g_meta.version = (uint32_t)sqlite3_column_int(st, 0);
     g_meta.db_uuid = (const char*)sqlite3_column_text(st, 1);
+    cache_db_uuid();
     g_meta.kdf_name = (const char*)sqlite3_column_text(st, 2);
     g_meta.kdf_iters = (uint32_t)sqlite3_column_int(st, 3);
 
@@ -219,6 +262,19 @@ static bool loadMeta() {
     g_meta.vault_wrap_normal_nonce_b64 = (const char*)sqlite3_column_text(st, 9);
     g_meta.vault_wrap_recovery_ct_b64  = (const char*)sqlite3_column_text(st, 10);
     g_meta.vault_wrap_recovery_nonce_b64 = (const char*)sqlite3_column_text(st, 11);
+    g_meta.rekey_phase = (uint8_t)sqlite3_column_int(st, 12);
+    g_meta.rekey_cursor = (const char*)sqlite3_column_text(st, 13);
+    g_meta.rekey_prev_ct_b64 = (const char*)sqlite3_column_text(st, 14);
+    g_meta.rekey_prev_nonce_b64 = (const char*)sqlite3_column_text(st, 15);
+    g_meta.cipher_suite = (uint8_t)sqlite3_column_int(st, 16);
+    g_meta.rekey_prev_suite = (uint8_t)sqlite3_column_int(st, 17);
+    g_meta.integ_gen = (uint32_t)sqlite3_column_int64(st, 18);
+    g_meta.integ_root = (const char*)sqlite3_column_text(st, 19);
+    if (!cipher_suite_valid(g_meta.cipher_suite) || !cipher_suite_valid(g_meta.rekey_prev_suite)) {
+      Serial.printf("[IO] loadMeta: unknown cipher suite %u/%u\n", g_meta.cipher_suite, g_meta.rekey_prev_suite);
+      sqlite3_finalize(st);
+      return false;
+    }
 
     sqlite3_finalize(st);
     Serial.println("[IO] loadMeta OK");
@@ -241,8 +297,10 @@ static bool saveMeta() {
   const char* sql = "INSERT INTO meta(version, db_uuid, kdf_name, kdf_iters, "
                     "salt1, salt2, verifier_normal_b64, verifier_recovery_b64, "
                     "vault_wrap_normal_ct_b64, vault_wrap_normal_nonce_b64, "
-                    "vault_wrap_recovery_ct_b64, vault_wrap_recovery_nonce_b64) "
-                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
+                    "vault_wrap_recovery_ct_b64, vault_wrap_recovery_nonce_b64, "
+                    "rekey_phase, rekey_cursor, rekey_prev_ct_b64, rekey_prev_nonce_b64, "
+                    "cipher_suite, rekey_prev_suite, integ_gen, integ_root) "
+                    "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?);";
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) { db_rollback(); return false; }
 
@@ -258,6 +316,14 @@ static bool saveMeta() {
   sqlite3_bind_text(st, 10, g_meta.vault_wrap_normal_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(st, 11, g_meta.vault_wrap_recovery_ct_b64.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(st, 12, g_meta.vault_wrap_recovery_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(st, 13, (int)g_meta.rekey_phase);
+  sqlite3_bind_text(st, 14, g_meta.rekey_cursor.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(st, 15, g_meta.rekey_prev_ct_b64.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(st, 16, g_meta.rekey_prev_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(st, 17, (int)g_meta.cipher_suite);
+  sqlite3_bind_int(st, 18, (int)g_meta.rekey_prev_suite);
+  sqlite3_bind_int64(st, 19, (sqlite3_int64)g_meta.integ_gen);
+  sqlite3_bind_text(st, 20, g_meta.integ_root.c_str(), -1, SQLITE_TRANSIENT);
 
   int rc = sqlite3_step(st);
   sqlite3_finalize(st);
@@ -268,8 +334,9 @@ static bool saveMeta() {
   return true;
 }
 
+// Category names only; each category's rows are read by ensureCategoryLoaded() on first open.
 static bool loadItems() {
-  Serial.println("[IO] loadItems (DB encrypted names/labels)");
+  Serial.println("[IO] loadItems (DB encrypted names)");
   LoadingScope loading("LOADING", "Reading categories...");
   g_vault.categories.clear();
 
@@ -279,7 +346,8 @@ static bool loadItems() {
   {
     const char* sql =
       "SELECT c.id, c.name, "
-      "COALESCE(cm.name_ct_b64,''), COALESCE(cm.name_nonce_b64,'') "
+      "COALESCE(cm.name_ct_b64,''), COALESCE(cm.name_nonce_b64,''), "
+      "COALESCE(c.pw_policy,0) "
       "FROM categories c "
       "LEFT JOIN category_meta cm ON cm.category_id = c.id;";
     sqlite3_stmt* st = nullptr;
@@ -288,6 +356,8 @@ static bool loadItems() {
     while (sqlite3_step(st) == SQLITE_ROW) {
       Category c;
       c.db_id = (int32_t)sqlite3_column_int(st, 0);
+      int pol = sqlite3_column_int(st, 4);
+      c.pw_policy = (pol >= 0 && pol < PW_POLICY_COUNT) ? (uint8_t)pol : 0;
 
       const char* plain_c = (const char*)sqlite3_column_text(st, 1);
       const char* ct_c    = (const char*)sqlite3_column_text(st, 2);
@@ -299,10 +369,10 @@ static bool loadItems() {
 
       String dec;
       bool decOk = false;
-      if (ct.length() && nonce.length() && g_crypto.K_meta.size() == 32) {
-        std::vector<uint8_t> aad;
-        make_category_field_aad(g_meta.db_uuid, c.db_id, "name", aad);
-        decOk = decrypt_string_meta_b64(aad, ct, nonce, dec);
+      if (ct.length() && nonce.length() && keyring_loaded()) {
+        AadBuf aad;
+        decOk = make_category_field_aad(c.db_id, "name", aad) &&
+                decrypt_string_meta_b64(aad, ct, nonce, dec);
       }
 
       c.name = decOk ? dec : plain;
@@ -324,10 +394,21 @@ static bool loadItems() {
       return strcasecmp(a.name.c_str(), b.name.c_str()) < 0;
     });
 
-  updateLoading("Loading items...");
+  g_vault.categories.reserve(MAX_CATEGORIES);
 
-  // ---- Load items per category (with encrypted labels from item_meta) ----
-  for (auto& c : g_vault.categories) {
+  Serial.printf("[IO] loadItems OK, categories=%u\n", (unsigned)g_vault.categories.size());
+  return true;
+}
+
+// Items, labels and history for one category. History comes from a single joined
+// query and is attached by item id instead of one SELECT per item.
+static bool loadCategoryItems(Category& c) {
+  Serial.printf("[IO] loadCategoryItems db_id=%d\n", (int)c.db_id);
+  if (!db_open()) return false;
+
+  std::vector<PasswordItem> items;
+  items.reserve(MAX_PASSWORDS_PER_CATEGORY);
+  {
     const char* sql =
       "SELECT i.id, i.label_plain, "
       "COALESCE(im.label_ct_b64,''), COALESCE(im.label_nonce_b64,''), "
@@ -359,10 +440,10 @@ static bool loadItems() {
       // Decrypt label from item_meta; fallback to plaintext if needed
       String decLabel;
       bool decOk = false;
-      if (ct.length() && nonce.length() && g_crypto.K_meta.size() == 32) {
-        std::vector<uint8_t> aad;
-        make_item_label_aad(g_meta.db_uuid, it.id, aad);
-        decOk = decrypt_string_meta_b64(aad, ct, nonce, decLabel);
+      if (ct.length() && nonce.length() && keyring_loaded()) {
+        AadBuf aad;
+        decOk = make_item_label_aad(it.id, aad) &&
+                decrypt_string_meta_b64(aad, ct, nonce, decLabel);
       }
       it.label_plain = decOk ? decLabel : plainLabel;
       if (!it.label_plain.length()) it.label_plain = "<unnamed>";
@@ -370,44 +451,59 @@ static bool loadItems() {
       it.pw_ct_b64 = pw_ct_c ? String(pw_ct_c) : String();
       it.pw_nonce_b64 = pw_nonce_c ? String(pw_nonce_c) : String();
 
-      // History (unchanged)
-      {
-        const char* sqlh =
-          "SELECT pw_ct_b64, pw_nonce_b64, ts FROM pw_history WHERE item_id=? ORDER BY id ASC;";
-        sqlite3_stmt* sth = nullptr;
-        if (sqlite3_prepare_v2(g_db, sqlh, -1, &sth, nullptr) != SQLITE_OK) { sqlite3_finalize(st); return false; }
-        sqlite3_bind_text(sth, 1, it.id.c_str(), -1, SQLITE_TRANSIENT);
-        while (sqlite3_step(sth) == SQLITE_ROW) {
-          PasswordVersion pv;
-          pv.pw_ct_b64 = (const char*)sqlite3_column_text(sth, 0);
-          pv.pw_nonce_b64 = (const char*)sqlite3_column_text(sth, 1);
-          pv.ts = (uint32_t)sqlite3_column_int(sth, 2);
-          it.pw_history.push_back(pv);
-        }
-        sqlite3_finalize(sth);
-      }
-
-      c.items.push_back(it);
+      items.push_back(it);
     }
     sqlite3_finalize(st);
+  }
 
-    // Sort items by decrypted label (case-insensitive)
-    std::sort(c.items.begin(), c.items.end(),
-      [](const PasswordItem& a, const PasswordItem& b) {
-        return strcasecmp(a.label_plain.c_str(), b.label_plain.c_str()) < 0;
-      });
+  // Sort items by decrypted label (case-insensitive)
+  std::sort(items.begin(), items.end(),
+    [](const PasswordItem& a, const PasswordItem& b) {
+      return strcasecmp(a.label_plain.c_str(), b.label_plain.c_str()) < 0;
+    });
+
+  // History for every item in the category, oldest first
+  if (!items.empty()) {
+    const char* sqlh =
+      "SELECT h.item_id, h.pw_ct_b64, h.pw_nonce_b64, h.ts "
+      "FROM pw_history h JOIN items i ON i.id = h.item_id "
+      "WHERE i.category_id=? ORDER BY h.id ASC;";
+    sqlite3_stmt* sth = nullptr;
+    if (sqlite3_prepare_v2(g_db, sqlh, -1, &sth, nullptr) != SQLITE_OK) return false;
+    sqlite3_bind_int(sth, 1, c.db_id);
+    while (sqlite3_step(sth) == SQLITE_ROW) {
+      const char* item_c = (const char*)sqlite3_column_text(sth, 0);
+      if (!item_c) continue;
+      for (auto& it : items) {
+        if (strcmp(it.id.c_str(), item_c) != 0) continue;
+        PasswordVersion pv;
+        pv.pw_ct_b64 = (const char*)sqlite3_column_text(sth, 1);
+        pv.pw_nonce_b64 = (const char*)sqlite3_column_text(sth, 2);
+        pv.ts = (uint32_t)sqlite3_column_int(sth, 3);
+        it.pw_history.push_back(pv);
+        break;
+      }
+    }
+    sqlite3_finalize(sth);
   }
 
-  updateLoading("Preparing UI...");
-  refreshDecryptedItemNames();
+  c.items.swap(items);
+  c.item_names_decrypted.clear();
+  c.item_names_decrypted.reserve(MAX_PASSWORDS_PER_CATEGORY);
+  for (auto& it : c.items) c.item_names_decrypted.push_back(it.label_plain);
+  c.items_loaded = true;
+  return true;
+}
 
-  g_vault.categories.reserve(MAX_CATEGORIES);
+static bool ensureCategoryLoaded(Category& c) {
+  return c.items_loaded || loadCategoryItems(c);
+}
+
+// Whole-vault walks (export) still need every category resident.
+static bool ensureAllCategoriesLoaded() {
   for (auto& c : g_vault.categories) {
-    c.items.reserve(MAX_PASSWORDS_PER_CATEGORY);
-    c.item_names_decrypted.reserve(MAX_PASSWORDS_PER_CATEGORY);
+    if (!ensureCategoryLoaded(c)) return false;
   }
-
-  Serial.printf("[IO] loadItems OK, categories=%u\n", (unsigned)g_vault.categories.size());
   return true;
 }
 
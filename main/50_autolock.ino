@@ -17,32 +17,14 @@ static inline bool autolockEligible() {
           g_state == UiState::Settings_Password);
 }
 
-static void lockAndReboot_dueToInactivity() {
-  Serial.println("[AUTOLOCK] 5min inactivity -> locking + reboot");
+static void lockAndReboot(const char* reason) {
+  Serial.printf("[AUTOLOCK] %s -> locking + reboot\n", reason);
 
   // Stop DB access first
   db_close();
 
-  // Wipe sensitive keys
-  if (!g_crypto.vault_key.empty()) {
-    secure_zero(g_crypto.vault_key.data(), g_crypto.vault_key.size());
-    g_crypto.vault_key.clear();
-  }
-  if (!g_crypto.K_fields.empty()) {
-    secure_zero(g_crypto.K_fields.data(), g_crypto.K_fields.size());
-    g_crypto.K_fields.clear();
-  }
-  if (!g_crypto.K_db.empty()) {
-    secure_zero(g_crypto.K_db.data(), g_crypto.K_db.size());
-    g_crypto.K_db.clear();
-  }
-  if (!g_crypto.K_meta.empty()) {
-    secure_zero(g_crypto.K_meta.data(), g_crypto.K_meta.size());
-    g_crypto.K_meta.clear();
-  }
-
-  // Reset runtime state
-  g_crypto.unlocked = false;
+  // Wipe sensitive keys + reset runtime state
+  crypto_lock();
   g_activePassword = SIZE_MAX;
   g_state = UiState::Locked;
 
@@ -87,7 +69,7 @@ static void serviceAutoLogout() {
   v = digitalRead(BTN_DOWN); if (v != lastDown)   { lastDown = v;   touchActivity(); }
 
   if (autolockEligible() && (uint32_t)(millis() - g_lastActivityMs) >= AUTO_LOGOUT_MS) {
-    lockAndReboot_dueToInactivity();
+    lockAndReboot("5min inactivity");
   }
 }
 
@@ -31,13 +31,229 @@ static bool consttime_eq(const uint8_t* a, const uint8_t* b, size_t len) {
   return r == 0;
 }
 
+// ==== PBKDF2-HMAC-SHA256 ====
+// HMAC ipad/opad blocks are hashed once; each iteration is then exactly two
+// SHA-256 compressions (inner + outer) over a 32-byte message.
+static const uint32_t kSha256K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t kSha256IV[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static inline uint32_t sha256_rotr(uint32_t x, uint32_t n) { return (x >> n) | (x << (32 - n)); }
+
+static void sha256_compress(uint32_t h[8], const uint8_t block[64]) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; ++i) {
+    w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4+1] << 16) |
+           ((uint32_t)block[i*4+2] << 8) | (uint32_t)block[i*4+3];
+  }
+  for (int i = 16; i < 64; ++i) {
+    uint32_t s0 = sha256_rotr(w[i-15], 7) ^ sha256_rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+    uint32_t s1 = sha256_rotr(w[i-2], 17) ^ sha256_rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+    w[i] = w[i-16] + s0 + w[i-7] + s1;
+  }
+  uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+  for (int i = 0; i < 64; ++i) {
+    uint32_t S1 = sha256_rotr(e, 6) ^ sha256_rotr(e, 11) ^ sha256_rotr(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = hh + S1 + ch + kSha256K[i] + w[i];
+    uint32_t S0 = sha256_rotr(a, 2) ^ sha256_rotr(a, 13) ^ sha256_rotr(a, 22);
+    uint32_t mj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = S0 + mj;
+    hh = g; g = f; f = e; e = d + t1; d = c; c = b; b = a; a = t1 + t2;
+  }
+  h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+  secure_zero(w, sizeof(w));
+}
+
+struct Pbkdf2Pads {
+  bool hw = false;
+  uint32_t inner[8];                // software: state after ipad block
+  uint32_t outer[8];                // software: state after opad block
+  mbedtls_sha256_context hw_inner;  // hardware: same, held by mbedTLS
+  mbedtls_sha256_context hw_outer;
+};
+
+static void pbkdf2_pads_init(Pbkdf2Pads& p, const uint8_t* pw, size_t pw_len, bool hw) {
+  uint8_t key[64] = {0};
+  if (pw_len > 64) {
+    mbedtls_sha256_context c; mbedtls_sha256_init(&c);
+    mbedtls_sha256_starts_ret(&c, 0);
+    mbedtls_sha256_update_ret(&c, pw, pw_len);
+    mbedtls_sha256_finish_ret(&c, key);
+    mbedtls_sha256_free(&c);
+  } else {
+    memcpy(key, pw, pw_len);
+  }
+
+  uint8_t ipad[64], opad[64];
+  for (int i = 0; i < 64; ++i) { ipad[i] = key[i] ^ 0x36; opad[i] = key[i] ^ 0x5c; }
+
+  p.hw = hw;
+  if (hw) {
+    mbedtls_sha256_init(&p.hw_inner);
+    mbedtls_sha256_starts_ret(&p.hw_inner, 0);
+    mbedtls_sha256_update_ret(&p.hw_inner, ipad, 64);
+    mbedtls_sha256_init(&p.hw_outer);
+    mbedtls_sha256_starts_ret(&p.hw_outer, 0);
+    mbedtls_sha256_update_ret(&p.hw_outer, opad, 64);
+  } else {
+    memcpy(p.inner, kSha256IV, sizeof(p.inner));
+    memcpy(p.outer, kSha256IV, sizeof(p.outer));
+    sha256_compress(p.inner, ipad);
+    sha256_compress(p.outer, opad);
+  }
+  secure_zero(key, sizeof(key));
+  secure_zero(ipad, sizeof(ipad));
+  secure_zero(opad, sizeof(opad));
+}
+
+static void pbkdf2_pads_free(Pbkdf2Pads& p) {
+  if (p.hw) {
+    mbedtls_sha256_free(&p.hw_inner);
+    mbedtls_sha256_free(&p.hw_outer);
+  }
+  secure_zero(&p, sizeof(p));
+}
+
+// out = HMAC(key, in) for a 32-byte message, from the precomputed pad states.
+static void pbkdf2_hmac_block(const Pbkdf2Pads& p, const uint8_t in[32], uint8_t out[32]) {
+  if (p.hw) {
+    uint8_t mid[32];
+    mbedtls_sha256_context c; mbedtls_sha256_init(&c);
+    mbedtls_sha256_clone(&c, &p.hw_inner);
+    mbedtls_sha256_update_ret(&c, in, 32);
+    mbedtls_sha256_finish_ret(&c, mid);
+    mbedtls_sha256_clone(&c, &p.hw_outer);
+    mbedtls_sha256_update_ret(&c, mid, 32);
+    mbedtls_sha256_finish_ret(&c, out);
+    mbedtls_sha256_free(&c);
+    secure_zero(mid, sizeof(mid));
+    return;
+  }
+
+  // One padded block: 32-byte message, 0x80, zeros, bit length of (64 + 32) bytes.
+  uint8_t blk[64] = {0};
+  uint32_t st[8];
+  memcpy(blk, in, 32);
+  blk[32] = 0x80; blk[62] = 0x03; blk[63] = 0x00;
+  memcpy(st, p.inner, sizeof(st));
+  sha256_compress(st, blk);
+  for (int i = 0; i < 8; ++i) {
+    blk[i*4] = (uint8_t)(st[i] >> 24); blk[i*4+1] = (uint8_t)(st[i] >> 16);
+    blk[i*4+2] = (uint8_t)(st[i] >> 8); blk[i*4+3] = (uint8_t)st[i];
+  }
+  memcpy(st, p.outer, sizeof(st));
+  sha256_compress(st, blk);
+  for (int i = 0; i < 8; ++i) {
+    out[i*4] = (uint8_t)(st[i] >> 24); out[i*4+1] = (uint8_t)(st[i] >> 16);
+    out[i*4+2] = (uint8_t)(st[i] >> 8); out[i*4+3] = (uint8_t)st[i];
+  }
+  secure_zero(blk, sizeof(blk));
+  secure_zero(st, sizeof(st));
+}
+
+// Incremental PBKDF2: one output block, advanced in slices so callers can yield,
+// draw progress and cancel between them.
+struct Pbkdf2Job {
+  Pbkdf2Pads pads;
+  uint8_t U[32];
+  uint8_t T[32];
+  uint32_t iters = 0;
+  uint32_t done = 0;   // iterations folded into T so far
+};
+
+static bool pbkdf2_job_begin(Pbkdf2Job& j, const uint8_t* pw, size_t pw_len,
+                             const uint8_t* salt, size_t salt_len,
+                             uint32_t iters, uint32_t blockIdx, bool hw) {
+  if (iters == 0) return false;
+  pbkdf2_pads_init(j.pads, pw, pw_len, hw);
+  j.iters = iters;
+  j.done = 0;
+
+  // U1 = HMAC(pw, salt || INT(i)); arbitrary-length message, so go through mbedTLS once.
+  uint8_t be[4] = { (uint8_t)(blockIdx >> 24), (uint8_t)(blockIdx >> 16), (uint8_t)(blockIdx >> 8), (uint8_t)blockIdx };
+  mbedtls_md_context_t md; mbedtls_md_init(&md);
+  bool ok = mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1) == 0 &&
+            mbedtls_md_hmac_starts(&md, pw, pw_len) == 0 &&
+            mbedtls_md_hmac_update(&md, salt, salt_len) == 0 &&
+            mbedtls_md_hmac_update(&md, be, 4) == 0 &&
+            mbedtls_md_hmac_finish(&md, j.U) == 0;
+  mbedtls_md_free(&md);
+  if (!ok) { pbkdf2_pads_free(j.pads); return false; }
+
+  memcpy(j.T, j.U, 32);
+  j.done = 1;
+  return true;
+}
+
+// Runs up to maxIters more iterations; returns true once T is final.
+static bool pbkdf2_job_step(Pbkdf2Job& j, uint32_t maxIters) {
+  uint32_t end = (j.iters - j.done > maxIters) ? j.done + maxIters : j.iters;
+  for (; j.done < end; ++j.done) {
+    pbkdf2_hmac_block(j.pads, j.U, j.U);
+    for (int k = 0; k < 32; ++k) j.T[k] ^= j.U[k];
+  }
+  return j.done >= j.iters;
+}
+
+static void pbkdf2_job_end(Pbkdf2Job& j) {
+  pbkdf2_pads_free(j.pads);
+  secure_zero(j.U, sizeof(j.U));
+  secure_zero(j.T, sizeof(j.T));
+  j.done = 0;
+}
+
+static bool kdf_was_canceled() { return g_kdf_canceled; }
+
 static bool pbkdf2_hmac_sha256(const uint8_t* pw, size_t pw_len,
     const uint8_t* salt, size_t salt_len,
-    uint32_t iters, uint8_t* out, size_t out_len) {
-  int rc = mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA256,
-    pw, pw_len, salt, salt_len, (unsigned int)iters,
-    (uint32_t)out_len, out);
-  return rc == 0;
+    uint32_t iters, uint8_t* out, size_t out_len, const volatile bool* cancel) {
+  if (iters == 0 || out_len == 0) return false;
+
+  KdfProgressFn report = (g_kdf_progress && g_kdf_progress_task == xTaskGetCurrentTaskHandle())
+                           ? g_kdf_progress : nullptr;
+  const uint32_t blocks = (uint32_t)((out_len + 31) / 32);
+  const uint64_t total = (uint64_t)iters * blocks;
+
+  Pbkdf2Job job;
+  size_t outpos = 0;
+  for (uint32_t blk = 1; blk <= blocks; ++blk) {
+    if (!pbkdf2_job_begin(job, pw, pw_len, salt, salt_len, iters, blk, PP_PBKDF2_HW_SHA != 0)) return false;
+    for (;;) {
+      bool fin = pbkdf2_job_step(job, PBKDF2_SLICE_ITERS);
+      if (report) {
+        uint64_t done = (uint64_t)iters * (blk - 1) + job.done;
+        if (!report((uint32_t)(done * 1000 / total), 1000)) {
+          Serial.println("[KDF] PBKDF2 canceled");
+          g_kdf_canceled = true;
+          pbkdf2_job_end(job);
+          return false;
+        }
+      }
+      if (fin) break;
+      if (cancel && *cancel) {
+        pbkdf2_job_end(job);
+        return false;
+      }
+      vTaskDelay(1); // let IDLE run (task watchdog) and the UI breathe
+    }
+    size_t n = min((size_t)32, out_len - outpos);
+    memcpy(out + outpos, job.T, n);
+    outpos += n;
+    pbkdf2_job_end(job);
+  }
+  return true;
 }
 
 static bool hmac_sha256(const uint8_t* key, size_t key_len, const uint8_t* msg, size_t msg_len, uint8_t out[32]) {
@@ -76,27 +292,125 @@ static bool hkdf_sha256_extract_expand(const uint8_t* ikm, size_t ikm_len, const
   return true;
 }
 
+static bool aes256_gcm_encrypt_ctx(mbedtls_gcm_context* ctx, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* plaintext, size_t pt_len, std::vector<uint8_t>& out_ct_with_tag) {
+  if (!ctx) return false;
+  out_ct_with_tag.resize(pt_len + 16);
+  int rc = mbedtls_gcm_crypt_and_tag(ctx, MBEDTLS_GCM_ENCRYPT, pt_len, nonce12, 12, aad, aad_len, plaintext, out_ct_with_tag.data(), 16, out_ct_with_tag.data() + pt_len);
+  return rc == 0;
+}
+
+// out must hold ct_len - 16 bytes.
+static bool aes256_gcm_decrypt_ctx_raw(mbedtls_gcm_context* ctx, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, uint8_t* out) {
+  if (!ctx || ct_len < 16) return false;
+  size_t pt_len = ct_len - 16;
+  const uint8_t* tag = ct_with_tag + pt_len;
+  int rc = mbedtls_gcm_auth_decrypt(ctx, pt_len, nonce12, 12, aad, aad_len, tag, 16, ct_with_tag, out);
+  return rc == 0;
+}
+
+static bool aes256_gcm_decrypt_ctx(mbedtls_gcm_context* ctx, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, std::vector<uint8_t>& out_plain) {
+  if (!ctx || ct_len < 16) return false;
+  out_plain.resize(ct_len - 16);
+  return aes256_gcm_decrypt_ctx_raw(ctx, nonce12, aad, aad_len, ct_with_tag, ct_len, out_plain.data());
+}
+
 static bool aes256_gcm_encrypt(const uint8_t* key, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* plaintext, size_t pt_len, std::vector<uint8_t>& out_ct_with_tag) {
   mbedtls_gcm_context ctx; mbedtls_gcm_init(&ctx);
   if (mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, key, 256) != 0) { mbedtls_gcm_free(&ctx); return false; }
-  out_ct_with_tag.resize(pt_len + 16);
-  int rc = mbedtls_gcm_crypt_and_tag(&ctx, MBEDTLS_GCM_ENCRYPT, pt_len, nonce12, 12, aad, aad_len, plaintext, out_ct_with_tag.data(), 16, out_ct_with_tag.data() + pt_len);
+  bool ok = aes256_gcm_encrypt_ctx(&ctx, nonce12, aad, aad_len, plaintext, pt_len, out_ct_with_tag);
   mbedtls_gcm_free(&ctx);
-  return rc == 0;
+  return ok;
 }
 
 static bool aes256_gcm_decrypt(const uint8_t* key, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, std::vector<uint8_t>& out_plain) {
-  if (ct_len < 16) return false;
-  size_t pt_len = ct_len - 16;
-  const uint8_t* tag = ct_with_tag + pt_len;
   mbedtls_gcm_context ctx; mbedtls_gcm_init(&ctx);
   if (mbedtls_gcm_setkey(&ctx, MBEDTLS_CIPHER_ID_AES, key, 256) != 0) { mbedtls_gcm_free(&ctx); return false; }
-  out_plain.resize(pt_len);
-  int rc = mbedtls_gcm_auth_decrypt(&ctx, pt_len, nonce12, 12, aad, aad_len, tag, 16, ct_with_tag, out_plain.data());
+  bool ok = aes256_gcm_decrypt_ctx(&ctx, nonce12, aad, aad_len, ct_with_tag, ct_len, out_plain);
   mbedtls_gcm_free(&ctx);
+  return ok;
+}
+
+// ==== AEAD ====
+// Vault-subkey ciphertext goes through these so the suite is a per-vault choice.
+static const char* cipher_suite_name(uint8_t suite) {
+  switch ((CipherSuite)suite) {
+    case CipherSuite::AesGcm:     return "AES-256-GCM";
+    case CipherSuite::ChaChaPoly: return "ChaCha20-Poly1305";
+  }
+  return "?";
+}
+
+static bool aead_setkey(AeadCtx& a, CipherSuite suite, const uint8_t key[32]) {
+  a.suite = suite;
+  if (suite == CipherSuite::ChaChaPoly) {
+    mbedtls_chachapoly_init(&a.chacha);
+    if (mbedtls_chachapoly_setkey(&a.chacha, key) == 0) return true;
+    mbedtls_chachapoly_free(&a.chacha);
+    return false;
+  }
+  mbedtls_gcm_init(&a.gcm);
+  if (mbedtls_gcm_setkey(&a.gcm, MBEDTLS_CIPHER_ID_AES, key, 256) == 0) return true;
+  mbedtls_gcm_free(&a.gcm);
+  return false;
+}
+
+static void aead_free(AeadCtx& a) {
+  if (a.suite == CipherSuite::ChaChaPoly) mbedtls_chachapoly_free(&a.chacha);
+  else mbedtls_gcm_free(&a.gcm);
+}
+
+static bool aead_encrypt(AeadCtx* a, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* plaintext, size_t pt_len, std::vector<uint8_t>& out_ct_with_tag) {
+  if (!a) return false;
+  if (a->suite != CipherSuite::ChaChaPoly) return aes256_gcm_encrypt_ctx(&a->gcm, nonce12, aad, aad_len, plaintext, pt_len, out_ct_with_tag);
+  out_ct_with_tag.resize(pt_len + 16);
+  int rc = mbedtls_chachapoly_encrypt_and_tag(&a->chacha, pt_len, nonce12, aad, aad_len, plaintext,
+                                              out_ct_with_tag.data(), out_ct_with_tag.data() + pt_len);
+  return rc == 0;
+}
+
+// out must hold ct_len - 16 bytes.
+static bool aead_decrypt_raw(AeadCtx* a, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, uint8_t* out) {
+  if (!a || ct_len < 16) return false;
+  if (a->suite != CipherSuite::ChaChaPoly) return aes256_gcm_decrypt_ctx_raw(&a->gcm, nonce12, aad, aad_len, ct_with_tag, ct_len, out);
+  size_t pt_len = ct_len - 16;
+  int rc = mbedtls_chachapoly_auth_decrypt(&a->chacha, pt_len, nonce12, aad, aad_len, ct_with_tag + pt_len, ct_with_tag, out);
   return rc == 0;
 }
 
+static bool aead_decrypt(AeadCtx* a, const uint8_t* nonce12, const uint8_t* aad, size_t aad_len, const uint8_t* ct_with_tag, size_t ct_len, std::vector<uint8_t>& out_plain) {
+  if (!a || ct_len < 16) return false;
+  out_plain.resize(ct_len - 16);
+  return aead_decrypt_raw(a, nonce12, aad, aad_len, ct_with_tag, ct_len, out_plain.data());
+}
+
+// Encrypt throughput in KiB/s over a fixed 16 KiB workload (64 x 256 B, the
+// size class of vault fields). Only Arduino timing and mbedTLS, so the same
+// function can run in a host build.
+static uint32_t aead_benchmark_kbps(CipherSuite suite) {
+  static constexpr size_t   kChunk  = 256;
+  static constexpr uint32_t kRounds = 64;
+  uint8_t key[32], nonce[12];
+  random_bytes(key, sizeof(key));
+  random_bytes(nonce, sizeof(nonce));
+  std::vector<uint8_t> pt(kChunk, 0xA5), ct;
+  ct.reserve(kChunk + 16);
+
+  AeadCtx a;
+  if (!aead_setkey(a, suite, key)) { secure_zero(key, sizeof(key)); return 0; }
+  uint32_t t0 = micros();
+  bool ok = true;
+  for (uint32_t i = 0; i < kRounds && ok; ++i) {
+    nonce[0] = (uint8_t)i;
+    ok = aead_encrypt(&a, nonce, nonce, sizeof(nonce), pt.data(), pt.size(), ct);
+  }
+  uint32_t us = micros() - t0;
+  aead_free(a);
+  secure_zero(key, sizeof(key));
+  if (!ok) return 0;
+  if (us == 0) us = 1;
+  return (uint32_t)(((uint64_t)kChunk * kRounds * 1000000ULL) / ((uint64_t)us * 1024ULL));
+}
+
 // ==== KDF / Wrapping ====
 static bool derive_W(const String& pin_concat, const uint8_t salt1[16], const uint8_t salt2[16], uint32_t iters, std::vector<uint8_t>& out32) {
   Serial.printf("[KDF] derive_W: pin_concat_len=%u, iters=%u\n", (unsigned)pin_concat.length(), (unsigned)iters);
@@ -122,6 +436,60 @@ static bool derive_W(const String& pin_concat, const uint8_t salt1[16], const ui
   return true;
 }
 
+// Normal and recovery W are independent PBKDF2 runs over the same salts; run the
+// recovery one on the other core and the normal one here, then join.
+struct KdfPairJob {
+  const String* pin_plus_rk;
+  const uint8_t* salt1;
+  const uint8_t* salt2;
+  uint32_t iters;
+  std::vector<uint8_t>* out;
+  bool ok;
+  SemaphoreHandle_t done;
+  volatile bool cancel; // set by the caller when its half fails, so the join is quick
+};
+
+static void kdf_recovery_task(void* arg) {
+  KdfPairJob* job = (KdfPairJob*)arg;
+  job->ok = derive_W_recovery_only(*job->pin_plus_rk, job->salt1, job->salt2, job->iters, *job->out, &job->cancel);
+  xSemaphoreGive(job->done);
+  vTaskDelete(nullptr);
+}
+
+static bool derive_W_pair(const String& pin, const String& pin_plus_rk,
+                          const uint8_t salt1[16], const uint8_t salt2[16], uint32_t iters,
+                          std::vector<uint8_t>& Wn, std::vector<uint8_t>& Wr) {
+  KdfPairJob job = { &pin_plus_rk, salt1, salt2, iters, &Wr, false, xSemaphoreCreateBinary(), false };
+
+  // Idle priority: shares core time with IDLE so the task watchdog stays fed.
+  BaseType_t otherCore = xPortGetCoreID() ? 0 : 1;
+  bool spawned = job.done &&
+                 xTaskCreatePinnedToCore(kdf_recovery_task, "kdf_rec", 8192, &job,
+                                         tskIDLE_PRIORITY, nullptr, otherCore) == pdPASS;
+  if (!spawned) Serial.println("[KDF] derive_W_pair: helper task unavailable, running serially");
+
+  bool okN = derive_W(pin, salt1, salt2, iters, Wn);
+
+  // A canceled or failed normal half makes the pair useless; stop the helper at
+  // its next slice instead of waiting out the whole recovery KDF.
+  if (spawned) {
+    if (!okN) job.cancel = true;
+    xSemaphoreTake(job.done, portMAX_DELAY);
+  } else if (okN) {
+    job.ok = derive_W_recovery_only(pin_plus_rk, salt1, salt2, iters, Wr);
+  }
+  if (job.done) vSemaphoreDelete(job.done);
+
+  if (!okN) Serial.println("[KDF] derive_W_pair: normal failed");
+  else if (!job.ok) Serial.println("[KDF] derive_W_pair: recovery failed");
+  if (okN && job.ok) return true;
+
+  if (!Wn.empty()) secure_zero(Wn.data(), Wn.size());
+  if (!Wr.empty()) secure_zero(Wr.data(), Wr.size());
+  Wn.clear(); Wr.clear();
+  return false;
+}
+
 static bool make_verifier(const std::vector<uint8_t>& W, String& out_b64) {
   uint8_t mac[32];
   const char* msg = "verifier v1";
@@ -141,11 +509,12 @@ static bool check_verifier(const std::vector<uint8_t>& W, const String& verifier
   return ok;
 }
 
-static bool wrap_vault_key(const std::vector<uint8_t>& W, const std::vector<uint8_t>& vault_key, String& out_ct_b64, String& out_nonce_b64) {
+static bool wrap_vault_key(const std::vector<uint8_t>& W, const uint8_t* vault_key, String& out_ct_b64, String& out_nonce_b64) {
   Serial.println("[WRAP] wrap_vault_key");
+  if (!vault_key) { Serial.println("[WRAP] no vault key loaded"); return false; }
   uint8_t nonce[12]; random_bytes(nonce, sizeof(nonce));
   std::vector<uint8_t> ct;
-  if (!aes256_gcm_encrypt(W.data(), nonce, (const uint8_t*)"wrap v1", 7, vault_key.data(), vault_key.size(), ct)) {
+  if (!aes256_gcm_encrypt(W.data(), nonce, (const uint8_t*)"wrap v1", 7, vault_key, 32, ct)) {
     Serial.println("[WRAP] encrypt failed"); return false;
   }
   out_ct_b64 = b64encode(ct.data(), ct.size());
@@ -161,76 +530,242 @@ static bool unwrap_vault_key(const std::vector<uint8_t>& W, const String& ct_b64
   if (!aes256_gcm_decrypt(W.data(), nonce.data(), (const uint8_t*)"wrap v1", 7, ct.data(), ct.size(), plain)) {
     Serial.println("[WRAP] decrypt failed"); return false;
   }
-  out_vault_key = plain;
+  if (plain.size() != 32) {
+    Serial.println("[WRAP] unwrapped key not 32 bytes");
+    secure_zero(plain.data(), plain.size());
+    return false;
+  }
+  out_vault_key = std::move(plain);
   return true;
 }
 
-static bool derive_subkeys_from_vault() {
-  Serial.println("[KDF] derive_subkeys_from_vault");
-  if (g_crypto.vault_key.size() != 32) { Serial.println("[KDF] vault_key not 32 bytes"); return false; }
+// ==== KeyRing ====
+static const char* const kSubkeyInfo[SUBKEY_COUNT] = { "K_fields v1", "K_db v1", "K_meta v1", "K_session v1", "K_fp v1", "K_integ v1" };
+// A suite switch keeps the vault_key, so the AEAD subkeys name the suite: one key
+// never feeds both ciphers. AES-GCM keeps the original strings existing vaults use.
+static const char* const kSubkeyInfoChaCha[SUBKEY_COUNT] = { "K_fields v1|chacha", "K_db v1|chacha", "K_meta v1|chacha", "K_session v1", "K_fp v1", "K_integ v1" };
 
-  g_crypto.K_fields.assign(32, 0);
-  g_crypto.K_db.assign(32, 0);
-  g_crypto.K_meta.assign(32, 0);
+static const char* subkey_info(CipherSuite suite, uint8_t i) {
+  return suite == CipherSuite::ChaChaPoly ? kSubkeyInfoChaCha[i] : kSubkeyInfo[i];
+}
 
-  const uint8_t* salt = (const uint8_t*)"subkey salt";
-  size_t salt_len = 11;
+static void keyring_wipe(KeyRing& k) {
+  for (uint8_t i = 0; i < SUBKEY_COUNT; ++i) {
+    if (k.aead_ready & (1u << i)) aead_free(k.aead[i]);
+  }
+  secure_zero(k.vault_key, sizeof(k.vault_key));
+  secure_zero(k.prk, sizeof(k.prk));
+  secure_zero(k.sub, sizeof(k.sub));
+  k.loaded = false;
+  k.sub_ready = 0;
+  k.aead_ready = 0;
+}
 
-  if (!hkdf_sha256_extract_expand(g_crypto.vault_key.data(), 32, salt, salt_len,
-                                 (const uint8_t*)"K_fields v1", 11,
-                                 g_crypto.K_fields.data(), 32)) return false;
+// Installs vault_key and runs the HKDF extract step once; subkeys are expanded from the PRK on demand.
+static bool keyring_load(KeyRing& k, const uint8_t vault_key[32], CipherSuite suite) {
+  if (vault_key == k.vault_key && suite == k.suite) return k.loaded;
+  uint8_t vk[32];
+  memcpy(vk, vault_key, 32);  // vault_key may alias k.vault_key
+  keyring_wipe(k);
+  memcpy(k.vault_key, vk, 32);
+  secure_zero(vk, sizeof(vk));
+  k.suite = suite;
+  if (!hmac_sha256((const uint8_t*)"subkey salt", 11, k.vault_key, 32, k.prk)) {
+    Serial.println("[KEYS] PRK extract failed");
+    keyring_wipe(k);
+    return false;
+  }
+  k.loaded = true;
+  return true;
+}
 
-  if (!hkdf_sha256_extract_expand(g_crypto.vault_key.data(), 32, salt, salt_len,
-                                 (const uint8_t*)"K_db v1", 7,
-                                 g_crypto.K_db.data(), 32)) return false;
+// Single-block HKDF expand: T(1) = HMAC(PRK, info || 0x01). Same bytes hkdf_sha256_extract_expand produced.
+static const uint8_t* keyring_subkey(KeyRing& k, SubKey id) {
+  uint8_t i = (uint8_t)id;
+  if (!k.loaded || i >= SUBKEY_COUNT) return nullptr;
+  if (k.sub_ready & (1u << i)) return k.sub[i];
 
-  if (!hkdf_sha256_extract_expand(g_crypto.vault_key.data(), 32, salt, salt_len,
-                                 (const uint8_t*)"K_meta v1", 9,
-                                 g_crypto.K_meta.data(), 32)) return false;
+  const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+  if (!md) return nullptr;
+  const uint8_t one = 1;
+  const char* info = subkey_info(k.suite, i);
+  mbedtls_md_context_t ctx;
+  mbedtls_md_init(&ctx);
+  int rc = mbedtls_md_setup(&ctx, md, 1);
+  if (rc == 0) rc = mbedtls_md_hmac_starts(&ctx, k.prk, 32);
+  if (rc == 0) rc = mbedtls_md_hmac_update(&ctx, (const uint8_t*)info, strlen(info));
+  if (rc == 0) rc = mbedtls_md_hmac_update(&ctx, &one, 1);
+  if (rc == 0) rc = mbedtls_md_hmac_finish(&ctx, k.sub[i]);
+  mbedtls_md_free(&ctx);
+  if (rc != 0) {
+    Serial.printf("[KEYS] expand %s failed\n", info);
+    secure_zero(k.sub[i], 32);
+    return nullptr;
+  }
+  k.sub_ready |= (uint8_t)(1u << i);
+  return k.sub[i];
+}
+
+static AeadCtx* keyring_aead(KeyRing& k, SubKey id) {
+  uint8_t i = (uint8_t)id;
+  const uint8_t* key = keyring_subkey(k, id);
+  if (!key) return nullptr;
+  if (k.aead_ready & (1u << i)) return &k.aead[i];
+
+  if (!aead_setkey(k.aead[i], k.suite, key)) return nullptr;
+  k.aead_ready |= (uint8_t)(1u << i);
+  return &k.aead[i];
+}
+
+// The active ring (g_crypto.keys) is what all item/meta crypto uses.
+static void keyring_wipe() { keyring_wipe(g_crypto.keys); }
+static bool keyring_load(const uint8_t vault_key[32]) {
+  return keyring_load(g_crypto.keys, vault_key, (CipherSuite)g_meta.cipher_suite);
+}
+static bool keyring_loaded() { return g_crypto.keys.loaded; }
+static const uint8_t* keyring_subkey(SubKey id) { return keyring_subkey(g_crypto.keys, id); }
+static AeadCtx* keyring_aead(SubKey id) { return keyring_aead(g_crypto.keys, id); }
+
+static bool keyring_generate() {
+  uint8_t vk[32];
+  random_bytes(vk, sizeof(vk));
+  bool ok = keyring_load(vk);
+  secure_zero(vk, sizeof(vk));
+  return ok;
+}
 
+static const uint8_t* keyring_vault_key() {
+  return g_crypto.keys.loaded ? g_crypto.keys.vault_key : nullptr;
+}
+
+// ==== Session re-auth ====
+// Confirms the PIN during an unlocked session with two HMACs instead of the
+// full KDF. The per-session key survives a vault-key rotation because it is
+// derived once, at arm time.
+static void session_auth_wipe() {
+  secure_zero(g_crypto.session.key, sizeof(g_crypto.session.key));
+  secure_zero(g_crypto.session.tag, sizeof(g_crypto.session.tag));
+  g_crypto.session.armed = false;
+}
+
+static bool session_auth_arm(const String& pin) {
+  session_auth_wipe();
+  const uint8_t* ks = keyring_subkey(SubKey::Session);
+  if (!ks) return false;
+  uint8_t salt[16];
+  random_bytes(salt, sizeof(salt));
+  bool ok = hmac_sha256(ks, 32, salt, sizeof(salt), g_crypto.session.key) &&
+            hmac_sha256(g_crypto.session.key, 32, (const uint8_t*)pin.c_str(), pin.length(), g_crypto.session.tag);
+  secure_zero(salt, sizeof(salt));
+  if (!ok) { session_auth_wipe(); return false; }
+  g_crypto.session.armed = true;
   return true;
 }
 
+static bool session_auth_check(const String& pin) {
+  if (!g_crypto.session.armed) return false;
+  uint8_t mac[32];
+  bool ok = hmac_sha256(g_crypto.session.key, 32, (const uint8_t*)pin.c_str(), pin.length(), mac) &&
+            consttime_eq(mac, g_crypto.session.tag, 32);
+  secure_zero(mac, sizeof(mac));
+  return ok;
+}
+
+// ==== Password fingerprint ====
+// HMAC(K_fp, password), truncated to 128 bits and hex-encoded. Equal passwords give
+// equal fingerprints within one vault key; without the key they reveal nothing.
+static bool password_fingerprint(const uint8_t* pw, size_t len, String& out_hex) {
+  out_hex = "";
+  const uint8_t* k = keyring_subkey(SubKey::Fingerprint);
+  if (!k) return false;
+  uint8_t mac[32];
+  if (!hmac_sha256(k, 32, pw, len, mac)) return false;
+  char hex[33];
+  for (int i = 0; i < 16; ++i) sprintf(&hex[i * 2], "%02x", mac[i]);
+  hex[32] = 0;
+  secure_zero(mac, sizeof(mac));
+  out_hex = hex;
+  return true;
+}
+
+static bool password_fingerprint(const SecureString& pw, String& out_hex) {
+  return password_fingerprint(pw.bytes(), pw.length(), out_hex);
+}
+
+static void crypto_lock() {
+  keyring_wipe(g_crypto.keys);
+  keyring_wipe(g_crypto.rekey_prev);
+  session_auth_wipe();
+  g_crypto.unlocked = false;
+}
+
 // ==== AAD builders ====
-static void make_item_field_aad(const String& db_uuid, const String& item_id, const char* field, std::vector<uint8_t>& aad) {
-  String s = String("item-field v1|") + db_uuid + "|" + item_id + "|" + field;
-  aad.assign(s.begin(), s.end());
+static void cache_db_uuid() {
+  size_t n = g_meta.db_uuid.length();
+  if (n > DB_UUID_MAX) n = 0; // oversize uuid: AAD reads it from g_meta directly
+  memcpy(g_db_uuid_c, g_meta.db_uuid.c_str(), n);
+  g_db_uuid_c[n] = 0;
+  g_db_uuid_len = n;
+  g_db_uuid_cached = true;
+}
+
+static void aad_put_db_uuid(AadBuf& aad) {
+  if (!g_db_uuid_cached) cache_db_uuid();
+  if (g_db_uuid_len) aad.put(g_db_uuid_c, g_db_uuid_len);
+  else aad.put(g_meta.db_uuid.c_str(), g_meta.db_uuid.length());
+}
+
+static bool make_item_field_aad(const String& item_id, const char* field, AadBuf& aad) {
+  aad.len = 0; aad.overflow = false;
+  aad.put("item-field v1|");
+  aad_put_db_uuid(aad);
+  aad.put("|", 1);
+  aad.put(item_id.c_str(), item_id.length());
+  aad.put("|", 1);
+  aad.put(field);
+  return !aad.overflow;
 }
 
-static void make_category_field_aad(const String& db_uuid, int32_t cat_id, const char* field, std::vector<uint8_t>& aad) {
-  String s = String("cat-field v1|") + db_uuid + "|" + String((int)cat_id) + "|" + field;
-  aad.assign(s.begin(), s.end());
+static bool make_category_field_aad(int32_t cat_id, const char* field, AadBuf& aad) {
+  aad.len = 0; aad.overflow = false;
+  aad.put("cat-field v1|");
+  aad_put_db_uuid(aad);
+  aad.put("|", 1);
+  char num[12];
+  int n = snprintf(num, sizeof(num), "%d", (int)cat_id);
+  aad.put(num, (size_t)n);
+  aad.put("|", 1);
+  aad.put(field);
+  return !aad.overflow;
 }
 
-static void make_item_label_aad(const String& db_uuid, const String& item_id, std::vector<uint8_t>& aad) {
-  String s = String("item-field v1|") + db_uuid + "|" + item_id + "|label";
-  aad.assign(s.begin(), s.end());
+static bool make_item_label_aad(const String& item_id, AadBuf& aad) {
+  return make_item_field_aad(item_id, "label", aad);
 }
 
 // ==== Item crypto ====
 static bool encrypt_label_password(const String& label_plain,
-                                  const String& pw_plain,
-                                  String item_id,
+                                  const SecureString& pw_plain,
+                                  const String& item_id,
                                   String& out_label_ct_b64,
                                   String& out_label_nonce_b64,
                                   String& out_pw_ct_b64,
                                   String& out_pw_nonce_b64) {
-  if (g_crypto.K_fields.size() != 32) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   {
-    std::vector<uint8_t> aadL;
-    make_item_label_aad(g_meta.db_uuid, item_id, aadL);
+    AadBuf aadL;
+    if (!make_item_label_aad(item_id, aadL)) return false;
     if (!encrypt_string_meta_b64(aadL, label_plain, out_label_ct_b64, out_label_nonce_b64)) return false;
   }
 
   {
-    std::vector<uint8_t> aadP;
-    make_item_field_aad(g_meta.db_uuid, item_id, "password", aadP);
+    AadBuf aadP;
+    if (!make_item_field_aad(item_id, "password", aadP)) return false;
     uint8_t nP[12]; random_bytes(nP, sizeof(nP));
     std::vector<uint8_t> ctP;
-    if (!aes256_gcm_encrypt(g_crypto.K_fields.data(), nP, aadP.data(), aadP.size(),
-                           (const uint8_t*)pw_plain.c_str(), pw_plain.length(), ctP)) return false;
+    if (!aead_encrypt(keyring_aead(SubKey::Fields), nP, aadP.data(), aadP.size(),
+                           pw_plain.bytes(), pw_plain.length(), ctP)) return false;
 
     out_pw_ct_b64 = b64encode(ctP.data(), ctP.size());
     out_pw_nonce_b64 = b64encode(nP, sizeof(nP));
@@ -244,74 +779,55 @@ static bool decrypt_label(const PasswordItem& it, const String& /*item_id*/, Str
   return true;
 }
 
-static bool decrypt_password(const PasswordItem& it, const String& item_id, String& out_pw) {
-  if (g_crypto.K_fields.size() != 32) return false;
+// Password ciphertext -> SecureString, decrypted straight into the arena slot.
+static bool decrypt_password_ct(const String& ct_b64, const String& nonce_b64, const String& item_id, SecureString& out_pw) {
+  out_pw.clear();
+  if (!keyring_loaded()) return false;
   std::vector<uint8_t> ct, nonce;
-  if (!b64decode(it.pw_ct_b64, ct)) return false;
-  if (!b64decode(it.pw_nonce_b64, nonce)) return false;
-  std::vector<uint8_t> aad;
-  make_item_field_aad(g_meta.db_uuid, item_id, "password", aad);
-  std::vector<uint8_t> plain;
-  if (!aes256_gcm_decrypt(g_crypto.K_fields.data(), nonce.data(), aad.data(), aad.size(), ct.data(), ct.size(), plain)) return false;
-  out_pw = String((const char*)plain.data(), plain.size());
-  memset(plain.data(), 0, plain.size());
+  if (!b64decode(ct_b64, ct)) return false;
+  if (!b64decode(nonce_b64, nonce)) return false;
+  if (nonce.size() != 12 || ct.size() < 16) return false;
+  AadBuf aad;
+  if (!make_item_field_aad(item_id, "password", aad)) return false;
+  char* dst = out_pw.prepare(ct.size() - 16);
+  if (!dst) return false;
+  if (!aead_decrypt_raw(keyring_aead(SubKey::Fields), nonce.data(), aad.data(), aad.size(),
+                                  ct.data(), ct.size(), (uint8_t*)dst)) {
+    out_pw.clear();
+    return false;
+  }
   return true;
 }
 
-static bool decrypt_password_bytes(const PasswordItem& it, const String& item_id, SecureBuf& out) {
-  out.clear();
-  if (g_crypto.K_fields.size() != 32) return false;
-
-  std::vector<uint8_t> ct, nonce;
-  if (!b64decode(it.pw_ct_b64, ct)) return false;
-  if (!b64decode(it.pw_nonce_b64, nonce)) return false;
-
-  std::vector<uint8_t> aad;
-  make_item_field_aad(g_meta.db_uuid, item_id, "password", aad);
-
-  std::vector<uint8_t> plain;
-  if (!aes256_gcm_decrypt(g_crypto.K_fields.data(), nonce.data(),aad.data(), aad.size(), ct.data(), ct.size(), plain)) return false;
-
-  out.b = std::move(plain);
-  return true;
+static bool decrypt_password(const PasswordItem& it, const String& item_id, SecureString& out_pw) {
+  return decrypt_password_ct(it.pw_ct_b64, it.pw_nonce_b64, item_id, out_pw);
 }
 
-static bool encrypt_password_only_for_item(const String& item_id, const String& pw_plain, String& out_ct_b64, String& out_nonce_b64) {
-  if (g_crypto.K_fields.size() != 32) return false;
-  std::vector<uint8_t> aad; make_item_field_aad(g_meta.db_uuid, item_id, "password", aad);
+static bool encrypt_password_only_for_item(const String& item_id, const SecureString& pw_plain, String& out_ct_b64, String& out_nonce_b64) {
+  if (!keyring_loaded()) return false;
+  AadBuf aad; if (!make_item_field_aad(item_id, "password", aad)) return false;
   uint8_t nP[12]; random_bytes(nP, sizeof(nP));
   std::vector<uint8_t> ctP;
-  if (!aes256_gcm_encrypt(g_crypto.K_fields.data(), nP, aad.data(), aad.size(),
-                    (const uint8_t*)pw_plain.c_str(), pw_plain.length(), ctP)) return false;
+  if (!aead_encrypt(keyring_aead(SubKey::Fields), nP, aad.data(), aad.size(),
+                    pw_plain.bytes(), pw_plain.length(), ctP)) return false;
   out_ct_b64 = b64encode(ctP.data(), ctP.size());
   out_nonce_b64 = b64encode(nP, sizeof(nP));
   return true;
 }
 
-static bool decrypt_password_history_version(const PasswordItem& it, const PasswordVersion& v, String& out_pw) {
-  if (g_crypto.K_fields.size() != 32) return false;
-  std::vector<uint8_t> ct, nonce;
-  if (!b64decode(v.pw_ct_b64, ct)) return false;
-  if (!b64decode(v.pw_nonce_b64, nonce)) return false;
-  std::vector<uint8_t> aad;
-  make_item_field_aad(g_meta.db_uuid, it.id, "password", aad);
-  std::vector<uint8_t> plain;
-  if (!aes256_gcm_decrypt(g_crypto.K_fields.data(), nonce.data(), aad.data(), aad.size(),
-                    ct.data(), ct.size(), plain)) return false;
-  out_pw = String((const char*)plain.data(), plain.size());
-  memset(plain.data(), 0, plain.size());
-  return true;
+static bool decrypt_password_history_version(const PasswordItem& it, const PasswordVersion& v, SecureString& out_pw) {
+  return decrypt_password_ct(v.pw_ct_b64, v.pw_nonce_b64, it.id, out_pw);
 }
 
-static bool encrypt_string_meta_b64(const std::vector<uint8_t>& aad,
+static bool encrypt_string_meta_b64(const AadBuf& aad,
                                    const String& plain,
                                    String& out_ct_b64,
                                    String& out_nonce_b64) {
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   uint8_t nonce[12]; random_bytes(nonce, sizeof(nonce));
   std::vector<uint8_t> ct;
-  if (!aes256_gcm_encrypt(g_crypto.K_meta.data(), nonce, aad.data(), aad.size(),
+  if (!aead_encrypt(keyring_aead(SubKey::Meta), nonce, aad.data(), aad.size(),
                          (const uint8_t*)plain.c_str(), plain.length(), ct)) return false;
 
   out_ct_b64 = b64encode(ct.data(), ct.size());
@@ -319,11 +835,11 @@ static bool encrypt_string_meta_b64(const std::vector<uint8_t>& aad,
   return out_ct_b64.length() && out_nonce_b64.length();
 }
 
-static bool decrypt_string_meta_b64(const std::vector<uint8_t>& aad,
+static bool decrypt_string_meta_b64(const AadBuf& aad,
                                    const String& ct_b64,
                                    const String& nonce_b64,
                                    String& out_plain) {
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   std::vector<uint8_t> ct, nonce;
   if (!b64decode(ct_b64, ct)) return false;
@@ -331,7 +847,7 @@ static bool decrypt_string_meta_b64(const std::vector<uint8_t>& aad,
   if (nonce.size() != 12) return false;
 
   std::vector<uint8_t> plain;
-  if (!aes256_gcm_decrypt(g_crypto.K_meta.data(), nonce.data(), aad.data(), aad.size(),
+  if (!aead_decrypt(keyring_aead(SubKey::Meta), nonce.data(), aad.data(), aad.size(),
                          ct.data(), ct.size(), plain)) return false;
 
   out_plain = String((const char*)plain.data(), plain.size());
@@ -545,14 +1061,130 @@ static uint32_t map_security_level_to_iters(uint8_t lvl) {
   return minIters + (uint32_t)(lvl - 1) * step;
 }
 
+// ==== KDF calibration ====
+// Levels are offered as target unlock times; the iteration count is whatever
+// this device can do in that time (never below level-1 iterations).
+struct KdfUnlockTarget { const char* label; uint32_t ms; };
+static const KdfUnlockTarget kKdfTargets[] = {
+  { "[ 0.5 SEC UNLOCK ]",  500 },
+  { "[ 1 SEC UNLOCK ]",   1000 },
+  { "[ 2 SEC UNLOCK ]",   2000 },
+  { "[ 4 SEC UNLOCK ]",   4000 },
+};
+static constexpr uint8_t  KDF_TARGET_COUNT  = sizeof(kKdfTargets) / sizeof(kKdfTargets[0]);
+static constexpr uint32_t KDF_BENCH_MIN_US  = 200000;   // measure for at least 200 ms
+static constexpr uint32_t KDF_MAX_ITERS     = 20000000; // fits meta.kdf_iters (INTEGER)
+
+static uint32_t g_kdf_iters_per_sec = 0; // cached per boot
+
+static uint32_t kdf_benchmark_iters_per_sec() {
+  if (g_kdf_iters_per_sec) return g_kdf_iters_per_sec;
+
+  uint8_t pw[32], salt[16], out[32];
+  random_bytes(pw, sizeof(pw));
+  random_bytes(salt, sizeof(salt));
+
+  uint32_t iters = 1000;
+  uint32_t us = 0;
+  for (;;) {
+    uint32_t t0 = micros();
+    if (!pbkdf2_hmac_sha256(pw, sizeof(pw), salt, sizeof(salt), iters, out, sizeof(out))) break;
+    us = micros() - t0;
+    if (us >= KDF_BENCH_MIN_US || iters >= (1u << 20)) break;
+    iters *= 2;
+  }
+  secure_zero(pw, sizeof(pw));
+  secure_zero(out, sizeof(out));
+
+  if (!us) return 0;
+  g_kdf_iters_per_sec = (uint32_t)(((uint64_t)iters * 1000000ULL) / us);
+  Serial.printf("[KDF] calibrate: %u iters in %u us -> %u iters/s\n",
+                (unsigned)iters, (unsigned)us, (unsigned)g_kdf_iters_per_sec);
+  return g_kdf_iters_per_sec;
+}
+
+static uint32_t kdf_iters_for_target_ms(uint32_t target_ms) {
+  const uint32_t floorIters = map_security_level_to_iters(1);
+  uint32_t rate = kdf_benchmark_iters_per_sec();
+  if (!rate) return floorIters;
+  uint64_t it = ((uint64_t)rate * target_ms) / 1000;
+  it = (it / 1000) * 1000;
+  if (it < floorIters) it = floorIters;
+  if (it > KDF_MAX_ITERS) it = KDF_MAX_ITERS;
+  return (uint32_t)it;
+}
+
+static volatile bool g_kdf_target_done = false;
+static volatile int  g_kdf_target_choice = -1;
+
+static void KDFTARGET_OnSelect(uint8_t idx, const char* /*label*/) {
+  g_kdf_target_choice = (idx < KDF_TARGET_COUNT) ? idx : -1;
+  g_kdf_target_done = true;
+}
+static void KDFTARGET_OnBack() {
+  g_kdf_target_choice = -1;
+  g_kdf_target_done = true;
+}
+
 static bool promptSecurityLevel(uint8_t& outLevel, uint32_t& outIters, const char* title) {
-  String s = runTextInput(title, "1..9 (1=Fast, 9=Strong)", 1, TextInputUI::InputMode::INTEGER, false);
-  s.trim();
-  if (!s.length()) return false;
-  int v = s.toInt();
-  if (v < 1) v = 1;
-  if (v > 9) v = 9;
-  outLevel = (uint8_t)v;
-  outIters = map_security_level_to_iters(outLevel);
+  {
+    LoadingScope loading("LOADING", "Measuring speed...");
+    kdf_benchmark_iters_per_sec();
+  }
+
+  static const char* items[KDF_TARGET_COUNT + 1];
+  for (uint8_t i = 0; i < KDF_TARGET_COUNT; ++i) items[i] = kKdfTargets[i].label;
+  items[KDF_TARGET_COUNT] = "[ CANCEL ]";
+
+  MenuContext savedCtx = g_menuCtx;
+  g_menuCtx = MenuContext::None;
+
+  menu.clearScreen(BLACK);
+  menu.setTitle(title);
+  menu.setSubTitle("Longer unlock = stronger");
+  menu.setMenu(items, KDF_TARGET_COUNT + 1);
+  menu.setSelectedIndex(1);
+
+  g_kdf_target_done = false;
+  g_kdf_target_choice = -1;
+  menu.setOnSelect(KDFTARGET_OnSelect);
+  menu.setOnBack(KDFTARGET_OnBack);
+
+  pinMode(BTN_SELECT, INPUT_PULLUP);
+  int lastB = digitalRead(BTN_SELECT);
+  while (!g_kdf_target_done) {
+    menuLoopAuto();
+    int b = digitalRead(BTN_SELECT);
+    if (lastB == HIGH && b == LOW) {
+      int sel = menu.getSelectedIndex();
+      g_kdf_target_choice = (sel >= 0 && sel < KDF_TARGET_COUNT) ? sel : -1;
+      g_kdf_target_done = true;
+    }
+    lastB = b;
+    delay(5);
+  }
+
+  switch (savedCtx) {
+    case MenuContext::MainMenu:
+    case MenuContext::CategoryScreen_Main:
+    case MenuContext::CategoryScreen_PwdSub:
+    case MenuContext::Settings:
+    case MenuContext::Settings_Password:
+      menu.setOnSelect(MENU_OnSelect);
+      menu.setOnBack(MENU_OnBack);
+      break;
+    default:
+      menu.setOnSelect(nullptr);
+      menu.setOnBack(nullptr);
+      break;
+  }
+  g_menuCtx = savedCtx;
+
+  int choice = g_kdf_target_choice;
+  if (choice < 0) return false;
+
+  outLevel = (uint8_t)(choice + 1);
+  outIters = kdf_iters_for_target_ms(kKdfTargets[choice].ms);
+  Serial.printf("[KDF] target %u ms -> %u iters\n", (unsigned)kKdfTargets[choice].ms, (unsigned)outIters);
   return true;
-}
\ No newline at end of file
+}
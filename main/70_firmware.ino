@@ -158,35 +158,27 @@ static void check_and_apply_sd_ota_if_present() {
 static bool update_kdf_iters(uint32_t new_iters, const String& current_pin, const String& recovery_key_b64) {
   Serial.printf("[KDF] update_kdf_iters -> %u\n", (unsigned)new_iters);
 
-  if (g_crypto.vault_key.size() != 32) {
+  if (!keyring_loaded()) {
     Serial.println("[KDF] vault_key not available (not unlocked?)");
     return false;
   }
 
-  std::vector<uint8_t> Wn;
-  if (!derive_W(current_pin, g_meta.kdf_salt1, g_meta.kdf_salt2, new_iters, Wn)) {
-    Serial.println("[KDF] derive_W failed with new iters"); return false;
+  String pin_plus_rk = current_pin + recovery_key_b64;
+  SecureBuf Wn, Wr;
+  if (!derive_W_pair(current_pin, pin_plus_rk, g_meta.kdf_salt1, g_meta.kdf_salt2, new_iters, Wn.b, Wr.b)) {
+    Serial.println("[KDF] derive_W_pair failed with new iters"); return false;
   }
   String ct_n_b64, nonce_n_b64;
-  if (!wrap_vault_key(Wn, g_crypto.vault_key, ct_n_b64, nonce_n_b64)) { std::fill(Wn.begin(), Wn.end(), 0); Serial.println("[KDF] wrap normal failed"); return false; }
+  if (!wrap_vault_key(Wn.b, keyring_vault_key(), ct_n_b64, nonce_n_b64)) { Serial.println("[KDF] wrap normal failed"); return false; }
   String ver_n_b64;
-  if (!make_verifier(Wn, ver_n_b64)) { std::fill(Wn.begin(), Wn.end(), 0); Serial.println("[KDF] make_verifier normal failed"); return false; }
+  if (!make_verifier(Wn.b, ver_n_b64)) { Serial.println("[KDF] make_verifier normal failed"); return false; }
 
-  String pin_plus_rk = current_pin + recovery_key_b64;
-  std::vector<uint8_t> Wr;
-  if (!derive_W_recovery_only(pin_plus_rk, g_meta.kdf_salt1, g_meta.kdf_salt2, new_iters, Wr)) {
-    std::fill(Wn.begin(), Wn.end(), 0);
-    Serial.println("[KDF] derive_W_recovery_only failed with new iters");
-    return false;
-  }
   String ct_r_b64, nonce_r_b64;
-  if (!wrap_vault_key(Wr, g_crypto.vault_key, ct_r_b64, nonce_r_b64)) {
-    std::fill(Wn.begin(), Wn.end(), 0); std::fill(Wr.begin(), Wr.end(), 0);
+  if (!wrap_vault_key(Wr.b, keyring_vault_key(), ct_r_b64, nonce_r_b64)) {
     Serial.println("[KDF] wrap recovery failed"); return false;
   }
   String ver_r_b64;
-  if (!make_verifier(Wr, ver_r_b64)) {
-    std::fill(Wn.begin(), Wn.end(), 0); std::fill(Wr.begin(), Wr.end(), 0);
+  if (!make_verifier(Wr.b, ver_r_b64)) {
     Serial.println("[KDF] make_verifier recovery failed"); return false;
   }
 
@@ -199,10 +191,5 @@ static bool update_kdf_iters(uint32_t new_iters, const String& current_pin, cons
   g_meta.vault_wrap_recovery_ct_b64 = ct_r_b64;
   g_meta.vault_wrap_recovery_nonce_b64 = nonce_r_b64;
 
-  bool ok = saveMeta();
-
-  std::fill(Wn.begin(), Wn.end(), 0);
-  std::fill(Wr.begin(), Wr.end(), 0);
-
-  return ok;
+  return saveMeta();
 }
\ No newline at end of file
@@ -9,6 +9,7 @@ static bool initializeNewVaultWithPIN(const String& pin) {
     for (int i = 0; i < 16; ++i) sprintf(&uuid[i*2], "%02x", b[i]);
     uuid[32] = 0;
     g_meta.db_uuid = uuid;
+    cache_db_uuid();
   }
   random_bytes(g_meta.kdf_salt1, 16);
   random_bytes(g_meta.kdf_salt2, 16);
@@ -18,40 +19,35 @@ static bool initializeNewVaultWithPIN(const String& pin) {
 
   LoadingScope loading("LOADING", "Saving Encryption..");
 
-  std::vector<uint8_t> Wn;
-  if (!derive_W(pin, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn)) {
-    Serial.println("[FLOW] derive_W normal failed");
-    return false;
-  }
-
   String pin_plus_rk = pin + recovery_key_b64;
-  std::vector<uint8_t> Wr;
-  if (!derive_W_recovery_only(pin_plus_rk, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wr)) {
-    Serial.println("[FLOW] derive_W_recovery_only failed");
-    return false;
+  SecureBuf Wn, Wr;
+  {
+    KdfProgressScope progress(loadingKdfProgressNoCancel);
+    if (!derive_W_pair(pin, pin_plus_rk, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn.b, Wr.b)) {
+      Serial.println("[FLOW] derive_W_pair failed");
+      return false;
+    }
   }
 
-  if (!make_verifier(Wn, g_meta.verifier_normal_b64)) {
+  if (!make_verifier(Wn.b, g_meta.verifier_normal_b64)) {
     Serial.println("[FLOW] make_verifier normal failed");
     return false;
   }
-  if (!make_verifier(Wr, g_meta.verifier_recovery_b64)) {
+  if (!make_verifier(Wr.b, g_meta.verifier_recovery_b64)) {
     Serial.println("[FLOW] make_verifier recovery failed");
     return false;
   }
 
-  g_crypto.vault_key.assign(32, 0);
-  random_bytes(g_crypto.vault_key.data(), 32);
-  if (!derive_subkeys_from_vault()) {
-    Serial.println("[KDF] derive_subkeys_from_vault failed");
+  if (!keyring_generate()) {
+    Serial.println("[FLOW] keyring_generate failed");
     return false;
   }
 
-  if (!wrap_vault_key(Wn, g_crypto.vault_key, g_meta.vault_wrap_normal_ct_b64, g_meta.vault_wrap_normal_nonce_b64)) {
+  if (!wrap_vault_key(Wn.b, keyring_vault_key(), g_meta.vault_wrap_normal_ct_b64, g_meta.vault_wrap_normal_nonce_b64)) {
     Serial.println("[FLOW] wrap normal failed");
     return false;
   }
-  if (!wrap_vault_key(Wr, g_crypto.vault_key, g_meta.vault_wrap_recovery_ct_b64, g_meta.vault_wrap_recovery_nonce_b64)) {
+  if (!wrap_vault_key(Wr.b, keyring_vault_key(), g_meta.vault_wrap_recovery_ct_b64, g_meta.vault_wrap_recovery_nonce_b64)) {
     Serial.println("[FLOW] wrap recovery failed");
     return false;
   }
@@ -71,18 +67,21 @@ static bool unlockWithPIN(const String& pin) {
   LoadingScope loading("LOADING", "Reading meta...");
   if (!loadMeta()) return false;
 
-  updateLoading("Deriving key...");
+  updateLoading("Deriving key (BACK=stop)");
   std::vector<uint8_t> Wn;
-  if (!derive_W(pin, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn)) return false;
+  {
+    KdfProgressScope progress(loadingKdfProgress);
+    if (!derive_W(pin, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn)) return false;
+  }
 
   updateLoading("Verifying...");
   if (!check_verifier(Wn, g_meta.verifier_normal_b64)) return false;
 
   updateLoading("Unwrapping vault key...");
-  if (!unwrap_vault_key(Wn, g_meta.vault_wrap_normal_ct_b64, g_meta.vault_wrap_normal_nonce_b64, g_crypto.vault_key)) return false;
-
-  updateLoading("Deriving subkeys...");
-  if (!derive_subkeys_from_vault()) return false;
+  SecureBuf vk;
+  if (!unwrap_vault_key(Wn, g_meta.vault_wrap_normal_ct_b64, g_meta.vault_wrap_normal_nonce_b64, vk.b)) return false;
+  if (!keyring_load(vk.b.data())) return false;
+  if (!session_auth_arm(pin)) Serial.println("[FLOW] session re-auth unavailable");
 
   g_crypto.unlocked = true;
   touchActivity();
@@ -110,13 +109,13 @@ static bool recoverWithPINandRecovery(const String& pin, const String& recovery_
   if (!ver_ok) return false;
 
   Serial.println("[REC] unwrap...");
-  bool unwrap_ok = unwrap_vault_key(Wr, g_meta.vault_wrap_recovery_ct_b64, g_meta.vault_wrap_recovery_nonce_b64, g_crypto.vault_key);
-  Serial.printf("[REC] unwrap %s (vault_key len=%u)\n", unwrap_ok ? "OK" : "FAIL", (unsigned)g_crypto.vault_key.size());
+  SecureBuf vk;
+  bool unwrap_ok = unwrap_vault_key(Wr, g_meta.vault_wrap_recovery_ct_b64, g_meta.vault_wrap_recovery_nonce_b64, vk.b);
+  Serial.printf("[REC] unwrap %s\n", unwrap_ok ? "OK" : "FAIL");
   if (!unwrap_ok) return false;
 
-  Serial.println("[REC] subkeys...");
-  if (!derive_subkeys_from_vault()) { Serial.println("[REC] subkeys FAIL"); return false; }
-  Serial.println("[REC] subkeys OK");
+  if (!keyring_load(vk.b.data())) { Serial.println("[REC] keyring load FAIL"); return false; }
+  Serial.println("[REC] keyring OK");
 
   Serial.println("[REC] rebuild normal path...");
   if (!ensureDeviceSecret()) { Serial.println("[REC] ensureDeviceSecret FAILED"); return false; }
@@ -132,7 +131,7 @@ static bool recoverWithPINandRecovery(const String& pin, const String& recovery_
   }
 
   String ct_n_b64, nonce_n_b64;
-  if (!wrap_vault_key(Wn, g_crypto.vault_key, ct_n_b64, nonce_n_b64)) {
+  if (!wrap_vault_key(Wn, keyring_vault_key(), ct_n_b64, nonce_n_b64)) {
     Serial.println("[REC] wrap normal FAILED"); return false;
   }
 
@@ -140,6 +139,7 @@ static bool recoverWithPINandRecovery(const String& pin, const String& recovery_
   g_meta.vault_wrap_normal_ct_b64 = ct_n_b64;
   g_meta.vault_wrap_normal_nonce_b64 = nonce_n_b64;
   if (!saveMeta()) { Serial.println("[REC] saveMeta FAILED"); return false; }
+  if (!session_auth_arm(pin)) Serial.println("[REC] session re-auth unavailable");
 
   g_crypto.unlocked = true;
   touchActivity();
@@ -147,28 +147,59 @@ static bool recoverWithPINandRecovery(const String& pin, const String& recovery_
   return true;
 }
 
-static bool auth_with_current_pin_get(String& out_pin) {
-  if (!loadMeta()) {
-    waitForButtonB("Error", "Meta load failed", "OK");
+// Confirms the current PIN before a sensitive action. While unlocked this is
+// the session verifier; the full KDF only runs if the session was never armed.
+// Failures count toward the same lockout as the unlock screen.
+static bool auth_with_current_pin_get(String& out_pin, const char* prompt) {
+  if (auth_isLockedOut()) {
+    lockAndReboot("PIN lockout");
     return false;
   }
 
-  String pin = promptPasscode6("Auth", "Enter current PIN");
-  LoadingScope loading("LOADING", "Checking...");
+  String pin = promptPasscode6("Auth", prompt);
   if (pin.length() != 6) {
     waitForButtonB("Error", "Invalid PIN", "OK");
     return false;
   }
 
+  if (g_crypto.session.armed) {
+    if (session_auth_check(pin)) {
+      if (auth_getFailCount()) auth_resetPinFailures();
+      out_pin = pin;
+      return true;
+    }
+    auth_recordPinFailure_andMaybeLockout();
+    if (auth_isLockedOut()) lockAndReboot("PIN lockout");
+    waitForButtonB("Error", "Wrong PIN", "OK");
+    return false;
+  }
+
+  if (!loadMeta()) {
+    waitForButtonB("Error", "Meta load failed", "OK");
+    return false;
+  }
+  LoadingScope loading("LOADING", "Checking...");
   std::vector<uint8_t> Wn;
-  if (!derive_W(pin, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn)) {
-    waitForButtonB("Error", "KDF derive failed", "OK");
+  bool derived;
+  {
+    KdfProgressScope progress(loadingKdfProgress);
+    derived = derive_W(pin, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn);
+  }
+  if (!derived) {
+    waitForButtonB("Error", kdf_was_canceled() ? "Canceled" : "KDF derive failed", "OK");
     return false;
   }
   bool ok = check_verifier(Wn, g_meta.verifier_normal_b64);
   std::fill(Wn.begin(), Wn.end(), 0);
 
-  if (ok) { out_pin = pin; return true; }
+  if (ok) {
+    if (auth_getFailCount()) auth_resetPinFailures();
+    session_auth_arm(pin);
+    out_pin = pin;
+    return true;
+  }
+  auth_recordPinFailure_andMaybeLockout();
+  if (auth_isLockedOut()) lockAndReboot("PIN lockout");
   waitForButtonB("Error", "Wrong PIN", "OK");
   return false;
 }
\ No newline at end of file
@@ -44,7 +44,7 @@ static void db_log_sqlite_error(const char* ctx, int rc) {
 static bool db_insert_category(const String& name, int32_t& out_id) {
   out_id = -1;
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   if (!db_begin()) return false;
 
@@ -59,18 +59,20 @@ static bool db_insert_category(const String& name, int32_t& out_id) {
   if (rc != SQLITE_DONE) { db_rollback(); return false; }
 
   out_id = (int32_t)sqlite3_last_insert_rowid(g_db);
+  IntegTouch touch(out_id, true);
 
   if (!db_upsert_category_meta(out_id, name)) { db_rollback(); return false; }
 
-  if (!db_commit()) { db_rollback(); return false; }
+  if (!touch.commit()) { db_rollback(); return false; }
   return true;
 }
 
 static bool db_update_category_name(int32_t id, const String& name) {
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   if (!db_begin()) return false;
+  IntegTouch touch(id);
 
   // Keep plaintext blank
   {
@@ -85,7 +87,22 @@ static bool db_update_category_name(int32_t id, const String& name) {
 
   if (!db_upsert_category_meta(id, name)) { db_rollback(); return false; }
 
-  if (!db_commit()) { db_rollback(); return false; }
+  if (!touch.commit()) { db_rollback(); return false; }
+  return true;
+}
+
+static bool db_update_category_policy(int32_t id, uint8_t policy) {
+  if (!db_open()) return false;
+  if (!db_begin()) return false;
+  IntegTouch touch(id);
+  const char* sql = "UPDATE categories SET pw_policy=? WHERE id=?;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) { db_rollback(); return false; }
+  sqlite3_bind_int(st, 1, (int)policy);
+  sqlite3_bind_int(st, 2, id);
+  int rc = sqlite3_step(st);
+  sqlite3_finalize(st);
+  if (rc != SQLITE_DONE || !touch.commit()) { db_rollback(); return false; }
   return true;
 }
 
@@ -101,26 +118,30 @@ static bool db_delete_category_if_empty(int32_t id, bool& deleted) {
   sqlite3_finalize(stc);
   if (cnt != 0) return true;
 
+  if (!db_begin()) return false;
+  IntegTouch touch(id);
   const char* sqld = "DELETE FROM categories WHERE id=?;";
   sqlite3_stmt* std = nullptr;
-  if (sqlite3_prepare_v2(g_db, sqld, -1, &std, nullptr) != SQLITE_OK) return false;
+  if (sqlite3_prepare_v2(g_db, sqld, -1, &std, nullptr) != SQLITE_OK) { db_rollback(); return false; }
   sqlite3_bind_int(std, 1, id);
   int rc = sqlite3_step(std);
   sqlite3_finalize(std);
-  deleted = (rc == SQLITE_DONE);
+  if (rc != SQLITE_DONE || !touch.commit()) { db_rollback(); return false; }
+  deleted = true;
   return deleted;
 }
 
 static bool db_insert_item(int32_t category_id, const PasswordItem& it) {
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   if (!db_begin()) return false;
+  IntegTouch touch(it.id);
 
   // Store blank plaintext label to avoid leaking names
   const char* sql =
-    "INSERT INTO items(id, category_id, label_plain, pw_ct_b64, pw_nonce_b64) "
-    "VALUES(?, ?, ?, ?, ?);";
+    "INSERT INTO items(id, category_id, label_plain, pw_ct_b64, pw_nonce_b64, pw_fp) "
+    "VALUES(?, ?, ?, ?, ?, ?);";
   sqlite3_stmt* st = nullptr;
   if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) { db_rollback(); return false; }
 
@@ -129,6 +150,7 @@ static bool db_insert_item(int32_t category_id, const PasswordItem& it) {
   sqlite3_bind_text(st, 3, "", -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(st, 4, it.pw_ct_b64.c_str(), -1, SQLITE_TRANSIENT);
   sqlite3_bind_text(st, 5, it.pw_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_text(st, 6, it.pw_fp.c_str(), -1, SQLITE_TRANSIENT);
 
   int rc = sqlite3_step(st);
   sqlite3_finalize(st);
@@ -143,15 +165,16 @@ static bool db_insert_item(int32_t category_id, const PasswordItem& it) {
   }
   if (!okMeta) { db_rollback(); return false; }
 
-  if (!db_commit()) { db_rollback(); return false; }
+  if (!touch.commit()) { db_rollback(); return false; }
   return true;
 }
 
 static bool db_update_item_label(const String& item_id, const String& new_label_plain) {
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
   if (!db_begin()) return false;
+  IntegTouch touch(item_id);
 
   // Keep plaintext blank
   {
@@ -166,43 +189,49 @@ static bool db_update_item_label(const String& item_id, const String& new_label_
 
   if (!db_upsert_item_meta_label_plain(item_id, new_label_plain)) { db_rollback(); return false; }
 
-  if (!db_commit()) { db_rollback(); return false; }
+  if (!touch.commit()) { db_rollback(); return false; }
   return true;
 }
 
-static bool db_update_item_password(const String& item_id, const String& new_ct_b64, const String& new_nonce_b64, const PasswordVersion* oldVersionOrNull) {
+static bool db_update_item_password(const String& item_id, const String& new_ct_b64, const String& new_nonce_b64, const String& new_fp, const PasswordVersion* oldVersionOrNull) {
   if (!db_open()) return false;
   if (!db_begin()) return false;
-  {
-    const char* sql = "UPDATE items SET pw_ct_b64=?, pw_nonce_b64=? WHERE id=?;";
-    sqlite3_stmt* st = nullptr;
-    if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) { db_rollback(); return false; }
-    sqlite3_bind_text(st, 1, new_ct_b64.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(st, 2, new_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(st, 3, item_id.c_str(), -1, SQLITE_TRANSIENT);
-    int rc = sqlite3_step(st);
-    sqlite3_finalize(st);
-    if (rc != SQLITE_DONE) { db_rollback(); return false; }
-  }
+  IntegTouch touch(item_id);
+  // Archive first: the old row's fingerprint travels with it into pw_history.
   if (oldVersionOrNull) {
-    const char* sqlh = "INSERT INTO pw_history(item_id, pw_ct_b64, pw_nonce_b64, ts) VALUES(?, ?, ?, ?);";
+    const char* sqlh = "INSERT INTO pw_history(item_id, pw_ct_b64, pw_nonce_b64, ts, pw_fp) "
+                       "VALUES(?, ?, ?, ?, COALESCE((SELECT pw_fp FROM items WHERE id=?), ''));";
     sqlite3_stmt* sth = nullptr;
     if (sqlite3_prepare_v2(g_db, sqlh, -1, &sth, nullptr) != SQLITE_OK) { db_rollback(); return false; }
     sqlite3_bind_text(sth, 1, item_id.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(sth, 2, oldVersionOrNull->pw_ct_b64.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_text(sth, 3, oldVersionOrNull->pw_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
     sqlite3_bind_int(sth, 4, (int)oldVersionOrNull->ts);
+    sqlite3_bind_text(sth, 5, item_id.c_str(), -1, SQLITE_TRANSIENT);
     int rc2 = sqlite3_step(sth);
     sqlite3_finalize(sth);
     if (rc2 != SQLITE_DONE) { db_rollback(); return false; }
   }
-  if (!db_commit()) { db_rollback(); return false; }
+  {
+    const char* sql = "UPDATE items SET pw_ct_b64=?, pw_nonce_b64=?, pw_fp=? WHERE id=?;";
+    sqlite3_stmt* st = nullptr;
+    if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) { db_rollback(); return false; }
+    sqlite3_bind_text(st, 1, new_ct_b64.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(st, 2, new_nonce_b64.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(st, 3, new_fp.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(st, 4, item_id.c_str(), -1, SQLITE_TRANSIENT);
+    int rc = sqlite3_step(st);
+    sqlite3_finalize(st);
+    if (rc != SQLITE_DONE) { db_rollback(); return false; }
+  }
+  if (!touch.commit()) { db_rollback(); return false; }
   return true;
 }
 
 static bool db_delete_item(const String& item_id) {
   if (!db_open()) return false;
   if (!db_begin()) return false;
+  IntegTouch touch(item_id);
   const char* sqlh = "DELETE FROM pw_history WHERE item_id=?;";
   sqlite3_stmt* sth = nullptr;
   if (sqlite3_prepare_v2(g_db, sqlh, -1, &sth, nullptr) != SQLITE_OK) { db_rollback(); return false; }
@@ -218,20 +247,23 @@ static bool db_delete_item(const String& item_id) {
   sqlite3_finalize(sti);
   if (rc != SQLITE_DONE) { db_rollback(); return false; }
 
-  if (!db_commit()) { db_rollback(); return false; }
+  if (!touch.commit()) { db_rollback(); return false; }
   return true;
 }
 
 static bool db_move_item(const String& item_id, int32_t new_category_id) {
   if (!db_open()) return false;
+  if (!db_begin()) return false;
+  IntegTouch touch(item_id);
   const char* sql = "UPDATE items SET category_id=? WHERE id=?;";
   sqlite3_stmt* st = nullptr;
-  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return false;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) { db_rollback(); return false; }
   sqlite3_bind_int(st, 1, new_category_id);
   sqlite3_bind_text(st, 2, item_id.c_str(), -1, SQLITE_TRANSIENT);
   int rc = sqlite3_step(st);
   sqlite3_finalize(st);
-  return rc == SQLITE_DONE;
+  if (rc != SQLITE_DONE || !touch.commit()) { db_rollback(); return false; }
+  return true;
 }
 
 static bool db_column_exists(const char* table, const char* col) {
@@ -250,10 +282,10 @@ static bool db_column_exists(const char* table, const char* col) {
 
 static bool db_upsert_category_meta(int32_t category_id, const String& plain_name) {
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
-  std::vector<uint8_t> aad;
-  make_category_field_aad(g_meta.db_uuid, category_id, "name", aad);
+  AadBuf aad;
+  if (!make_category_field_aad(category_id, "name", aad)) return false;
 
   String ct_b64, nonce_b64;
   if (!encrypt_string_meta_b64(aad, plain_name, ct_b64, nonce_b64)) return false;
@@ -295,10 +327,10 @@ static bool db_upsert_item_meta_label(const String& item_id,
 
 static bool db_upsert_item_meta_label_plain(const String& item_id, const String& plain_label) {
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) return false;
+  if (!keyring_loaded()) return false;
 
-  std::vector<uint8_t> aad;
-  make_item_label_aad(g_meta.db_uuid, item_id, aad);
+  AadBuf aad;
+  if (!make_item_label_aad(item_id, aad)) return false;
 
   String ct_b64, nonce_b64;
   if (!encrypt_string_meta_b64(aad, plain_label, ct_b64, nonce_b64)) return false;
@@ -308,13 +340,17 @@ static bool db_upsert_item_meta_label_plain(const String& item_id, const String&
 
 static bool db_migrate_encrypt_names_labels_if_needed(bool wipe_plaintext) {
   if (!db_open()) return false;
-  if (g_crypto.K_meta.size() != 32) {
+  if (!keyring_loaded()) {
     Serial.println("[MIG] K_meta missing (vault not unlocked?)");
     return false;
   }
 
   Serial.printf("[MIG] migrate encrypt names/labels wipe_plaintext=%d\n", (int)wipe_plaintext);
 
+  // A sealed vault was migrated before it was sealed. A row that still needs it was
+  // written off-device, so leave it for the integrity check instead of adopting it.
+  const bool sealed = integ_sealed();
+
   if (!db_begin()) return false;
 
   // 1) Categories: if category_meta missing/empty, encrypt categories.name into category_meta
@@ -338,7 +374,7 @@ static bool db_migrate_encrypt_names_labels_if_needed(bool wipe_plaintext) {
       String nonce = nonce_c ? String(nonce_c) : String();
 
       if (ct.length() && nonce.length()) continue;     // already migrated
-      if (!plain.length()) continue;                   // nothing to migrate
+      if (!plain.length() || sealed) continue;         // nothing to migrate
 
       if (!db_upsert_category_meta(cid, plain)) {
         sqlite3_finalize(st);
@@ -373,7 +409,7 @@ static bool db_migrate_encrypt_names_labels_if_needed(bool wipe_plaintext) {
       String nonce = nonce_c ? String(nonce_c) : String();
 
       if (ct.length() && nonce.length()) continue;     // already migrated
-      if (!plain.length()) continue;
+      if (!plain.length() || sealed) continue;
 
       if (!db_upsert_item_meta_label_plain(item_id, plain)) {
         sqlite3_finalize(st);
@@ -452,8 +488,12 @@ static void importFromExcelIfPresent() {
 
   size_t imported      = 0;
   size_t skipped       = 0;
+  size_t weak          = 0;   // supplied passwords under PP_STRENGTH_WARN_BELOW
+  size_t tooLong       = 0;   // passwords over PP_PASSWORD_MAX (also counted in skipped)
   bool   headerChecked = false;
   size_t lineNo        = 0;
+  PwEntropy entropy;  // shared by every auto-generated password in the file
+  IntegBatch integBatch;
 
   while (f.available()) {
     String line = f.readStringUntil('\n');
@@ -493,8 +533,20 @@ static void importFromExcelIfPresent() {
       continue;
     }
 
-    if (!pw.length()) {
-      pw = generatePassword(g_settings);  // auto-generate
+    // Password moves into the arena; the CSV line buffer is wiped below.
+    // Blank passwords are generated once the target category (and its policy) is known.
+    SecureString spw;
+    const bool pwLong = pw.length() > PP_PASSWORD_MAX;
+    bool pwOk = !pwLong && (!pw.length() || spw.assign(pw.c_str(), pw.length()));
+    secure_zero((void*)pw.c_str(), pw.length());
+    secure_zero((void*)line.c_str(), line.length());
+    if (!pwOk) {
+      if (pwLong) {
+        Serial.printf("[IMPORT] line %u: password over %u bytes, skipping row\n", (unsigned)lineNo, (unsigned)PP_PASSWORD_MAX);
+        tooLong++;
+      }
+      skipped++;
+      continue;
     }
 
     // Find or create category (case‑sensitive)
@@ -517,27 +569,40 @@ static void importFromExcelIfPresent() {
       Category c;
       c.name  = cat;
       c.db_id = newId;
+      c.items_loaded = true;
       g_vault.categories.push_back(c);
       targetCat = &g_vault.categories.back();
     }
 
     // Capacity check per category
+    if (!ensureCategoryLoaded(*targetCat)) {
+      Serial.println("[IMPORT] loadCategoryItems failed, skipping row");
+      skipped++;
+      continue;
+    }
     if (targetCat->items.size() >= MAX_PASSWORDS_PER_CATEGORY) {
       Serial.println("[IMPORT] Max passwords per category reached, skipping row");
       skipped++;
       continue;
     }
+    bool supplied = !spw.isEmpty();
+    if (!supplied && !pwgen_next(entropy, pwpolicy_for_category(*targetCat), spw)) {
+      Serial.println("[IMPORT] generate failed, skipping row");
+      skipped++;
+      continue;
+    }
 
     // Build PasswordItem with encrypted fields
     PasswordItem it;
     it.id = make_id_16();
 
-    if (!encrypt_label_password(label, pw, it.id,it.label_ct_b64, it.label_nonce_b64,it.pw_ct_b64, it.pw_nonce_b64)) {
+    if (!encrypt_label_password(label, spw, it.id,it.label_ct_b64, it.label_nonce_b64,it.pw_ct_b64, it.pw_nonce_b64)) {
       Serial.println("[IMPORT] encrypt_label_password failed");
       skipped++;
       continue;
     }
     it.label_plain = label;
+    password_fingerprint(spw, it.pw_fp);  // blank on failure; fp_index_backfill() fills it later
 
     if (!db_insert_item(targetCat->db_id, it)) {
       Serial.println("[IMPORT] db_insert_item failed");
@@ -547,6 +612,7 @@ static void importFromExcelIfPresent() {
 
     targetCat->items.push_back(it);
     imported++;
+    if (supplied && estimate_strength(spw).score < PP_STRENGTH_WARN_BELOW) weak++;
 
     if ((imported + skipped) % 10 == 0) {
       char buf[48];
@@ -571,7 +637,16 @@ static void importFromExcelIfPresent() {
   }
 
   char msg[64];
-  snprintf(msg, sizeof(msg), "Imported %u, skipped %u",
-           (unsigned)imported, (unsigned)skipped);
+  if (weak) {
+    snprintf(msg, sizeof(msg), "Imported %u, skipped %u, %u weak",
+             (unsigned)imported, (unsigned)skipped, (unsigned)weak);
+  } else {
+    snprintf(msg, sizeof(msg), "Imported %u, skipped %u",
+             (unsigned)imported, (unsigned)skipped);
+  }
   waitForButtonB("Import done", msg, "OK");
+  if (tooLong) {
+    snprintf(msg, sizeof(msg), "%u passwords over\n%u chars not imported", (unsigned)tooLong, (unsigned)PP_PASSWORD_MAX);
+    waitForButtonB("Import", msg, "OK");
+  }
 }
\ No newline at end of file
@@ -0,0 +1,420 @@
+//82_db_rekey.ino
+// ==== Vault-key rotation ====
+// rekey_begin() swaps in a fresh vault_key: meta gets new wraps/verifiers (new
+// recovery key), the old key wrapped under the new one, and rekey_phase=1.
+// rekey_run() then re-encrypts every ciphertext phase by phase. Each batch commits
+// together with its cursor, so after a power cut the next unlock picks up at the
+// first row that still holds old-key ciphertext.
+//
+// A cipher-suite change uses the same machinery: rekey_begin_suite() keeps the
+// vault_key, loads the old ring under the old suite and the active ring under
+// the new one, and rekey_run() moves every row across. With no new key there is
+// no wrap to store, so its rekey_prev_ct_b64 stays empty.
+
+enum class RekeyAad : uint8_t { ItemPassword, ItemLabel, CategoryName };
+
+struct RekeyPhase {
+  const char* label;
+  const char* count_sql;   // total rows in the phase
+  const char* done_sql;    // rows with key <= cursor
+  const char* select_sql;  // key, aad id, ct, nonce  WHERE key > ? ORDER BY key LIMIT ?
+  const char* update_sql;  // ct, nonce WHERE key = ?
+  bool        int_key;
+  RekeyAad    aad;
+  SubKey      sub;
+};
+
+static const RekeyPhase kRekeyPhases[] = {
+  { "Passwords",
+    "SELECT COUNT(*) FROM items;",
+    "SELECT COUNT(*) FROM items WHERE id<=?;",
+    "SELECT id, id, pw_ct_b64, pw_nonce_b64 FROM items WHERE id>? ORDER BY id LIMIT ?;",
+    "UPDATE items SET pw_ct_b64=?, pw_nonce_b64=? WHERE id=?;",
+    false, RekeyAad::ItemPassword, SubKey::Fields },
+  { "History",
+    "SELECT COUNT(*) FROM pw_history;",
+    "SELECT COUNT(*) FROM pw_history WHERE id<=?;",
+    "SELECT id, item_id, pw_ct_b64, pw_nonce_b64 FROM pw_history WHERE id>? ORDER BY id LIMIT ?;",
+    "UPDATE pw_history SET pw_ct_b64=?, pw_nonce_b64=? WHERE id=?;",
+    true, RekeyAad::ItemPassword, SubKey::Fields },
+  { "Labels",
+    "SELECT COUNT(*) FROM item_meta;",
+    "SELECT COUNT(*) FROM item_meta WHERE item_id<=?;",
+    "SELECT item_id, item_id, label_ct_b64, label_nonce_b64 FROM item_meta WHERE item_id>? ORDER BY item_id LIMIT ?;",
+    "UPDATE item_meta SET label_ct_b64=?, label_nonce_b64=? WHERE item_id=?;",
+    false, RekeyAad::ItemLabel, SubKey::Meta },
+  { "Categories",
+    "SELECT COUNT(*) FROM category_meta;",
+    "SELECT COUNT(*) FROM category_meta WHERE category_id<=?;",
+    "SELECT category_id, category_id, name_ct_b64, name_nonce_b64 FROM category_meta WHERE category_id>? ORDER BY category_id LIMIT ?;",
+    "UPDATE category_meta SET name_ct_b64=?, name_nonce_b64=? WHERE category_id=?;",
+    true, RekeyAad::CategoryName, SubKey::Meta },
+};
+static constexpr uint8_t REKEY_PHASE_COUNT = sizeof(kRekeyPhases) / sizeof(kRekeyPhases[0]);
+
+static const uint8_t kRekeyPrevAad[] = "rekey prev v1";
+
+static void rekey_bind_key(sqlite3_stmt* st, int idx, const RekeyPhase& ph, const char* key) {
+  if (ph.int_key) sqlite3_bind_int64(st, idx, (key && *key) ? (sqlite3_int64)atoll(key) : -1);
+  else sqlite3_bind_text(st, idx, key ? key : "", -1, SQLITE_TRANSIENT);
+}
+
+static bool rekey_make_aad(const RekeyPhase& ph, const char* id, AadBuf& aad) {
+  switch (ph.aad) {
+    case RekeyAad::ItemPassword: return make_item_field_aad(String(id), "password", aad);
+    case RekeyAad::ItemLabel:    return make_item_label_aad(String(id), aad);
+    case RekeyAad::CategoryName: return make_category_field_aad((int32_t)atol(id), "name", aad);
+  }
+  return false;
+}
+
+// Old ring -> plaintext -> new ring, fresh nonce, same AAD.
+static bool rekey_field(const RekeyPhase& ph, const AadBuf& aad,
+                        const char* ct_b64, const char* nonce_b64,
+                        String& out_ct_b64, String& out_nonce_b64) {
+  std::vector<uint8_t> ct, nonce;
+  if (!b64decode(String(ct_b64), ct) || !b64decode(String(nonce_b64), nonce) || nonce.size() != 12) return false;
+
+  SecureBuf plain;
+  if (!aead_decrypt(keyring_aead(g_crypto.rekey_prev, ph.sub), nonce.data(),
+                              aad.data(), aad.size(), ct.data(), ct.size(), plain.b)) return false;
+
+  uint8_t n2[12]; random_bytes(n2, sizeof(n2));
+  std::vector<uint8_t> ct2;
+  if (!aead_encrypt(keyring_aead(ph.sub), n2, aad.data(), aad.size(),
+                              plain.b.data(), plain.b.size(), ct2)) return false;
+
+  out_ct_b64 = b64encode(ct2.data(), ct2.size());
+  out_nonce_b64 = b64encode(n2, sizeof(n2));
+  return true;
+}
+
+static int rekey_count(const char* sql, const RekeyPhase* ph = nullptr, const char* cursor = nullptr) {
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return 0;
+  if (ph) rekey_bind_key(st, 1, *ph, cursor);
+  int n = (sqlite3_step(st) == SQLITE_ROW) ? sqlite3_column_int(st, 0) : 0;
+  sqlite3_finalize(st);
+  return n;
+}
+
+static bool rekey_save_marker(uint8_t phase, const String& cursor) {
+  const char* sql = "UPDATE meta SET rekey_phase=?, rekey_cursor=?;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return false;
+  sqlite3_bind_int(st, 1, (int)phase);
+  sqlite3_bind_text(st, 2, cursor.c_str(), -1, SQLITE_TRANSIENT);
+  int rc = sqlite3_step(st);
+  sqlite3_finalize(st);
+  return rc == SQLITE_DONE;
+}
+
+// One transaction: up to PP_REKEY_BATCH_ROWS rows of the current phase plus the new marker.
+static bool rekey_batch(uint32_t& io_done) {
+  const RekeyPhase& ph = kRekeyPhases[g_meta.rekey_phase - 1];
+
+  if (!db_begin()) return false;
+
+  sqlite3_stmt* sel = nullptr;
+  sqlite3_stmt* upd = nullptr;
+  if (sqlite3_prepare_v2(g_db, ph.select_sql, -1, &sel, nullptr) != SQLITE_OK ||
+      sqlite3_prepare_v2(g_db, ph.update_sql, -1, &upd, nullptr) != SQLITE_OK) {
+    if (sel) sqlite3_finalize(sel);
+    db_rollback();
+    return false;
+  }
+  rekey_bind_key(sel, 1, ph, g_meta.rekey_cursor.c_str());
+  sqlite3_bind_int(sel, 2, PP_REKEY_BATCH_ROWS);
+
+  String cursor = g_meta.rekey_cursor;
+  int rows = 0;
+  bool ok = true;
+  while (ok && sqlite3_step(sel) == SQLITE_ROW) {
+    const char* key   = (const char*)sqlite3_column_text(sel, 0);
+    const char* id    = (const char*)sqlite3_column_text(sel, 1);
+    const char* ct    = (const char*)sqlite3_column_text(sel, 2);
+    const char* nonce = (const char*)sqlite3_column_text(sel, 3);
+    rows++;
+    if (!key) {
+      // No cursor to move past it: skipping would end the phase early with rows left behind.
+      Serial.printf("[REKEY] %s: row without a key\n", ph.label);
+      ok = false;
+      break;
+    }
+    cursor = key;
+
+    AadBuf aad;
+    String ct2, nonce2;
+    if (!id || !ct || !nonce || !rekey_make_aad(ph, id, aad) ||
+        !rekey_field(ph, aad, ct, nonce, ct2, nonce2)) {
+      // Unreadable under the old key: leave the row as it is rather than stall the rotation.
+      Serial.printf("[REKEY] %s %s: not re-encrypted\n", ph.label, key);
+      continue;
+    }
+
+    sqlite3_reset(upd);
+    sqlite3_bind_text(upd, 1, ct2.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(upd, 2, nonce2.c_str(), -1, SQLITE_TRANSIENT);
+    rekey_bind_key(upd, 3, ph, key);
+    ok = sqlite3_step(upd) == SQLITE_DONE;
+  }
+  sqlite3_finalize(sel);
+  sqlite3_finalize(upd);
+
+  uint8_t nextPhase = g_meta.rekey_phase;
+  if (rows < PP_REKEY_BATCH_ROWS) { nextPhase++; cursor = ""; }
+
+  if (!ok || !rekey_save_marker(nextPhase, cursor) || !db_commit()) {
+    db_rollback();
+    return false;
+  }
+
+  g_meta.rekey_phase = nextPhase;
+  g_meta.rekey_cursor = cursor;
+  io_done += (uint32_t)rows;
+  return true;
+}
+
+static bool rekey_finish() {
+  const bool keyChanged = memcmp(g_crypto.rekey_prev.vault_key, g_crypto.keys.vault_key, 32) != 0;
+  if (!db_begin()) return false;
+  if (!db_exec("UPDATE meta SET rekey_phase=0, rekey_cursor='', rekey_prev_ct_b64='', rekey_prev_nonce_b64='';")) {
+    db_rollback(); return false;
+  }
+  if (keyChanged && !fp_index_invalidate()) { db_rollback(); return false; }
+  if (!integ_invalidate()) { db_rollback(); return false; }
+  if (!db_commit()) { db_rollback(); return false; }
+
+  g_meta.rekey_phase = 0;
+  g_meta.rekey_cursor = "";
+  g_meta.rekey_prev_ct_b64 = "";
+  g_meta.rekey_prev_nonce_b64 = "";
+  g_meta.integ_root = "";
+  keyring_wipe(g_crypto.rekey_prev);
+  Serial.println("[REKEY] rotation complete");
+  return true;
+}
+
+static bool rekey_run() {
+  if (!g_meta.rekey_phase) return true;
+  if (!db_open() || !keyring_loaded() || !g_crypto.rekey_prev.loaded) return false;
+
+  // Progress covers the whole rotation, including rows done before a restart.
+  uint32_t total = 0, done = 0;
+  for (uint8_t i = 0; i < REKEY_PHASE_COUNT; ++i) {
+    uint32_t n = (uint32_t)rekey_count(kRekeyPhases[i].count_sql);
+    total += n;
+    if (i + 1 < g_meta.rekey_phase) done += n;
+  }
+  if (g_meta.rekey_phase <= REKEY_PHASE_COUNT && g_meta.rekey_cursor.length()) {
+    const RekeyPhase& ph = kRekeyPhases[g_meta.rekey_phase - 1];
+    done += (uint32_t)rekey_count(ph.done_sql, &ph, g_meta.rekey_cursor.c_str());
+  }
+
+  g_loading_last_pm = -1;
+  uint8_t shownPhase = 0;
+  while (g_meta.rekey_phase && g_meta.rekey_phase <= REKEY_PHASE_COUNT) {
+    if (shownPhase != g_meta.rekey_phase) {
+      shownPhase = g_meta.rekey_phase;
+      updateLoading(kRekeyPhases[shownPhase - 1].label);
+      g_loading_last_pm = -1;
+    }
+    if (!rekey_batch(done)) {
+      Serial.printf("[REKEY] batch failed in phase %u\n", (unsigned)g_meta.rekey_phase);
+      return false;
+    }
+    drawLoadingProgress(done, total);
+    touchActivity();
+    delay(1);
+  }
+  return rekey_finish();
+}
+
+static bool rekey_begin(const String& pin, String& out_recovery_key_b64) {
+  Serial.println("[REKEY] rekey_begin");
+  if (!keyring_loaded() || g_meta.rekey_phase) return false;
+
+  String rkey = generate_recovery_key_b64();
+  SecureBuf Wn, Wr;
+  {
+    KdfProgressScope progress(loadingKdfProgress);
+    if (!derive_W_pair(pin, pin + rkey, g_meta.kdf_salt1, g_meta.kdf_salt2, g_meta.kdf_iters, Wn.b, Wr.b)) return false;
+  }
+  updateLoading("Writing new key...");
+
+  Meta saved = g_meta;
+  if (!keyring_load(g_crypto.rekey_prev, keyring_vault_key(), g_crypto.keys.suite)) return false;
+  if (!keyring_generate()) {
+    keyring_load(g_crypto.rekey_prev.vault_key);
+    keyring_wipe(g_crypto.rekey_prev);
+    return false;
+  }
+
+  uint8_t nonce[12]; random_bytes(nonce, sizeof(nonce));
+  std::vector<uint8_t> prevCt;
+  bool ok = aes256_gcm_encrypt(keyring_vault_key(), nonce, kRekeyPrevAad, sizeof(kRekeyPrevAad) - 1,
+                               g_crypto.rekey_prev.vault_key, 32, prevCt) &&
+            make_verifier(Wn.b, g_meta.verifier_normal_b64) &&
+            make_verifier(Wr.b, g_meta.verifier_recovery_b64) &&
+            wrap_vault_key(Wn.b, keyring_vault_key(), g_meta.vault_wrap_normal_ct_b64, g_meta.vault_wrap_normal_nonce_b64) &&
+            wrap_vault_key(Wr.b, keyring_vault_key(), g_meta.vault_wrap_recovery_ct_b64, g_meta.vault_wrap_recovery_nonce_b64);
+  if (ok) {
+    g_meta.rekey_prev_ct_b64 = b64encode(prevCt.data(), prevCt.size());
+    g_meta.rekey_prev_nonce_b64 = b64encode(nonce, sizeof(nonce));
+    g_meta.rekey_prev_suite = (uint8_t)g_crypto.rekey_prev.suite;
+    g_meta.rekey_phase = 1;
+    g_meta.rekey_cursor = "";
+    integ_unseal_for_rekey();
+    ok = saveMeta();
+  }
+  if (!ok) {
+    Serial.println("[REKEY] could not commit new key; keeping the old one");
+    g_meta = saved;
+    keyring_load(g_crypto.rekey_prev.vault_key);
+    keyring_wipe(g_crypto.rekey_prev);
+    return false;
+  }
+
+  out_recovery_key_b64 = rkey;
+  return true;
+}
+
+// Same vault_key, new AEAD. Wraps, verifiers and the recovery key are untouched.
+static bool rekey_begin_suite(CipherSuite suite) {
+  Serial.printf("[REKEY] rekey_begin_suite %s\n", cipher_suite_name((uint8_t)suite));
+  if (!keyring_loaded() || g_meta.rekey_phase || suite == g_crypto.keys.suite) return false;
+
+  Meta saved = g_meta;
+  const CipherSuite old = g_crypto.keys.suite;
+  if (!keyring_load(g_crypto.rekey_prev, keyring_vault_key(), old)) return false;
+  if (!keyring_load(g_crypto.keys, g_crypto.rekey_prev.vault_key, suite)) {
+    keyring_wipe(g_crypto.rekey_prev);
+    return false;
+  }
+
+  // The old key is the active one, so there is nothing to wrap: an empty
+  // rekey_prev_ct_b64 tells resume to reuse the vault_key under the old suite.
+  g_meta.rekey_prev_ct_b64 = "";
+  g_meta.rekey_prev_nonce_b64 = "";
+  g_meta.rekey_prev_suite = (uint8_t)old;
+  g_meta.cipher_suite = (uint8_t)suite;
+  g_meta.rekey_phase = 1;
+  g_meta.rekey_cursor = "";
+  integ_unseal_for_rekey();
+  if (!saveMeta()) {
+    Serial.println("[REKEY] could not switch suite; keeping the old one");
+    g_meta = saved;
+    keyring_load(g_crypto.keys, g_crypto.rekey_prev.vault_key, old);
+    keyring_wipe(g_crypto.rekey_prev);
+    return false;
+  }
+  return true;
+}
+
+// Called right after unlock/recovery, before anything reads item ciphertext.
+static bool rekey_resume_if_pending() {
+  if (!g_meta.rekey_phase) return true;
+  Serial.printf("[REKEY] resuming at phase %u cursor '%s'\n", (unsigned)g_meta.rekey_phase, g_meta.rekey_cursor.c_str());
+
+  if (!g_crypto.rekey_prev.loaded) {
+    // A suite switch stores no wrap: the old ring is the active vault_key.
+    const uint8_t* prevKey = keyring_vault_key();
+    SecureBuf prev;
+    if (g_meta.rekey_prev_ct_b64.length()) {
+      std::vector<uint8_t> ct, nonce;
+      if (!b64decode(g_meta.rekey_prev_ct_b64, ct) || !b64decode(g_meta.rekey_prev_nonce_b64, nonce) || nonce.size() != 12) return false;
+      if (!aes256_gcm_decrypt(keyring_vault_key(), nonce.data(), kRekeyPrevAad, sizeof(kRekeyPrevAad) - 1,
+                              ct.data(), ct.size(), prev.b) || prev.b.size() != 32) {
+        Serial.println("[REKEY] previous key unwrap failed");
+        return false;
+      }
+      prevKey = prev.b.data();
+    }
+    if (!keyring_load(g_crypto.rekey_prev, prevKey, (CipherSuite)g_meta.rekey_prev_suite)) return false;
+  }
+
+  LoadingScope loading("LOADING", "Resuming key rotation...");
+  return rekey_run();
+}
+
+static void settingsRotateVaultKey() {
+  String pin;
+  if (!auth_with_current_pin_get(pin)) return;
+
+  String confirm = runTextInput("Rotate Key", "Type ROT", 3, TextInputUI::InputMode::STANDARD, false);
+  confirm.trim();
+  if (confirm != "ROT") return;
+
+  String rkey;
+  {
+    LoadingScope loading("ROTATE", "Deriving key (BACK=stop)");
+    if (!rekey_begin(pin, rkey)) {
+      waitForButtonB("Error", kdf_was_canceled() ? "Canceled" : "Rotate failed", "OK");
+      return;
+    }
+  }
+
+  // The new wraps are live from here on, so the new recovery key must be shown now.
+  showRecoveryKeyOnce(rkey);
+
+  bool ok;
+  {
+    LoadingScope loading("ROTATE", "Re-encrypting...");
+    ok = rekey_run();
+  }
+  if (!ok) {
+    // Part of the vault is already on the new key; drop the copies read before.
+    loadItems();
+    refreshDecryptedItemNames();
+    waitForButtonB("Error", "Rotation paused,\nresumes at unlock", "OK");
+    return;
+  }
+
+  fp_index_backfill();
+  integ_seal_if_needed();
+  loadItems();
+  refreshDecryptedItemNames();
+  waitForButtonB("Info", "Vault key rotated", "OK");
+}
+
+static void settingsCipherSuite() {
+  uint32_t kbps[2];
+  {
+    LoadingScope loading("CIPHER", "Benchmarking...");
+    kbps[0] = aead_benchmark_kbps(CipherSuite::AesGcm);
+    kbps[1] = aead_benchmark_kbps(CipherSuite::ChaChaPoly);
+  }
+  Serial.printf("[CIPHER] AES-GCM %u KiB/s, ChaCha20-Poly1305 %u KiB/s\n", (unsigned)kbps[0], (unsigned)kbps[1]);
+
+  const uint8_t cur = g_meta.cipher_suite;
+  static char labels[2][32];
+  snprintf(labels[0], sizeof(labels[0]), "%sAES-GCM %u KB/s",  cur == (uint8_t)CipherSuite::AesGcm ? "* " : "", (unsigned)kbps[0]);
+  snprintf(labels[1], sizeof(labels[1]), "%sCHACHA %u KB/s",   cur == (uint8_t)CipherSuite::ChaChaPoly ? "* " : "", (unsigned)kbps[1]);
+  const char* items[] = { labels[0], labels[1], "[ CANCEL ]" };
+  uint8_t choice = promptChoice("Cipher Suite", "Encrypt speed", items, 3, cur - 1);
+  if (choice >= 2) return;
+  CipherSuite suite = choice == 0 ? CipherSuite::AesGcm : CipherSuite::ChaChaPoly;
+  if ((uint8_t)suite == cur) return;
+
+  String pin;
+  if (!auth_with_current_pin_get(pin)) return;
+
+  bool ok;
+  {
+    LoadingScope loading("CIPHER", "Re-encrypting...");
+    ok = rekey_begin_suite(suite) && rekey_run();
+  }
+  if (!ok) {
+    if (g_meta.rekey_phase) {
+      loadItems();
+      refreshDecryptedItemNames();
+    }
+    waitForButtonB("Error", g_meta.rekey_phase ? "Switch paused,\nresumes at unlock" : "Switch failed", "OK");
+    return;
+  }
+  integ_seal_if_needed();
+
+  loadItems();
+  refreshDecryptedItemNames();
+  waitForButtonB("Info", cipher_suite_name((uint8_t)suite), "OK");
+}
@@ -0,0 +1,172 @@
+//83_db_reuse.ino
+// ==== Password-reuse index ====
+// items.pw_fp / pw_history.pw_fp hold password_fingerprint() of each current and
+// archived password. The CRUD layer writes them with the ciphertext; this file
+// fills rows that have none yet (vaults from before the index, or after a
+// vault-key rotation) and answers the audit straight from the index.
+
+static const char* const kFpMissingSql[] = {
+  "SELECT id, id, pw_ct_b64, pw_nonce_b64 FROM items WHERE COALESCE(pw_fp,'')='' LIMIT ?;",
+  "SELECT CAST(id AS TEXT), item_id, pw_ct_b64, pw_nonce_b64 FROM pw_history WHERE COALESCE(pw_fp,'')='' LIMIT ?;",
+};
+static const char* const kFpUpdateSql[] = {
+  "UPDATE items SET pw_fp=? WHERE id=?;",
+  "UPDATE pw_history SET pw_fp=? WHERE id=CAST(? AS INTEGER);",
+};
+
+// Rows that cannot be decrypted get this marker so the backfill does not retry them forever.
+static const char kFpUnreadable[] = "-";
+
+static int fp_missing_count() {
+  const char* sql =
+    "SELECT (SELECT COUNT(*) FROM items WHERE COALESCE(pw_fp,'')='') + "
+    "(SELECT COUNT(*) FROM pw_history WHERE COALESCE(pw_fp,'')='');";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return -1;
+  int n = (sqlite3_step(st) == SQLITE_ROW) ? sqlite3_column_int(st, 0) : -1;
+  sqlite3_finalize(st);
+  return n;
+}
+
+// One transaction of up to PP_REKEY_BATCH_ROWS rows from table t. Returns rows handled, -1 on error.
+static int fp_backfill_batch(uint8_t t) {
+  if (!db_begin()) return -1;
+  sqlite3_stmt* sel = nullptr;
+  sqlite3_stmt* upd = nullptr;
+  if (sqlite3_prepare_v2(g_db, kFpMissingSql[t], -1, &sel, nullptr) != SQLITE_OK ||
+      sqlite3_prepare_v2(g_db, kFpUpdateSql[t], -1, &upd, nullptr) != SQLITE_OK) {
+    if (sel) sqlite3_finalize(sel);
+    db_rollback();
+    return -1;
+  }
+  sqlite3_bind_int(sel, 1, PP_REKEY_BATCH_ROWS);
+
+  int rows = 0;
+  bool ok = true;
+  while (ok && sqlite3_step(sel) == SQLITE_ROW) {
+    const char* key    = (const char*)sqlite3_column_text(sel, 0);
+    const char* itemId = (const char*)sqlite3_column_text(sel, 1);
+    const char* ct     = (const char*)sqlite3_column_text(sel, 2);
+    const char* nonce  = (const char*)sqlite3_column_text(sel, 3);
+    if (!key) continue;
+    rows++;
+
+    String fp;
+    SecureString pw;
+    if (!itemId || !ct || !nonce ||
+        !decrypt_password_ct(String(ct), String(nonce), String(itemId), pw) ||
+        !password_fingerprint(pw, fp)) {
+      Serial.printf("[REUSE] %s: not indexed\n", key);
+      fp = kFpUnreadable;
+    }
+
+    sqlite3_reset(upd);
+    sqlite3_bind_text(upd, 1, fp.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(upd, 2, key, -1, SQLITE_TRANSIENT);
+    ok = sqlite3_step(upd) == SQLITE_DONE;
+  }
+  sqlite3_finalize(sel);
+  sqlite3_finalize(upd);
+
+  if (!ok || !db_commit()) { db_rollback(); return -1; }
+  return rows;
+}
+
+// Decrypts only rows without a fingerprint, so after the first run this is a COUNT(*) and nothing else.
+static bool fp_index_backfill() {
+  if (!db_open() || !keyring_loaded()) return false;
+  int missing = fp_missing_count();
+  if (missing <= 0) return missing == 0;
+
+  Serial.printf("[REUSE] indexing %d passwords\n", missing);
+  LoadingScope loading("LOADING", "Indexing passwords...");
+  g_loading_last_pm = -1;
+  uint32_t done = 0;
+  for (uint8_t t = 0; t < 2; ++t) {
+    while (true) {
+      int n = fp_backfill_batch(t);
+      if (n < 0) return false;
+      done += (uint32_t)n;
+      drawLoadingProgress(done, (uint32_t)missing);
+      touchActivity();
+      delay(1);
+      if (n < PP_REKEY_BATCH_ROWS) break;
+    }
+  }
+  return true;
+}
+
+// Fingerprints are keyed by the vault key; call inside the transaction that retires it.
+static bool fp_index_invalidate() {
+  return db_exec("UPDATE items SET pw_fp='';") && db_exec("UPDATE pw_history SET pw_fp='';");
+}
+
+// ==== Reuse audit ====
+static String reuse_entry_label(int32_t cat_id, const String& item_id) {
+  for (auto& c : g_vault.categories) {
+    if (c.db_id != cat_id) continue;
+    if (!ensureCategoryLoaded(c)) break;
+    for (auto& it : c.items) {
+      if (it.id == item_id) return c.name + " / " + (it.label_plain.length() ? it.label_plain : String("<unnamed>"));
+    }
+    return c.name + " / ?";
+  }
+  return String("?");
+}
+
+static void settingsReuseAudit() {
+  if (!db_open() || !keyring_loaded()) return;
+  if (!fp_index_backfill()) {
+    waitForButtonB("Error", "Index update failed", "OK");
+    return;
+  }
+
+  // Every current/archived entry whose fingerprint occurs more than once, grouped by fingerprint.
+  const char* sql =
+    "WITH e AS ("
+      "SELECT pw_fp AS fp, 0 AS archived, id AS item_id, category_id FROM items "
+      "UNION ALL "
+      "SELECT h.pw_fp, 1, h.item_id, i.category_id FROM pw_history h JOIN items i ON i.id = h.item_id"
+    ") "
+    "SELECT fp, archived, item_id, category_id FROM e "
+    "WHERE fp IN (SELECT fp FROM e WHERE fp <> '' AND fp <> ? GROUP BY fp HAVING COUNT(*) > 1) "
+    "ORDER BY fp, archived;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) {
+    waitForButtonB("Error", "Audit query failed", "OK");
+    return;
+  }
+  sqlite3_bind_text(st, 1, kFpUnreadable, -1, SQLITE_STATIC);
+
+  String report;
+  String lastFp;
+  uint32_t groups = 0;
+  {
+    LoadingScope loading("AUDIT", "Reading index...");
+    while (sqlite3_step(st) == SQLITE_ROW) {
+      const char* fp_c = (const char*)sqlite3_column_text(st, 0);
+      bool archived    = sqlite3_column_int(st, 1) != 0;
+      const char* id_c = (const char*)sqlite3_column_text(st, 2);
+      int32_t cat_id   = (int32_t)sqlite3_column_int(st, 3);
+      if (!fp_c || !id_c) continue;
+
+      if (lastFp != fp_c) {
+        lastFp = fp_c;
+        groups++;
+        report += "Group " + String(groups) + ":\n";
+      }
+      report += "- " + reuse_entry_label(cat_id, String(id_c));
+      if (archived) report += " (archived)";
+      report += "\n";
+    }
+  }
+  sqlite3_finalize(st);
+
+  if (!groups) {
+    waitForButtonB("Reuse Audit", "No reused passwords", "OK");
+    return;
+  }
+  char sub[32];
+  snprintf(sub, sizeof(sub), "%u reused", (unsigned)groups);
+  menu.showInfoModal("Reuse Audit", sub, report, "[ BACK ]", 21, false);
+}
@@ -0,0 +1,448 @@
+//84_db_integrity.ino
+// ==== Vault integrity tree ====
+// Each category and item is a leaf: HMAC(K_integ) over its stored ciphertext
+// (an item's leaf also covers its archived passwords). Leaves are XOR-folded
+// into PP_INTEG_BUCKETS digests in the `integrity` table, and meta.integ_root
+// MACs (generation, buckets). A CRUD change re-hashes one leaf and rewrites one
+// bucket, so unlock only has to check the root against the buckets and against
+// the newest (gen, root) kept in NVS - the part an old copy of vault.db on the
+// card cannot bring back. Leaves are re-hashed against the buckets in small
+// slices while the main menu is idle.
+
+static constexpr uint8_t INTEG_BUCKETS = PP_INTEG_BUCKETS;
+
+enum class IntegStatus : uint8_t { Ok, Unsealed, Mismatch, RolledBack };
+
+// Root staged by the open transaction; published to g_meta/NVS after it commits.
+static uint32_t g_integ_staged_gen = 0;
+static String   g_integ_staged_root;
+static uint8_t  g_integ_batch = 0;
+
+// ---- Leaf MAC ----
+// Fields are length-prefixed so adjacent values cannot be shifted into each other.
+struct IntegMac {
+  mbedtls_md_context_t ctx;
+  bool ok = false;
+  explicit IntegMac(const char* domain) {
+    mbedtls_md_init(&ctx);
+    const uint8_t* k = keyring_subkey(SubKey::Integrity);
+    const mbedtls_md_info_t* md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    ok = k && md && mbedtls_md_setup(&ctx, md, 1) == 0 && mbedtls_md_hmac_starts(&ctx, k, 32) == 0;
+    put(domain);
+  }
+  ~IntegMac() { mbedtls_md_free(&ctx); }
+  void put(const void* p, size_t n) {
+    uint8_t len[2] = { (uint8_t)(n >> 8), (uint8_t)n };
+    ok = ok && mbedtls_md_hmac_update(&ctx, len, 2) == 0 && (!n || mbedtls_md_hmac_update(&ctx, (const uint8_t*)p, n) == 0);
+  }
+  void put(const char* s) { put(s, s ? strlen(s) : 0); }
+  void put_col(sqlite3_stmt* st, int col) {
+    put((const char*)sqlite3_column_text(st, col), (size_t)sqlite3_column_bytes(st, col));
+  }
+  void put_int(int64_t v) {
+    uint8_t b[8];
+    for (int i = 0; i < 8; ++i) b[i] = (uint8_t)(v >> (56 - 8 * i));
+    put(b, sizeof(b));
+  }
+  bool finish(uint8_t out[32]) { return ok && mbedtls_md_hmac_finish(&ctx, out) == 0; }
+};
+
+// present=false (and out all-zero, the XOR identity) when the row does not exist.
+static bool integ_leaf_item(const char* id, uint8_t out[32], bool& present) {
+  memset(out, 0, 32);
+  present = false;
+  const char* sql =
+    "SELECT i.category_id, i.pw_ct_b64, i.pw_nonce_b64, "
+    "COALESCE(m.label_ct_b64,''), COALESCE(m.label_nonce_b64,'') "
+    "FROM items i LEFT JOIN item_meta m ON m.item_id = i.id WHERE i.id=?;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return false;
+  sqlite3_bind_text(st, 1, id, -1, SQLITE_TRANSIENT);
+  int rc = sqlite3_step(st);
+  if (rc != SQLITE_ROW) { sqlite3_finalize(st); return rc == SQLITE_DONE; }
+
+  IntegMac mac("item v1");
+  mac.put(id);
+  mac.put_int(sqlite3_column_int64(st, 0));
+  for (int c = 1; c <= 4; ++c) mac.put_col(st, c);
+  sqlite3_finalize(st);
+
+  const char* hsql = "SELECT pw_ct_b64, pw_nonce_b64, ts FROM pw_history WHERE item_id=? ORDER BY id;";
+  if (sqlite3_prepare_v2(g_db, hsql, -1, &st, nullptr) != SQLITE_OK) return false;
+  sqlite3_bind_text(st, 1, id, -1, SQLITE_TRANSIENT);
+  while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+    mac.put_col(st, 0);
+    mac.put_col(st, 1);
+    mac.put_int(sqlite3_column_int64(st, 2));
+  }
+  sqlite3_finalize(st);
+  if (rc != SQLITE_DONE) return false;
+
+  present = true;
+  return mac.finish(out);
+}
+
+static bool integ_leaf_category(int32_t id, uint8_t out[32], bool& present) {
+  memset(out, 0, 32);
+  present = false;
+  const char* sql =
+    "SELECT COALESCE(c.pw_policy,0), COALESCE(m.name_ct_b64,''), COALESCE(m.name_nonce_b64,'') "
+    "FROM categories c LEFT JOIN category_meta m ON m.category_id = c.id WHERE c.id=?;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return false;
+  sqlite3_bind_int(st, 1, id);
+  int rc = sqlite3_step(st);
+  if (rc != SQLITE_ROW) { sqlite3_finalize(st); return rc == SQLITE_DONE; }
+
+  IntegMac mac("category v1");
+  mac.put_int(id);
+  mac.put_int(sqlite3_column_int64(st, 0));
+  mac.put_col(st, 1);
+  mac.put_col(st, 2);
+  sqlite3_finalize(st);
+
+  present = true;
+  return mac.finish(out);
+}
+
+// Bucket from the leaf's identity (not its contents), so a leaf never moves between buckets.
+static uint8_t integ_bucket_item(const char* id) {
+  uint32_t h = 2166136261u;
+  for (const char* p = id; *p; ++p) h = (h ^ (uint8_t)*p) * 16777619u;
+  return (uint8_t)(h % INTEG_BUCKETS);
+}
+static uint8_t integ_bucket_category(int32_t id) {
+  return (uint8_t)((uint32_t)id % INTEG_BUCKETS);
+}
+
+static void integ_xor(uint8_t acc[32], const uint8_t leaf[32]) {
+  for (int i = 0; i < 32; ++i) acc[i] ^= leaf[i];
+}
+
+// ---- Buckets and root ----
+static bool integ_load_buckets(uint8_t b[][32]) {
+  memset(b, 0, (size_t)INTEG_BUCKETS * 32);
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, "SELECT bucket, digest FROM integrity;", -1, &st, nullptr) != SQLITE_OK) return false;
+  int rc;
+  while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+    int i = sqlite3_column_int(st, 0);
+    const void* d = sqlite3_column_blob(st, 1);
+    if (i >= 0 && i < INTEG_BUCKETS && d && sqlite3_column_bytes(st, 1) == 32) memcpy(b[i], d, 32);
+  }
+  sqlite3_finalize(st);
+  return rc == SQLITE_DONE;
+}
+
+static bool integ_store_bucket(uint8_t i, const uint8_t d[32]) {
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, "INSERT OR REPLACE INTO integrity(bucket, digest) VALUES(?, ?);", -1, &st, nullptr) != SQLITE_OK) return false;
+  sqlite3_bind_int(st, 1, i);
+  sqlite3_bind_blob(st, 2, d, 32, SQLITE_TRANSIENT);
+  int rc = sqlite3_step(st);
+  sqlite3_finalize(st);
+  return rc == SQLITE_DONE;
+}
+
+static bool integ_root_hex(uint32_t gen, const uint8_t b[][32], String& out_hex) {
+  IntegMac mac("root v1");
+  mac.put(g_meta.db_uuid.c_str(), g_meta.db_uuid.length());
+  mac.put_int(gen);
+  mac.put(b, (size_t)INTEG_BUCKETS * 32);
+  uint8_t root[32];
+  if (!mac.finish(root)) return false;
+  char hex[65];
+  for (int i = 0; i < 32; ++i) sprintf(&hex[i * 2], "%02x", root[i]);
+  out_hex = hex;
+  return true;
+}
+
+// Inside the open transaction: new generation and root over the current buckets.
+static bool integ_stage_root(uint32_t gen) {
+  uint8_t b[INTEG_BUCKETS][32];
+  String root;
+  if (!integ_load_buckets(b) || !integ_root_hex(gen, b, root)) return false;
+
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, "UPDATE meta SET integ_gen=?, integ_root=?;", -1, &st, nullptr) != SQLITE_OK) return false;
+  sqlite3_bind_int64(st, 1, (sqlite3_int64)gen);
+  sqlite3_bind_text(st, 2, root.c_str(), -1, SQLITE_TRANSIENT);
+  int rc = sqlite3_step(st);
+  sqlite3_finalize(st);
+  if (rc != SQLITE_DONE) return false;
+
+  g_integ_staged_gen = gen;
+  g_integ_staged_root = root;
+  return true;
+}
+
+// ---- NVS high-water mark ----
+// present=false: nothing recorded for this vault, or the device itself invalidated it.
+struct IntegNvs {
+  bool     present = false;
+  uint32_t gen = 0;
+  String   root;
+};
+
+static IntegNvs integ_nvs_read() {
+  IntegNvs n;
+  if (!g_prefs.begin(INTEG_NS, true, MSC_PART)) return n;
+  if (g_prefs.getString(INTEG_UUID_KEY, "") == g_meta.db_uuid) {
+    n.gen = g_prefs.getUInt(INTEG_GEN_KEY, 0);
+    n.root = g_prefs.getString(INTEG_ROOT_KEY, "");
+    n.present = n.root.length() > 0;
+  }
+  g_prefs.end();
+  return n;
+}
+
+static void integ_nvs_write(const String& root) {
+  if (!g_prefs.begin(INTEG_NS, false, MSC_PART)) {
+    Serial.println("[INTEG] NVS open failed");
+    return;
+  }
+  g_prefs.putString(INTEG_UUID_KEY, g_meta.db_uuid);
+  g_prefs.putUInt(INTEG_GEN_KEY, g_meta.integ_gen);
+  g_prefs.putString(INTEG_ROOT_KEY, root);
+  g_prefs.end();
+}
+
+// After the transaction that staged a root has committed.
+static void integ_publish() {
+  g_meta.integ_gen = g_integ_staged_gen;
+  g_meta.integ_root = g_integ_staged_root;
+  if (!g_integ_batch) integ_nvs_write(g_meta.integ_root);
+}
+
+IntegBatch::IntegBatch() { g_integ_batch++; }
+IntegBatch::~IntegBatch() {
+  if (g_integ_batch && !--g_integ_batch && integ_sealed()) integ_nvs_write(g_meta.integ_root);
+}
+
+static bool integ_sealed() {
+  return g_meta.integ_root.length() > 0 && keyring_loaded();
+}
+
+// ---- Incremental update (CRUD) ----
+// Mid-rotation the buckets no longer describe the rows, so there is nothing to update.
+IntegTouch::IntegTouch(const String& item_id) : item_(item_id) {
+  active_ = integ_sealed() && !g_meta.rekey_phase;
+  if (active_) ok_ = leaf(before_);
+}
+
+IntegTouch::IntegTouch(int32_t category_id, bool is_new) : cat_(category_id) {
+  active_ = integ_sealed() && !g_meta.rekey_phase;
+  if (active_ && !is_new) ok_ = leaf(before_);
+}
+
+bool IntegTouch::leaf(uint8_t out[32]) {
+  bool present;
+  return item_.length() ? integ_leaf_item(item_.c_str(), out, present)
+                        : integ_leaf_category(cat_, out, present);
+}
+
+bool IntegTouch::commit() {
+  if (!ok_) return false;
+  if (active_) {
+    uint8_t after[32];
+    uint8_t b[INTEG_BUCKETS][32];
+    uint8_t bi = item_.length() ? integ_bucket_item(item_.c_str()) : integ_bucket_category(cat_);
+    if (!leaf(after) || !integ_load_buckets(b)) return false;
+    integ_xor(b[bi], before_);
+    integ_xor(b[bi], after);
+    if (!integ_store_bucket(bi, b[bi]) || !integ_stage_root(g_meta.integ_gen + 1)) return false;
+  }
+  if (!db_commit()) return false;
+  if (active_) integ_publish();
+  return true;
+}
+
+// ---- Full pass ----
+// Folds up to `limit` leaves after `cursor` (phase 0 categories, 1 items) into acc.
+// Returns leaves folded, -1 on error; fewer than `limit` means the phase is done.
+static int integ_fold_batch(uint8_t phase, String& cursor, uint8_t acc[][32], int limit) {
+  const char* sql = phase == 0
+    ? "SELECT CAST(id AS TEXT) FROM categories WHERE id > ? ORDER BY id LIMIT ?;"
+    : "SELECT id FROM items WHERE id > ? ORDER BY id LIMIT ?;";
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, sql, -1, &st, nullptr) != SQLITE_OK) return -1;
+  if (phase == 0) sqlite3_bind_int(st, 1, cursor.toInt());
+  else            sqlite3_bind_text(st, 1, cursor.c_str(), -1, SQLITE_TRANSIENT);
+  sqlite3_bind_int(st, 2, limit);
+  std::vector<String> ids;
+  int rc;
+  while ((rc = sqlite3_step(st)) == SQLITE_ROW) {
+    const char* id = (const char*)sqlite3_column_text(st, 0);
+    if (id) ids.push_back(String(id));
+  }
+  sqlite3_finalize(st);
+  if (rc != SQLITE_DONE) return -1;
+
+  for (auto& id : ids) {
+    uint8_t leaf[32];
+    bool present;
+    if (phase == 0) {
+      int32_t cid = (int32_t)id.toInt();
+      if (!integ_leaf_category(cid, leaf, present)) return -1;
+      integ_xor(acc[integ_bucket_category(cid)], leaf);
+    } else {
+      if (!integ_leaf_item(id.c_str(), leaf, present)) return -1;
+      integ_xor(acc[integ_bucket_item(id.c_str())], leaf);
+    }
+    cursor = id;
+  }
+  return (int)ids.size();
+}
+
+static int integ_leaf_count() {
+  sqlite3_stmt* st = nullptr;
+  if (sqlite3_prepare_v2(g_db, "SELECT (SELECT COUNT(*) FROM categories) + (SELECT COUNT(*) FROM items);",
+                         -1, &st, nullptr) != SQLITE_OK) return -1;
+  int n = (sqlite3_step(st) == SQLITE_ROW) ? sqlite3_column_int(st, 0) : -1;
+  sqlite3_finalize(st);
+  return n;
+}
+
+// Re-hashes every leaf and seals the result as the new trusted state.
+static bool integ_rebuild() {
+  if (!db_open() || !keyring_loaded()) return false;
+  int total = integ_leaf_count();
+  if (total < 0) return false;
+
+  LoadingScope loading("LOADING", "Sealing vault...");
+  g_loading_last_pm = -1;
+  uint8_t acc[INTEG_BUCKETS][32];
+  memset(acc, 0, sizeof(acc));
+
+  if (!db_begin()) return false;
+  uint32_t done = 0;
+  for (uint8_t phase = 0; phase < 2; ++phase) {
+    String cursor;
+    while (true) {
+      int n = integ_fold_batch(phase, cursor, acc, PP_REKEY_BATCH_ROWS);
+      if (n < 0) { db_rollback(); return false; }
+      done += (uint32_t)n;
+      drawLoadingProgress(done, (uint32_t)total);
+      touchActivity();
+      if (n < PP_REKEY_BATCH_ROWS) break;
+    }
+  }
+
+  // Never reuse a generation NVS has already seen, or the new root would look like a fork.
+  IntegNvs nvs = integ_nvs_read();
+  uint32_t gen = (nvs.gen > g_meta.integ_gen ? nvs.gen : g_meta.integ_gen) + 1;
+  bool ok = db_exec("DELETE FROM integrity;");
+  for (uint8_t i = 0; ok && i < INTEG_BUCKETS; ++i) ok = integ_store_bucket(i, acc[i]);
+  ok = ok && integ_stage_root(gen);
+  if (!ok || !db_commit()) { db_rollback(); return false; }
+  integ_publish();
+  Serial.printf("[INTEG] sealed %u leaves at gen %u\n", (unsigned)done, (unsigned)gen);
+  return true;
+}
+
+static bool integ_seal_if_needed() {
+  return integ_sealed() || integ_rebuild();
+}
+
+// Rotation rewrites every row under a new key; call inside the transaction that finishes it.
+// NVS is told first, so an unsealed vault on the card is expected rather than suspicious;
+// if the commit then fails, the still-sealed vault simply re-registers at the next unlock.
+static bool integ_invalidate() {
+  integ_nvs_write(String());
+  return db_exec("UPDATE meta SET integ_root='';");
+}
+
+// Same, for the saveMeta() that starts a rotation: rows stop matching their
+// leaves with the first batch, and a paused rotation leaves them that way
+// until it finishes.
+static void integ_unseal_for_rekey() {
+  integ_nvs_write(String());
+  g_meta.integ_root = "";
+}
+
+// ---- Checks ----
+static IntegStatus integ_verify_root() {
+  if (!integ_sealed()) return IntegStatus::Unsealed;
+  uint8_t b[INTEG_BUCKETS][32];
+  String root;
+  if (!integ_load_buckets(b) || !integ_root_hex(g_meta.integ_gen, b, root)) return IntegStatus::Mismatch;
+  if (root.length() != g_meta.integ_root.length() ||
+      !consttime_eq((const uint8_t*)root.c_str(), (const uint8_t*)g_meta.integ_root.c_str(), root.length())) {
+    return IntegStatus::Mismatch;
+  }
+
+  IntegNvs nvs = integ_nvs_read();
+  if (!nvs.present) return IntegStatus::Ok;          // first unlock of this vault on this device
+  if (g_meta.integ_gen < nvs.gen) return IntegStatus::RolledBack;
+  if (g_meta.integ_gen == nvs.gen && root != nvs.root) return IntegStatus::Mismatch;
+  return IntegStatus::Ok;                            // newer: NVS write lost after a commit
+}
+
+// Offered when the card no longer matches what this device last wrote.
+static void integ_alert(const char* what) {
+  Serial.printf("[INTEG] %s\n", what);
+  static const char* items[] = { "[ TRUST & RESEAL ]", "[ LOCK ]" };
+  if (promptChoice("Integrity", what, items, 2, 1) != 0) lockAndReboot("integrity check failed");
+  if (!integ_rebuild()) waitForButtonB("Error", "Reseal failed", "OK");
+}
+
+static void integ_check_at_unlock() {
+  IntegStatus s = integ_verify_root();
+  if (s == IntegStatus::Ok) {
+    IntegNvs nvs = integ_nvs_read();
+    if (!nvs.present || nvs.gen != g_meta.integ_gen) integ_nvs_write(g_meta.integ_root);
+  } else if (s == IntegStatus::Unsealed) {
+    // Sealed as far as this device knows, yet the card carries no root.
+    if (integ_nvs_read().present) integ_alert("Integrity record missing");
+  } else if (s == IntegStatus::RolledBack) {
+    integ_alert("Older copy of vault");
+  } else if (s == IntegStatus::Mismatch) {
+    integ_alert("Vault changed off-device");
+  }
+}
+
+// ---- Background re-check ----
+struct IntegScan {
+  bool     done = false;
+  uint8_t  phase = 0;
+  uint32_t gen = 0;
+  String   cursor;
+  uint8_t  acc[INTEG_BUCKETS][32];
+};
+static IntegScan g_integ_scan;
+
+static void integ_scan_restart() {
+  g_integ_scan.phase = 0;
+  g_integ_scan.gen = g_meta.integ_gen;
+  g_integ_scan.cursor = "";
+  memset(g_integ_scan.acc, 0, sizeof(g_integ_scan.acc));
+}
+
+// One slice of the leaf re-check; call from idle UI loops. Returns true when it
+// put up a modal, so the caller must redraw its screen.
+static bool integ_idle_slice() {
+#if PP_INTEG_IDLE_MS
+  if (g_integ_scan.done || !integ_sealed() || g_meta.rekey_phase || !db_open()) return false;
+  if (millis() - g_lastActivityMs < PP_INTEG_IDLE_MS) return false;
+
+  // A CRUD change landed mid-pass: the partial sums no longer line up.
+  if (g_integ_scan.gen != g_meta.integ_gen || g_integ_scan.phase > 1) integ_scan_restart();
+
+  int n = integ_fold_batch(g_integ_scan.phase, g_integ_scan.cursor, g_integ_scan.acc, PP_INTEG_SLICE_LEAVES);
+  if (n < 0) return false;
+  if (n == PP_INTEG_SLICE_LEAVES) return false;
+  if (++g_integ_scan.phase < 2) { g_integ_scan.cursor = ""; return false; }
+
+  uint8_t b[INTEG_BUCKETS][32];
+  if (!integ_load_buckets(b)) return false;
+  g_integ_scan.done = true;
+  if (memcmp(b, g_integ_scan.acc, sizeof(b)) == 0) {
+    Serial.println("[INTEG] background check OK");
+    return false;
+  }
+  integ_alert("Rows changed off-device");
+  return true;
+#else
+  return false;
+#endif
+}
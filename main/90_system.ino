@@ -62,10 +62,10 @@ static void mountSD() {
 }
 
 void drawLogo(){
-  const uint16_t bg = UI_ColorBg();
-  const uint16_t fg = UI_ColorFg();
-  const uint16_t accent = UI_ColorSelectedBg();
-  const uint16_t accentFg = UI_ColorSelectedFg();
+  const UIColor bg = UI_ColorBg();
+  const UIColor fg = UI_ColorFg();
+  const UIColor accent = UI_ColorSelectedBg();
+  const UIColor accentFg = UI_ColorSelectedFg();
 
   LCD_BeginFrame();
   LCD_Clear(bg);
@@ -148,8 +148,8 @@ static void settingsImportExcel() {
 }
 
 // Write a JSON string value with proper escaping.
-static void jsonWriteEscaped(File& f, const String& s) {
-  for (int i = 0; i < s.length(); ++i) {
+static void jsonWriteEscaped(File& f, const char* s, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
     char c = s[i];
     switch (c) {
       case '\"': f.print("\\\""); break;
@@ -173,6 +173,8 @@ static void jsonWriteEscaped(File& f, const String& s) {
   }
 }
 
+static void jsonWriteEscaped(File& f, const String& s) { jsonWriteEscaped(f, s.c_str(), s.length()); }
+
 static void settingsExportJson() {
   Serial.println("[EXPORT] settingsExportJson");
 
@@ -225,7 +227,13 @@ static void settingsExportJson() {
     return;
   }
 
-  LoadingScope loading("EXPORT", "Writing data.json...");
+  LoadingScope loading("EXPORT", "Reading vault...");
+  if (!ensureAllCategoriesLoaded()) {
+    f.close();
+    waitForButtonB("Error", "Load items failed", "OK");
+    return;
+  }
+  updateLoading("Writing data.json...");
 
   size_t written = 0;
   size_t failed  = 0;
@@ -237,7 +245,7 @@ static void settingsExportJson() {
 
   for (auto& c : g_vault.categories) {
     for (auto& it : c.items) {
-      String pw;
+      SecureString pw;
       if (!decrypt_password(it, it.id, pw)) {
         Serial.println("[EXPORT] decrypt_password failed, skipping entry");
         failed++;
@@ -255,14 +263,13 @@ static void settingsExportJson() {
       f.print("\",\"Label\":\"");
       jsonWriteEscaped(f, it.label_plain);
       f.print("\",\"Password\":\"");
-      jsonWriteEscaped(f, pw);
+      jsonWriteEscaped(f, pw.c_str(), pw.length());
       f.print("\"}");
 
       written++;
 
       // Wipe plaintext password from RAM
-      for (size_t i = 0; i < pw.length(); ++i) pw.setCharAt(i, 0);
-      pw = "";
+      pw.clear();
     }
   }
 
@@ -271,7 +278,11 @@ static void settingsExportJson() {
   f.close();
 
   char msg[64];
-  snprintf(msg, sizeof(msg), "Exported %u entries", (unsigned)written);
+  if (failed) {
+    snprintf(msg, sizeof(msg), "Exported %u entries,\n%u unreadable", (unsigned)written, (unsigned)failed);
+  } else {
+    snprintf(msg, sizeof(msg), "Exported %u entries", (unsigned)written);
+  }
   waitForButtonB("Export ready", msg, "ENTER USB MODE");
 
   // Expose SD to host so the user can copy /export/data.json
@@ -430,9 +441,12 @@ static bool tryUnlockWithPIN_counting(const String& pin) {
   if (auth_isLockedOut()) return false;
   if (pin.length() != 6) return false;
 
+  g_kdf_canceled = false;
   bool ok = unlockWithPIN(pin);
   if (ok) {
     auth_resetPinFailures();
+  } else if (kdf_was_canceled()) {
+    Serial.println("[AUTH] unlock canceled during KDF (not counted)");
   } else {
     auth_recordPinFailure_andMaybeLockout();
   }
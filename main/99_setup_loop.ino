@@ -10,6 +10,7 @@ void setup() {
   LCD_Init();
   LCD_SetOrientation(LCD_ORIENTATION);
   UI_SetPalette(loadPaletteSetting());
+  LCD_SetStatsOverlay(PP_DISPLAY_STATS);
   
   g_rotary.begin(ENC_PIN_B, ENC_PIN_A, BTN_BACK, BTN_SELECT, BTN_UP, BTN_DOWN);
   
@@ -78,6 +79,7 @@ void setup() {
     }
     g_state = UiState::MainMenu;
     g_crypto.unlocked = true;
+    integ_seal_if_needed();
     refreshDecryptedItemNames();
     buildAndShowMainMenu();
   } else {
@@ -119,10 +121,22 @@ void setup() {
       }
     }
     
+    // Before anything else writes: compare the card with what this device last sealed.
+    integ_check_at_unlock();
+
+    if (!rekey_resume_if_pending()) {
+      waitForButtonB("Error", "Key rotation resume failed", "OK");
+      return;
+    }
+
     if (!db_migrate_encrypt_names_labels_if_needed(PP_WIPE_PLAINTEXT_NAMES)) {
       waitForButtonB("Error", "Name/label migration failed", "OK");
       return;
     }
+
+    // Not fatal: the audit retries, and CRUD keeps new rows indexed meanwhile.
+    if (!fp_index_backfill()) Serial.println("[BOOT] reuse index backfill incomplete");
+    if (!integ_seal_if_needed()) Serial.println("[BOOT] integrity seal failed");
     
     USB.begin();
     KeyboardHID.begin();
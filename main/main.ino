@@ -12,6 +12,7 @@
 
 #include <mbedtls/md.h>
 #include <mbedtls/gcm.h>
+#include <mbedtls/chachapoly.h>
 #include <mbedtls/sha256.h>
 #include <mbedtls/pkcs5.h>
 #include <mbedtls/base64.h>
@@ -0,0 +1,380 @@
+// crypto_tests.cpp - the sketch's crypto helpers against the formats and
+// reference implementations existing vaults were written with.
+
+#include "pp_sketch.h"
+#include "host_test.h"
+#include <chrono>
+#include <mbedtls/version.h>
+
+// ---- AAD ----
+// The String-concatenating builders the AadBuf ones replaced. Vaults on SD
+// cards were sealed with these bytes, so the new builders must match exactly.
+static String legacyItemFieldAad(const String& db_uuid, const String& item_id, const char* field) {
+  return String("item-field v1|") + db_uuid + "|" + item_id + "|" + field;
+}
+
+static String legacyCategoryFieldAad(const String& db_uuid, int32_t cat_id, const char* field) {
+  return String("cat-field v1|") + db_uuid + "|" + String((int)cat_id) + "|" + field;
+}
+
+static void useDbUuid(const String& uuid) {
+  g_meta.db_uuid = uuid;
+  cache_db_uuid();
+}
+
+static bool sameBytes(const AadBuf& aad, const String& legacy) {
+  return aad.size() == legacy.length() && memcmp(aad.data(), legacy.c_str(), aad.size()) == 0;
+}
+
+// DB_UUID_MAX + 1 characters is not cached and is read from g_meta instead.
+static const char* const kUuids[] = {
+  "",
+  "3f2a9c4e8b1d4f6a9e0c7b5d2a1f8e3c",
+  "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef",
+  "0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef0",
+};
+
+TEST(item_aad_matches_string_format) {
+  static const char* const kIds[] = { "", "a1b2c3d4e5f60718", "id|with|bars" };
+  static const char* const kFields[] = { "password", "label", "notes" };
+  for (const char* uuid : kUuids) {
+    useDbUuid(uuid);
+    for (const char* id : kIds) {
+      for (const char* field : kFields) {
+        AadBuf aad;
+        CHECK(make_item_field_aad(id, field, aad));
+        CHECK(sameBytes(aad, legacyItemFieldAad(uuid, id, field)));
+      }
+      AadBuf label;
+      CHECK(make_item_label_aad(id, label));
+      CHECK(sameBytes(label, legacyItemFieldAad(uuid, id, "label")));
+    }
+  }
+}
+
+TEST(category_aad_matches_string_format) {
+  static const int32_t kIds[] = { 0, 1, 42, -1, 2147483647, (int32_t)0x80000000 };
+  for (const char* uuid : kUuids) {
+    useDbUuid(uuid);
+    for (int32_t id : kIds) {
+      AadBuf aad;
+      CHECK(make_category_field_aad(id, "name", aad));
+      CHECK(sameBytes(aad, legacyCategoryFieldAad(uuid, id, "name")));
+    }
+  }
+}
+
+// Too long for AAD_MAX: the builder fails instead of sealing a truncated AAD.
+TEST(aad_overflow_fails) {
+  useDbUuid(kUuids[3]);
+  String id;
+  while (id.length() < AAD_MAX) id += "0123456789abcdef";
+  AadBuf aad;
+  CHECK(!make_item_field_aad(id, "password", aad));
+  CHECK(aad.size() <= AAD_MAX);
+
+  AadBuf fits;
+  CHECK(make_item_field_aad("a1b2c3d4e5f60718", "password", fits));
+}
+
+// A field sealed under the old AAD opens with the new one.
+TEST(legacy_sealed_field_opens) {
+  useDbUuid(kUuids[1]);
+  uint8_t key[32], nonce[12];
+  esp_fill_random(key, sizeof(key));
+  esp_fill_random(nonce, sizeof(nonce));
+  const String legacy = legacyItemFieldAad(kUuids[1], "a1b2c3d4e5f60718", "password");
+  const char secret[] = "hunter2";
+  std::vector<uint8_t> ct, pt;
+  CHECK(aes256_gcm_encrypt(key, nonce, (const uint8_t*)legacy.c_str(), legacy.length(),
+                           (const uint8_t*)secret, sizeof(secret) - 1, ct));
+  AadBuf aad;
+  CHECK(make_item_field_aad("a1b2c3d4e5f60718", "password", aad));
+  CHECK(aes256_gcm_decrypt(key, nonce, aad.data(), aad.size(), ct.data(), ct.size(), pt));
+  CHECK(pt.size() == sizeof(secret) - 1 && memcmp(pt.data(), secret, pt.size()) == 0);
+
+  AadBuf other;
+  CHECK(make_item_field_aad("a1b2c3d4e5f60718", "label", other));
+  CHECK(!aes256_gcm_decrypt(key, nonce, other.data(), other.size(), ct.data(), ct.size(), pt));
+}
+
+// ---- AEAD ----
+static std::vector<uint8_t> randomBytes(size_t n) {
+  std::vector<uint8_t> v(n);
+  esp_fill_random(v.data(), n);
+  return v;
+}
+
+static const CipherSuite kSuites[] = { CipherSuite::AesGcm, CipherSuite::ChaChaPoly };
+
+// Lengths around the 16-byte AES block and 64-byte ChaCha20 block, plus the
+// vault-field size class and a large note.
+TEST(aead_round_trips_both_suites) {
+  static const size_t kLens[] = { 0, 1, 15, 16, 17, 63, 64, 65, 256, 4096 };
+  hostSeedRandom(37);
+  for (CipherSuite suite : kSuites) {
+    uint8_t key[32], nonce[12];
+    esp_fill_random(key, sizeof(key));
+    AeadCtx a;
+    CHECK(aead_setkey(a, suite, key));
+    for (size_t len : kLens) {
+      esp_fill_random(nonce, sizeof(nonce));
+      const std::vector<uint8_t> pt = randomBytes(len), aad = randomBytes(len % 40);
+      std::vector<uint8_t> ct, out;
+      CHECK(aead_encrypt(&a, nonce, aad.data(), aad.size(), pt.data(), pt.size(), ct));
+      CHECK_EQ(ct.size(), len + 16);
+      CHECK(aead_decrypt(&a, nonce, aad.data(), aad.size(), ct.data(), ct.size(), out));
+      CHECK(out == pt);
+    }
+    aead_free(a);
+  }
+}
+
+// Any change to ciphertext, tag, AAD, nonce or key fails authentication.
+TEST(aead_rejects_tampering) {
+  hostSeedRandom(1337);
+  for (CipherSuite suite : kSuites) {
+    uint8_t key[32], nonce[12];
+    esp_fill_random(key, sizeof(key));
+    esp_fill_random(nonce, sizeof(nonce));
+    const std::vector<uint8_t> pt = randomBytes(100), aad = randomBytes(24);
+    AeadCtx a;
+    CHECK(aead_setkey(a, suite, key));
+    std::vector<uint8_t> ct, out;
+    CHECK(aead_encrypt(&a, nonce, aad.data(), aad.size(), pt.data(), pt.size(), ct));
+
+    for (size_t i : { (size_t)0, (size_t)99, (size_t)100, ct.size() - 1 }) {
+      std::vector<uint8_t> bad = ct;
+      bad[i] ^= 0x01;
+      CHECK(!aead_decrypt(&a, nonce, aad.data(), aad.size(), bad.data(), bad.size(), out));
+    }
+    std::vector<uint8_t> badAad = aad;
+    badAad[5] ^= 0x80;
+    CHECK(!aead_decrypt(&a, nonce, badAad.data(), badAad.size(), ct.data(), ct.size(), out));
+    CHECK(!aead_decrypt(&a, nonce, aad.data(), aad.size() - 1, ct.data(), ct.size(), out));
+    uint8_t badNonce[12];
+    memcpy(badNonce, nonce, sizeof(nonce));
+    badNonce[11] ^= 0x01;
+    CHECK(!aead_decrypt(&a, badNonce, aad.data(), aad.size(), ct.data(), ct.size(), out));
+    CHECK(!aead_decrypt(&a, nonce, aad.data(), aad.size(), ct.data(), 15, out));
+    CHECK(!aead_decrypt(nullptr, nonce, aad.data(), aad.size(), ct.data(), ct.size(), out));
+
+    key[0] ^= 0x01;
+    AeadCtx other;
+    CHECK(aead_setkey(other, suite, key));
+    CHECK(!aead_decrypt(&other, nonce, aad.data(), aad.size(), ct.data(), ct.size(), out));
+    aead_free(other);
+
+    CHECK(aead_decrypt(&a, nonce, aad.data(), aad.size(), ct.data(), ct.size(), out));
+    CHECK(out == pt);
+    aead_free(a);
+  }
+}
+
+// A vault's suite is fixed at creation; ciphertext from one suite must not open
+// under the other with the same key.
+TEST(aead_suites_do_not_cross) {
+  uint8_t key[32], nonce[12];
+  esp_fill_random(key, sizeof(key));
+  esp_fill_random(nonce, sizeof(nonce));
+  const uint8_t pt[] = "vault field";
+  AeadCtx gcm, chacha;
+  CHECK(aead_setkey(gcm, CipherSuite::AesGcm, key));
+  CHECK(aead_setkey(chacha, CipherSuite::ChaChaPoly, key));
+  std::vector<uint8_t> ctGcm, ctChacha, out;
+  CHECK(aead_encrypt(&gcm, nonce, nullptr, 0, pt, sizeof(pt), ctGcm));
+  CHECK(aead_encrypt(&chacha, nonce, nullptr, 0, pt, sizeof(pt), ctChacha));
+  CHECK(ctGcm != ctChacha);
+  CHECK(!aead_decrypt(&chacha, nonce, nullptr, 0, ctGcm.data(), ctGcm.size(), out));
+  CHECK(!aead_decrypt(&gcm, nonce, nullptr, 0, ctChacha.data(), ctChacha.size(), out));
+  aead_free(gcm);
+  aead_free(chacha);
+}
+
+static std::vector<uint8_t> referenceSubkey(const uint8_t vk[32], const char* info) {
+  std::vector<uint8_t> out(32);
+  CHECK(hkdf_sha256_extract_expand(vk, 32, (const uint8_t*)"subkey salt", 11,
+                                   (const uint8_t*)info, strlen(info), out.data(), 32));
+  return out;
+}
+
+static bool subkeyIs(KeyRing& k, SubKey id, const std::vector<uint8_t>& want) {
+  const uint8_t* got = keyring_subkey(k, id);
+  return got && memcmp(got, want.data(), 32) == 0;
+}
+
+// A suite switch keeps the vault_key, so the AEAD subkeys must differ per suite.
+// AES-GCM keeps the strings existing vaults were sealed under, and the non-AEAD
+// subkeys are the same for both.
+TEST(keyring_subkeys_follow_suite) {
+  uint8_t vk[32];
+  esp_fill_random(vk, sizeof(vk));
+  KeyRing gcm, chacha;
+  CHECK(keyring_load(gcm, vk, CipherSuite::AesGcm));
+  CHECK(keyring_load(chacha, vk, CipherSuite::ChaChaPoly));
+
+  CHECK(subkeyIs(gcm, SubKey::Fields, referenceSubkey(vk, "K_fields v1")));
+  CHECK(subkeyIs(gcm, SubKey::Db, referenceSubkey(vk, "K_db v1")));
+  CHECK(subkeyIs(gcm, SubKey::Meta, referenceSubkey(vk, "K_meta v1")));
+  CHECK(subkeyIs(chacha, SubKey::Fields, referenceSubkey(vk, "K_fields v1|chacha")));
+  CHECK(subkeyIs(chacha, SubKey::Db, referenceSubkey(vk, "K_db v1|chacha")));
+  CHECK(subkeyIs(chacha, SubKey::Meta, referenceSubkey(vk, "K_meta v1|chacha")));
+  for (SubKey id : { SubKey::Session, SubKey::Fingerprint, SubKey::Integrity }) {
+    const uint8_t* a = keyring_subkey(gcm, id);
+    const uint8_t* b = keyring_subkey(chacha, id);
+    CHECK(a && b && memcmp(a, b, 32) == 0);
+  }
+
+  // Reloading the same key under the other suite re-derives everything.
+  CHECK(keyring_load(gcm, vk, CipherSuite::ChaChaPoly));
+  CHECK(subkeyIs(gcm, SubKey::Fields, referenceSubkey(vk, "K_fields v1|chacha")));
+  keyring_wipe(gcm);
+  keyring_wipe(chacha);
+}
+
+// Runs on simulated time here, so only the result's sanity is checked;
+// sketch_bench reports real numbers.
+TEST(aead_benchmark_runs) {
+  for (CipherSuite suite : kSuites) CHECK(aead_benchmark_kbps(suite) > 0);
+}
+
+// ---- PBKDF2-HMAC-SHA256 ----
+// The sketch's PBKDF2 (both the in-tree compression and the mbedTLS SHA-256
+// inner loop) must give the bytes mbedTLS's own PBKDF2 gives: the vault key is
+// wrapped under its output.
+static std::vector<uint8_t> referencePbkdf2(const std::vector<uint8_t>& pw, const std::vector<uint8_t>& salt,
+                                            uint32_t iters, size_t outLen) {
+  std::vector<uint8_t> out(outLen);
+#if MBEDTLS_VERSION_NUMBER >= 0x03030000
+  CHECK_EQ(mbedtls_pkcs5_pbkdf2_hmac_ext(MBEDTLS_MD_SHA256, pw.data(), pw.size(), salt.data(), salt.size(),
+                                         iters, (uint32_t)outLen, out.data()), 0);
+#else
+  mbedtls_md_context_t md;
+  mbedtls_md_init(&md);
+  CHECK_EQ(mbedtls_md_setup(&md, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1), 0);
+  CHECK_EQ(mbedtls_pkcs5_pbkdf2_hmac(&md, pw.data(), pw.size(), salt.data(), salt.size(),
+                                     iters, (uint32_t)outLen, out.data()), 0);
+  mbedtls_md_free(&md);
+#endif
+  return out;
+}
+
+// One 32-byte block through Pbkdf2Job, in uneven slices.
+static std::vector<uint8_t> jobPbkdf2(const std::vector<uint8_t>& pw, const std::vector<uint8_t>& salt,
+                                      uint32_t iters, bool hw) {
+  Pbkdf2Job job;
+  CHECK(pbkdf2_job_begin(job, pw.data(), pw.size(), salt.data(), salt.size(), iters, 1, hw));
+  uint32_t slice = 1;
+  while (!pbkdf2_job_step(job, slice)) slice = slice * 3 + 1;
+  std::vector<uint8_t> out(job.T, job.T + 32);
+  pbkdf2_job_end(job);
+  return out;
+}
+
+// Password lengths around the 64-byte HMAC block (longer keys are hashed
+// first) and iteration counts around PBKDF2_SLICE_ITERS.
+TEST(pbkdf2_matches_mbedtls) {
+  static const size_t kPwLens[] = { 0, 1, 6, 32, 63, 64, 65, 200 };
+  static const uint32_t kIters[] = { 1, 2, 3, PBKDF2_SLICE_ITERS - 1, PBKDF2_SLICE_ITERS, PBKDF2_SLICE_ITERS + 1, 5000 };
+  hostSeedRandom(27);
+  for (size_t pwLen : kPwLens) {
+    for (uint32_t iters : kIters) {
+      const std::vector<uint8_t> pw = randomBytes(pwLen), salt = randomBytes(16);
+      const std::vector<uint8_t> ref = referencePbkdf2(pw, salt, iters, 32);
+      std::vector<uint8_t> out(32);
+      CHECK(pbkdf2_hmac_sha256(pw.data(), pw.size(), salt.data(), salt.size(), iters, out.data(), out.size()));
+      CHECK(out == ref);
+      CHECK(jobPbkdf2(pw, salt, iters, false) == ref);
+      CHECK(jobPbkdf2(pw, salt, iters, true) == ref);
+    }
+  }
+}
+
+// Output lengths that are not a whole number of blocks use T2, T3, ...
+TEST(pbkdf2_multi_block_output) {
+  static const size_t kOutLens[] = { 1, 20, 33, 64, 100 };
+  hostSeedRandom(2027);
+  for (size_t outLen : kOutLens) {
+    const std::vector<uint8_t> pw = randomBytes(32), salt = randomBytes(16);
+    std::vector<uint8_t> out(outLen);
+    CHECK(pbkdf2_hmac_sha256(pw.data(), pw.size(), salt.data(), salt.size(), 100, out.data(), out.size()));
+    CHECK(out == referencePbkdf2(pw, salt, 100, outLen));
+  }
+}
+
+// RFC 7914 section 11, independent of mbedTLS.
+TEST(pbkdf2_rfc7914_vectors) {
+  static const uint8_t kPasswd[64] = {
+    0x55, 0xac, 0x04, 0x6e, 0x56, 0xe3, 0x08, 0x9f, 0xec, 0x16, 0x91, 0xc2, 0x25, 0x44, 0xb6, 0x05,
+    0xf9, 0x41, 0x85, 0x21, 0x6d, 0xde, 0x04, 0x65, 0xe6, 0x8b, 0x9d, 0x57, 0xc2, 0x0d, 0xac, 0xbc,
+    0x49, 0xca, 0x9c, 0xcc, 0xf1, 0x79, 0xb6, 0x45, 0x99, 0x16, 0x64, 0xb3, 0x9d, 0x77, 0xef, 0x31,
+    0x7c, 0x71, 0xb8, 0x45, 0xb1, 0xe3, 0x0b, 0xd5, 0x09, 0x11, 0x20, 0x41, 0xd3, 0xa1, 0x97, 0x83,
+  };
+  static const uint8_t kNaCl[64] = {
+    0x4d, 0xdc, 0xd8, 0xf6, 0x0b, 0x98, 0xbe, 0x21, 0x83, 0x0c, 0xee, 0x5e, 0xf2, 0x27, 0x01, 0xf9,
+    0x64, 0x1a, 0x44, 0x18, 0xd0, 0x4c, 0x04, 0x14, 0xae, 0xff, 0x08, 0x87, 0x6b, 0x34, 0xab, 0x56,
+    0xa1, 0xd4, 0x25, 0xa1, 0x22, 0x58, 0x33, 0x54, 0x9a, 0xdb, 0x84, 0x1b, 0x51, 0xc9, 0xb3, 0x17,
+    0x6a, 0x27, 0x2b, 0xde, 0xbb, 0xa1, 0xd0, 0x78, 0x47, 0x8f, 0x62, 0xb3, 0x97, 0xf3, 0x3c, 0x8d,
+  };
+  uint8_t out[64];
+  CHECK(pbkdf2_hmac_sha256((const uint8_t*)"passwd", 6, (const uint8_t*)"salt", 4, 1, out, sizeof(out)));
+  CHECK(memcmp(out, kPasswd, sizeof(out)) == 0);
+  CHECK(pbkdf2_hmac_sha256((const uint8_t*)"Password", 8, (const uint8_t*)"NaCl", 4, 80000, out, sizeof(out)));
+  CHECK(memcmp(out, kNaCl, sizeof(out)) == 0);
+}
+
+TEST(pbkdf2_cancel_and_zero_iters) {
+  const uint8_t pw[8] = { 1, 2, 3, 4, 5, 6, 7, 8 }, salt[16] = { 0 };
+  uint8_t out[32];
+  CHECK(!pbkdf2_hmac_sha256(pw, sizeof(pw), salt, sizeof(salt), 0, out, sizeof(out)));
+  volatile bool cancel = true;
+  CHECK(!pbkdf2_hmac_sha256(pw, sizeof(pw), salt, sizeof(salt), 3 * PBKDF2_SLICE_ITERS, out, sizeof(out), &cancel));
+  // A run that fits in one slice finishes before the flag is looked at.
+  CHECK(pbkdf2_hmac_sha256(pw, sizeof(pw), salt, sizeof(salt), PBKDF2_SLICE_ITERS, out, sizeof(out), &cancel));
+}
+
+// ---- derive_W_pair ----
+// The recovery half runs on a helper task (a std::thread here). Whether or not
+// the task could be created, the pair must equal the two single derivations.
+static const uint8_t kSalt1[16] = { 0x51, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+static const uint8_t kSalt2[16] = { 0x52, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+static void useDeviceSecret(size_t len) {
+  g_crypto.device_secret.assign(len, 0);
+  for (size_t i = 0; i < len; ++i) g_crypto.device_secret[i] = (uint8_t)(0xA0 + i);
+}
+
+TEST(pair_threaded_matches_serial) {
+  useDeviceSecret(32);
+  const String pin = "4711", pinRk = "4711ABCD-EFGH-JKLM-NPQR";
+  std::vector<uint8_t> wn, wr;
+  CHECK(derive_W(pin, kSalt1, kSalt2, 3000, wn));
+  CHECK(derive_W_recovery_only(pinRk, kSalt1, kSalt2, 3000, wr));
+
+  std::vector<uint8_t> threadedN, threadedR;
+  CHECK(derive_W_pair(pin, pinRk, kSalt1, kSalt2, 3000, threadedN, threadedR));
+  CHECK(threadedN == wn);
+  CHECK(threadedR == wr);
+
+  hostSetTaskCreation(false);
+  std::vector<uint8_t> serialN, serialR;
+  CHECK(derive_W_pair(pin, pinRk, kSalt1, kSalt2, 3000, serialN, serialR));
+  hostSetTaskCreation(true);
+  CHECK(serialN == wn);
+  CHECK(serialR == wr);
+}
+
+// A failed normal half cancels the helper at its next slice. Without the
+// cancel, the recovery PBKDF2 would run far past the ctest timeout.
+TEST(pair_failure_cancels_helper) {
+  g_crypto.device_secret.clear();
+  std::vector<uint8_t> wn(32, 1), wr(32, 1);
+  const auto t0 = std::chrono::steady_clock::now();
+  CHECK(!derive_W_pair("4711", "4711ABCD-EFGH-JKLM-NPQR", kSalt1, kSalt2, 200000000, wn, wr));
+  CHECK(std::chrono::steady_clock::now() - t0 < std::chrono::seconds(10));
+  CHECK(wn.empty() && wr.empty());
+
+  hostSetTaskCreation(false);
+  CHECK(!derive_W_pair("4711", "4711ABCD-EFGH-JKLM-NPQR", kSalt1, kSalt2, 200000000, wn, wr));
+  hostSetTaskCreation(true);
+}
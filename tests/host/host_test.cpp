@@ -0,0 +1,115 @@
+// host_test.cpp - registry, golden file and main() for the host tests.
+
+#include "host_test.h"
+#include "HostDisplayBackend.h"
+#include <map>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#ifndef PP_GOLDEN_FILE
+#error "PP_GOLDEN_FILE must name the golden frame list"
+#endif
+
+struct HostTestCase {
+  const char* name;
+  HostTestFn fn;
+};
+
+static std::vector<HostTestCase>& registry() {
+  static std::vector<HostTestCase> tests;
+  return tests;
+}
+
+static bool s_failed = false;
+static bool s_golden_dirty = false;
+
+HostTestReg::HostTestReg(const char* name, HostTestFn fn) {
+  registry().push_back({ name, fn });
+}
+
+void hostTestFail(const char* file, int line, const char* what) {
+  fprintf(stderr, "%s:%d: FAILED: %s\n", file, line, what);
+  s_failed = true;
+}
+
+// name -> crc, one "name 0x........" per line; '#' starts a comment.
+static std::map<std::string, uint32_t>& goldens() {
+  static std::map<std::string, uint32_t> table;
+  static bool loaded = false;
+  if (!loaded) {
+    loaded = true;
+    if (FILE* f = fopen(PP_GOLDEN_FILE, "r")) {
+      char line[256];
+      while (fgets(line, sizeof(line), f)) {
+        char name[200];
+        unsigned crc = 0;
+        if (line[0] != '#' && sscanf(line, "%199s %x", name, &crc) == 2) table[name] = crc;
+      }
+      fclose(f);
+    }
+  }
+  return table;
+}
+
+static void writeGoldens() {
+  FILE* f = fopen(PP_GOLDEN_FILE, "w");
+  if (!f) {
+    fprintf(stderr, "cannot write %s\n", PP_GOLDEN_FILE);
+    s_failed = true;
+    return;
+  }
+  fprintf(f, "# CRC-32 of each golden frame (HostDisplayBackend::crc32).\n"
+             "# Regenerate with PP_UPDATE_GOLDEN=1 and check the PNGs from PP_HOST_PNG_DIR.\n");
+  for (const auto& g : goldens()) fprintf(f, "%s 0x%08x\n", g.first.c_str(), (unsigned)g.second);
+  fclose(f);
+}
+
+void checkGolden(const char* name, const HostDisplayBackend& panel,
+                 const char* file, int line) {
+  const uint32_t crc = panel.crc32();
+  if (const char* dir = getenv("PP_HOST_PNG_DIR")) {
+    const std::string path = std::string(dir) + "/" + name + ".png";
+    if (!panel.writePNG(path.c_str())) fprintf(stderr, "cannot write %s\n", path.c_str());
+  }
+
+  const char* update = getenv("PP_UPDATE_GOLDEN");
+  if (update && strcmp(update, "0") != 0) {
+    goldens()[name] = crc;
+    s_golden_dirty = true;
+    return;
+  }
+
+  const auto it = goldens().find(name);
+  char msg[160];
+  if (it == goldens().end()) {
+    snprintf(msg, sizeof(msg), "no golden frame '%s' (crc 0x%08x)", name, (unsigned)crc);
+    hostTestFail(file, line, msg);
+  } else if (it->second != crc) {
+    snprintf(msg, sizeof(msg), "frame '%s' is 0x%08x, golden 0x%08x",
+             name, (unsigned)crc, (unsigned)it->second);
+    hostTestFail(file, line, msg);
+  }
+}
+
+int main(int argc, char** argv) {
+  int ran = 0;
+  for (const HostTestCase& t : registry()) {
+    bool wanted = argc < 2;
+    for (int i = 1; i < argc && !wanted; ++i) wanted = strcmp(argv[i], t.name) == 0;
+    if (!wanted) continue;
+    const bool before = s_failed;
+    s_failed = false;
+    t.fn();
+    printf("%s %s\n", s_failed ? "FAIL" : "ok  ", t.name);
+    s_failed = s_failed || before;
+    ran++;
+  }
+  if (ran == 0) {
+    fprintf(stderr, "no matching tests\n");
+    return 2;
+  }
+  if (s_golden_dirty) writeGoldens();
+  return s_failed ? 1 : 0;
+}
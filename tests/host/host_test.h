@@ -0,0 +1,52 @@
+// host_test.h - minimal test registry for the host tests.
+//
+//   TEST(menu_initial_frame) { ... CHECK(x); CHECK_EQ(a, b); }
+//
+// A test binary runs every TEST when started without arguments, or the ones
+// named on the command line. CMake registers one ctest case per TEST.
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+class HostDisplayBackend;
+
+typedef void (*HostTestFn)();
+
+struct HostTestReg {
+  HostTestReg(const char* name, HostTestFn fn);
+};
+
+// Marks the running test failed; the test keeps going so one run reports
+// every mismatch.
+void hostTestFail(const char* file, int line, const char* what);
+
+// Compares the panel's crc32() with the value recorded for name in the golden
+// file. PP_UPDATE_GOLDEN=1 records the current value instead. When
+// PP_HOST_PNG_DIR is set the frame is also written there as <name>.png.
+void checkGolden(const char* name, const HostDisplayBackend& panel,
+                 const char* file, int line);
+
+#define TEST(name)                                              \
+  static void name();                                           \
+  static HostTestReg name##_reg(#name, name);                   \
+  static void name()
+
+#define CHECK(cond)                                             \
+  do {                                                          \
+    if (!(cond)) hostTestFail(__FILE__, __LINE__, #cond);       \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                          \
+  do {                                                          \
+    const long long va_ = (long long)(a);                       \
+    const long long vb_ = (long long)(b);                       \
+    if (va_ != vb_) {                                           \
+      char msg_[160];                                           \
+      snprintf(msg_, sizeof(msg_), "%s == %s (%lld vs %lld)",   \
+               #a, #b, va_, vb_);                               \
+      hostTestFail(__FILE__, __LINE__, msg_);                   \
+    }                                                           \
+  } while (0)
+
+#define CHECK_GOLDEN(name, panel) checkGolden(name, panel, __FILE__, __LINE__)
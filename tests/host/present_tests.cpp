@@ -0,0 +1,138 @@
+// present_tests.cpp - what LCD_Present() puts on the wire: only the dirty
+// rectangles, and nothing at all when nothing changed.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include "Display_ST7789.h"
+#include "HostDisplayBackend.h"
+#include "MenuInput.h"
+#include "RotaryMarqueeMenu.h"
+#include "SimpleRotaryController.h"
+#include "TextInputUI.h"
+
+class CountingPanel : public HostDisplayBackend {
+public:
+  CountingPanel() {
+    hostSetMillis(1000);
+    for (uint8_t pin = 0; pin < 8; ++pin) hostSetPin(pin, HIGH);
+    UI_SetPalette(0);
+    LCD_SetBackend(this);
+  }
+  ~CountingPanel() { LCD_SetBackend(nullptr); }
+
+  // Forget everything sent so far, on both sides of the backend interface.
+  void reset() {
+    resetTiming();
+    LCD_ResetStats();
+  }
+};
+
+class StepInput : public MenuInput {
+public:
+  int8_t turns = 0;
+  void update() override {}
+  bool wasTurnedCW() override { if (turns <= 0) return false; turns--; return true; }
+  bool wasTurnedCCW() override { if (turns >= 0) return false; turns++; return true; }
+  bool wasPressedA() override { return false; }
+  bool wasPressedB() override { return false; }
+};
+
+// pushRect() calls one dirty w x h rect costs. The indexed framebuffer is
+// expanded to RGB565 a strip at a time, so it splits tall rects.
+static uint32_t pushesFor(uint32_t w, uint32_t h) {
+#if LCD_INDEXED_FRAMEBUFFER
+  const uint32_t stripPx = (uint32_t)LCD_INDEXED_STRIP_ROWS * max(LCD_WIDTH, LCD_HEIGHT);
+  const uint32_t rows = stripPx / w;
+  return (h + rows - 1) / rows;
+#else
+  (void)w;
+  (void)h;
+  return 1;
+#endif
+}
+
+static const char* kItems[] = { "Email", "Banking", "Social", "Work", "Shopping" };
+
+static void startMenu(RotaryMarqueeMenu& menu, StepInput& input) {
+  menu.begin(input, 3, 80);
+  menu.setTitle("Pocket Pass");
+  menu.setSubTitle("Categories");
+  menu.setMenu(kItems, 5);
+}
+
+TEST(idle_present_sends_nothing) {
+  CountingPanel panel;
+  RotaryMarqueeMenu menu;
+  StepInput input;
+  startMenu(menu, input);
+  panel.reset();
+
+  for (int i = 0; i < 10; ++i) {
+    hostAdvanceMs(10);
+    menu.loop();
+  }
+  LCD_Present();
+  CHECK_EQ(panel.timing().rects, 0);
+  CHECK_EQ(panel.timing().pixels, 0);
+  CHECK_EQ(LCD_GetStats().frames, 0);
+  CHECK_EQ(LCD_GetStats().bytes, 0);
+  CHECK_EQ(LCD_GetStats().skipped, 11);
+}
+
+TEST(full_clear_sends_one_frame) {
+  CountingPanel panel;
+  LCD_Init();
+  LCD_SetOrientation(3);
+  LCD_Present();
+  panel.reset();
+
+  LCD_Clear(BLACK);
+  LCD_Present();
+  CHECK_EQ(panel.timing().rects, pushesFor(320, 172));
+  CHECK_EQ(panel.timing().pixels, 320 * 172);
+  CHECK_EQ(LCD_GetStats().lastBytes, 320 * 172 * 2);
+}
+
+// Moving the selection repaints two rows: clearRow() covers x 35..319 and
+// 24 px of height around each row, and they are too far apart to merge.
+TEST(selection_move_sends_two_rows) {
+  CountingPanel panel;
+  RotaryMarqueeMenu menu;
+  StepInput input;
+  startMenu(menu, input);
+  panel.reset();
+
+  input.turns = 1;
+  menu.loop();
+  const uint32_t rowPx = (320 - 35) * 24;
+  CHECK_EQ(menu.getSelectedIndex(), 1);
+  CHECK_EQ(LCD_GetStats().frames, 1);
+  CHECK_EQ(panel.timing().rects, 2 * pushesFor(320 - 35, 24));
+  CHECK_EQ(panel.timing().pixels, 2 * rowPx);
+  CHECK_EQ(LCD_GetStats().lastBytes, 2 * rowPx * 2);
+}
+
+// A caret blink is a one-pixel-high bar CHAR_BODY_W wide (10 px at input size 2).
+TEST(caret_blink_sends_the_caret) {
+  CountingPanel panel;
+  LCD_Init();
+  LCD_SetOrientation(3);
+  SimpleRotaryController enc;
+  enc.begin(1, 2, 3, 4);
+  TextInputUI input("Title", "Description", 16);
+  input.begin(enc);
+  input.update();
+  panel.reset();
+
+  for (int blink = 0; blink < 4; ++blink) {
+    hostAdvanceMs(499);
+    input.update();
+    CHECK_EQ(LCD_GetStats().frames, 0u + blink);
+    hostAdvanceMs(1);
+    input.update();
+    CHECK_EQ(LCD_GetStats().frames, 1u + blink);
+    CHECK_EQ(LCD_GetStats().lastBytes, 10 * 1 * 2);
+  }
+  CHECK_EQ(panel.timing().rects, 4 * pushesFor(10, 1));
+  CHECK_EQ(panel.timing().pixels, 4 * 10);
+}
@@ -0,0 +1,167 @@
+// pwgen_tests.cpp - the password generator's output distribution: uniform
+// symbol and word choice, per-policy class counts, and an unbiased shuffle.
+//
+// The host RNG is seeded per test, so a pass is reproducible; the bounds are
+// loose enough (p ~ 1e-5) that a reseed would not start failing.
+
+#include "pp_sketch.h"
+#include "host_test.h"
+#include <math.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// Pearson's statistic.
+static double chiSquare(const std::vector<uint32_t>& counts, const std::vector<double>& expected) {
+  double x2 = 0;
+  for (size_t i = 0; i < counts.size(); ++i) {
+    const double d = counts[i] - expected[i];
+    x2 += d * d / expected[i];
+  }
+  return x2;
+}
+
+static double chiSquare(const std::vector<uint32_t>& counts, double expectedEach) {
+  return chiSquare(counts, std::vector<double>(counts.size(), expectedEach));
+}
+
+// Upper critical value at z = 4.3 (p ~ 1e-5), Wilson-Hilferty approximation.
+static double chiSquareLimit(size_t df) {
+  const double k = 2.0 / (9.0 * df);
+  const double c = 1.0 - k + 4.3 * sqrt(k);
+  return df * c * c * c;
+}
+
+#define CHECK_UNIFORM(x2, df)                                                   \
+  do {                                                                          \
+    const double x2_ = (x2), lim_ = chiSquareLimit(df);                         \
+    if (!(x2_ < lim_)) {                                                        \
+      char msg_[128];                                                           \
+      snprintf(msg_, sizeof(msg_), "chi-square %.1f >= %.1f (df %u)", x2_,      \
+               lim_, (unsigned)(df));                                           \
+      hostTestFail(__FILE__, __LINE__, msg_);                                   \
+    }                                                                           \
+  } while (0)
+
+// Set sizes the generator uses (6, 10, 26, the shuffle's i + 1, 7776) and the
+// byte/word boundary around 256. With 200 draws per value, the 100-way modulo
+// bias that rejection sampling removes scores about 800 against a limit of 172.
+TEST(uniform_is_unbiased) {
+  static const uint32_t kSizes[] = { 2, 3, 6, 10, 24, 26, 100, 255, 256, 257, 1000, 7776 };
+  hostSeedRandom(35);
+  PwEntropy e;
+  for (uint32_t n : kSizes) {
+    std::vector<uint32_t> counts(n);
+    const uint32_t draws = 200 * n;
+    for (uint32_t i = 0; i < draws; ++i) {
+      const uint32_t v = pwgen_uniform(e, n);
+      CHECK(v < n);
+      if (v < n) counts[v]++;
+    }
+    CHECK_UNIFORM(chiSquare(counts, 200.0), n - 1);
+  }
+  CHECK_EQ(pwgen_uniform(e, 1), 0);
+}
+
+// One-word passphrases are the word drawn; every list entry must turn up
+// equally often.
+TEST(passphrase_words_are_uniform) {
+  std::map<std::string, uint16_t> index;
+  for (uint16_t i = 0; i < PASSWORD_WORD_COUNT; ++i) index[kPassWords[i]] = i;
+  CHECK_EQ(index.size(), PASSWORD_WORD_COUNT);
+
+  hostSeedRandom(7776);
+  PwEntropy e;
+  SecureString out;
+  std::vector<uint32_t> counts(PASSWORD_WORD_COUNT);
+  const uint32_t perWord = 40;
+  for (uint32_t i = 0; i < perWord * PASSWORD_WORD_COUNT; ++i) {
+    CHECK(pwgen_passphrase(e, 1, out));
+    const auto it = index.find(out.c_str());
+    CHECK(it != index.end());
+    if (it != index.end()) counts[it->second]++;
+  }
+  CHECK_UNIFORM(chiSquare(counts, perWord), PASSWORD_WORD_COUNT - 1);
+}
+
+TEST(passphrase_policy_shape) {
+  const PwPolicy p = pwpolicy_resolve(4);
+  CHECK_EQ(p.words, 6);
+  hostSeedRandom(6);
+  PwEntropy e;
+  SecureString out;
+  for (int i = 0; i < 1000; ++i) {
+    CHECK(pwgen_next(e, p, out));
+    CHECK(out.length() >= 6 * 3 + 5 && out.length() <= 6 * 9 + 5);
+    size_t dashes = 0;
+    for (size_t j = 0; j < out.length(); ++j) {
+      const char c = out[j];
+      CHECK((c >= 'a' && c <= 'z') || c == '-');
+      dashes += c == '-';
+    }
+    CHECK(dashes >= 5);
+  }
+  CHECK(!pwgen_passphrase(e, 0, out));
+}
+
+enum CharClass { UPPER, LOWER, NUMBER, SYMBOL, OTHER };
+
+static CharClass classOf(char c) {
+  if (c >= 'A' && c <= 'Z') return UPPER;
+  if (c >= 'a' && c <= 'z') return LOWER;
+  if (c >= '0' && c <= '9') return NUMBER;
+  if (c && strchr("!@#_.-", c)) return SYMBOL;
+  return OTHER;
+}
+
+// Every character policy yields exactly its class counts, and SETTINGS follows
+// g_settings.
+TEST(policies_yield_class_counts) {
+  g_settings.uppercase = 2;
+  g_settings.lowercase = 7;
+  g_settings.number = 0;
+  g_settings.symbol = 4;
+  hostSeedRandom(16);
+  PwEntropy e;
+  SecureString out;
+  for (uint8_t id = 0; id < PW_POLICY_COUNT; ++id) {
+    const PwPolicy p = pwpolicy_resolve(id);
+    if (p.words) continue;
+    const uint8_t want[4] = { p.uppercase, p.lowercase, p.number, p.symbol };
+    for (int i = 0; i < 500; ++i) {
+      CHECK(pwgen_next(e, p, out));
+      CHECK_EQ(out.length(), want[0] + want[1] + want[2] + want[3]);
+      uint8_t got[5] = { 0 };
+      for (size_t j = 0; j < out.length(); ++j) got[classOf(out[j])]++;
+      for (int c = 0; c < 4; ++c) CHECK_EQ(got[c], want[c]);
+      CHECK_EQ(got[OTHER], 0);
+    }
+  }
+
+  const PwPolicy empty = { "EMPTY", 0, 0, 0, 0, 0 };
+  CHECK(!pwgen_next(e, empty, out));
+}
+
+// After Fisher-Yates every position holds each class in proportion to the
+// class count; a biased shuffle leaves the fill order (U, L, S, N) showing.
+TEST(shuffle_positions_are_uniform) {
+  const PwPolicy p = pwpolicy_resolve(3);  // STRONG 24: 6 of each class
+  const size_t len = (size_t)p.uppercase + p.lowercase + p.number + p.symbol;
+  const uint32_t samples = 20000;
+  hostSeedRandom(24);
+  PwEntropy e;
+  SecureString out;
+  std::vector<std::vector<uint32_t>> counts(len, std::vector<uint32_t>(4));
+  for (uint32_t i = 0; i < samples; ++i) {
+    CHECK(pwgen_next(e, p, out));
+    for (size_t j = 0; j < len && j < out.length(); ++j) {
+      const CharClass c = classOf(out[j]);
+      if (c != OTHER) counts[j][c]++;
+    }
+  }
+  const std::vector<double> expected = {
+    samples * (double)p.uppercase / len, samples * (double)p.lowercase / len,
+    samples * (double)p.number / len, samples * (double)p.symbol / len,
+  };
+  for (size_t j = 0; j < len; ++j) CHECK_UNIFORM(chiSquare(counts[j], expected), 3);
+}
@@ -0,0 +1,260 @@
+// render_bench.cpp - host timings of the render and present paths.
+//
+// Wall-clock numbers from a PC only rank changes against each other; the
+// pixel and rect counts are what the panel would see on the device.
+
+#include <Arduino.h>
+#include "Display_ST7789.h"
+#include "HostDisplayBackend.h"
+#include "MenuInput.h"
+#include "RotaryMarqueeMenu.h"
+#include "fonts/BitmapFont.h"
+#include <vector>
+
+class IdleInput : public MenuInput {
+public:
+  bool cw = false;
+  void update() override {}
+  bool wasTurnedCW() override { const bool f = cw; cw = false; return f; }
+  bool wasTurnedCCW() override { return false; }
+  bool wasPressedA() override { return false; }
+  bool wasPressedB() override { return false; }
+};
+
+static void report(const char* what, uint64_t ns, const HostDisplayBackend& panel, uint32_t reps) {
+  const HostDisplayBackend::Timing& t = panel.timing();
+  printf("%-28s %9.2f us/op  %6.1f rects/op  %9.1f px/op\n", what, ns / 1000.0,
+         reps ? (double)t.rects / reps : 0.0, reps ? (double)t.pixels / reps : 0.0);
+}
+
+// Text straight into a 16-bit buffer, without the present, for the glyph path.
+static const char kLine[] = "The quick brown fox 0123456789!";
+
+static void benchFont(const char* what, uint8_t size, bool opaque) {
+  const uint16_t w = 320, h = 40;
+  std::vector<uint16_t> buf((size_t)w * h);
+  const uint32_t reps = 20000;
+  volatile uint16_t sink = 0;
+  const uint64_t ns = HostDisplayBackend::timeNs([&] {
+    sink = fontDrawString<uint16_t>(buf.data(), w, h, 0, 0, kLine, 0xFFFF, 0x0000, opaque, size);
+  }, reps);
+  (void)sink;
+  printf("%-28s %9.3f us/op  %6.1f ns/char\n", what, ns / 1000.0, (double)ns / (sizeof(kLine) - 1));
+}
+
+// ---- The TFT_eSPI path the engine replaced ----
+// TFT_eSPI does not build on the host, so this is a model of what its sprite
+// did for font 1, written after TFT_eSprite::drawChar/drawPixel/fillRect and
+// TFT_eSPI::textWidth/drawString: a column-major glyph table, one drawPixel
+// (bounds check and byte swap) per cell pixel, one fillRect per pixel when
+// scaled, and a textWidth() that walks the string. The library calls are kept
+// out of line, as they were behind TFT_eSPI's translation unit.
+class LegacySprite {
+public:
+  LegacySprite(uint16_t w, uint16_t h) : w_(w), h_(h), img_((size_t)w * h) {
+    for (uint8_t g = 0; g < FONT_GLYPH_COUNT; ++g) {
+      for (uint8_t c = 0; c < FONT_GLYPH_W; ++c) {
+        uint8_t col = 0;
+        for (uint8_t r = 0; r < FONT_CELL_H; ++r) col |= (uint8_t)(((font5x7Rows[g][r] >> c) & 1U) << r);
+        cols_[g][c] = col;
+      }
+    }
+  }
+
+  void setText(uint16_t fg, uint16_t bg, bool fill, uint8_t size) {
+    fg_ = fg; bg_ = bg; fill_ = fill; size_ = size ? size : 1;
+  }
+
+  __attribute__((noinline)) int16_t textWidth(const char* s) {
+    if (smooth_) return 0;
+    int16_t w = 0;
+    if (font_ == 1) {
+      while (*s++) w += 6;
+    }
+    return (int16_t)(w * size_);
+  }
+
+  __attribute__((noinline)) int16_t drawString(const char* s, int32_t x, int32_t y) {
+    // Datum and padding work starts from the full width.
+    volatile int16_t sw = textWidth(s);
+    (void)sw;
+    const int32_t x0 = x;
+    for (; *s; ++s) x += drawChar(x, y, *s);
+    return (int16_t)(x - x0);
+  }
+
+  const uint16_t* pixels() const { return img_.data(); }
+
+private:
+  uint16_t w_, h_;
+  std::vector<uint16_t> img_;
+  uint8_t cols_[FONT_GLYPH_COUNT][FONT_GLYPH_W];
+  uint16_t fg_ = 0xFFFF, bg_ = 0;
+  bool fill_ = false, smooth_ = false;
+  uint8_t size_ = 1, font_ = 1;
+
+  __attribute__((noinline)) void drawPixel(int32_t x, int32_t y, uint16_t c) {
+    if (x < 0 || y < 0 || x >= w_ || y >= h_) return;
+    img_[(size_t)x + (size_t)y * w_] = (uint16_t)((c >> 8) | (c << 8));
+  }
+
+  __attribute__((noinline)) void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t c) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > w_) w = w_ - x;
+    if (y + h > h_) h = h_ - y;
+    if (w < 1 || h < 1) return;
+    const uint16_t sc = (uint16_t)((c >> 8) | (c << 8));
+    for (int32_t yy = y; yy < y + h; ++yy) {
+      uint16_t* row = &img_[(size_t)yy * w_];
+      for (int32_t xx = x; xx < x + w; ++xx) row[xx] = sc;
+    }
+  }
+
+  int16_t drawChar(int32_t x, int32_t y, char ch) {
+    const uint8_t u = (uint8_t)ch;
+    if (u < FONT_FIRST_CHAR || u >= FONT_FIRST_CHAR + FONT_GLYPH_COUNT) return (int16_t)(6 * size_);
+    const uint8_t* glyph = cols_[u - FONT_FIRST_CHAR];
+    if (size_ == 1 && fill_) {
+      uint8_t column[6];
+      for (uint8_t i = 0; i < 5; ++i) column[i] = glyph[i];
+      column[5] = 0;
+      uint8_t mask = 1;
+      for (int8_t j = 0; j < 8; ++j, mask <<= 1) {
+        for (int8_t k = 0; k < 6; ++k) drawPixel(x + k, y + j, (column[k] & mask) ? fg_ : bg_);
+      }
+    } else {
+      for (int8_t i = 0; i < 6; ++i) {
+        uint8_t line = i == 5 ? 0 : glyph[i];
+        for (int8_t j = 0; j < 8; ++j, line >>= 1) {
+          if (size_ == 1) {
+            if (line & 1) drawPixel(x + i, y + j, fg_);
+          } else if (line & 1) {
+            fillRect(x + i * size_, y + j * size_, size_, size_, fg_);
+          } else if (fill_) {
+            fillRect(x + i * size_, y + j * size_, size_, size_, bg_);
+          }
+        }
+      }
+    }
+    return (int16_t)(6 * size_);
+  }
+};
+
+static void benchLegacyFont(const char* what, uint8_t size, bool opaque) {
+  LegacySprite sprite(320, 40);
+  sprite.setText(0xFFFF, 0x0000, opaque, size);
+  const uint32_t reps = 20000;
+  volatile int16_t sink = 0;
+  const uint64_t ns = HostDisplayBackend::timeNs([&] { sink = sprite.drawString(kLine, 0, 0); }, reps);
+  (void)sink;
+  printf("%-28s %9.3f us/op  %6.1f ns/char\n", what, ns / 1000.0, (double)ns / (sizeof(kLine) - 1));
+}
+
+// Laying out a paragraph the way drawStringWrapWidth does: the old routines
+// measured every character with textWidth() on a one-character string, the
+// engine reads a constant advance.
+static const char kParagraph[] =
+    "Pocket Pass keeps every password on this card, sealed with a key that "
+    "never leaves the device. Turn the knob to pick an entry and press to type it.";
+
+template <typename CharWidth>
+static uint16_t wrapLines(uint16_t maxWidthPx, CharWidth charWidth) {
+  uint16_t lines = 1, lineW = 0;
+  for (const char* p = kParagraph; *p;) {
+    const char* end = p;
+    int16_t tokenW = 0;
+    if (*p == ' ') {
+      while (*end == ' ') ++end;
+      tokenW = charWidth(' ');
+    } else {
+      while (*end && *end != ' ') tokenW += charWidth(*end++);
+    }
+    if (lineW && lineW + tokenW > maxWidthPx) { ++lines; lineW = 0; }
+    if (*p != ' ' || lineW) lineW = (uint16_t)(lineW + tokenW);
+    p = end;
+  }
+  return lines;
+}
+
+static void benchWrapMeasure() {
+  LegacySprite sprite(1, 1);
+  sprite.setText(0xFFFF, 0x0000, false, 2);
+  const uint32_t reps = 20000;
+  volatile uint16_t sink = 0;
+  const double chars = sizeof(kParagraph) - 1;
+  uint64_t ns = HostDisplayBackend::timeNs([&] {
+    sink = wrapLines(228, [&](char c) { char tmp[2] = { c, 0 }; return sprite.textWidth(tmp); });
+  }, reps);
+  printf("%-28s %9.3f us/op  %6.1f ns/char\n", "wrap measure, TFT_eSPI", ns / 1000.0, ns / chars);
+  ns = HostDisplayBackend::timeNs([&] {
+    sink = wrapLines(228, [](char c) { return (int16_t)fontCharWidth(c, 2); });
+  }, reps);
+  printf("%-28s %9.3f us/op  %6.1f ns/char\n", "wrap measure, engine", ns / 1000.0, ns / chars);
+  (void)sink;
+}
+
+int main() {
+  benchFont("font size 1, opaque", 1, true);
+  benchFont("font size 1, transparent", 1, false);
+  benchFont("font size 2, opaque", 2, true);
+  benchFont("font size 2, transparent", 2, false);
+  benchLegacyFont("TFT_eSPI size 1, opaque", 1, true);
+  benchLegacyFont("TFT_eSPI size 1, transparent", 1, false);
+  benchLegacyFont("TFT_eSPI size 2, opaque", 2, true);
+  benchLegacyFont("TFT_eSPI size 2, transparent", 2, false);
+  benchWrapMeasure();
+
+  HostDisplayBackend panel;
+  LCD_SetBackend(&panel);
+  UI_SetPalette(0);
+
+  static const char* items[] = {
+    "Email", "Banking", "A rather long entry name that has to scroll", "Social", "Work",
+  };
+  RotaryMarqueeMenu menu;
+  IdleInput input;
+  menu.begin(input, 3, 80);
+  menu.setTitle("Pocket Pass");
+  menu.setSubTitle("Categories");
+  menu.setMenu(items, 5);
+
+  const uint32_t reps = 2000;
+
+  panel.resetTiming();
+  uint64_t ns = HostDisplayBackend::timeNs([] {
+    LCD_Clear(UI_ColorBg());
+    LCD_Present();
+  }, reps);
+  report("full clear + present", ns, panel, reps);
+
+  panel.resetTiming();
+  ns = HostDisplayBackend::timeNs([] {
+    LCD_FillRect(10, 10, 120, 20, UI_ColorBg());
+    drawString(10, 10, "Pocket Pass 0123", UI_ColorFg(), UI_ColorBg(), 2, false);
+    LCD_Present();
+  }, reps);
+  report("text line + present", ns, panel, reps);
+
+  panel.resetTiming();
+  uint8_t sel = 0;
+  ns = HostDisplayBackend::timeNs([&] {
+    menu.setSelectedIndex((int8_t)(sel++ & 1));
+  }, reps);
+  report("menu selection move", ns, panel, reps);
+
+  menu.setSelectedIndex(2);
+  hostAdvanceMs(2000);
+  menu.loop();
+  panel.resetTiming();
+  ns = HostDisplayBackend::timeNs([&] {
+    hostAdvanceMs(20);
+    menu.loop();
+  }, reps);
+  report("marquee step (20 ms)", ns, panel, reps);
+
+  panel.resetTiming();
+  ns = HostDisplayBackend::timeNs([] { LCD_Present(); }, reps);
+  report("present, nothing dirty", ns, panel, reps);
+  return 0;
+}
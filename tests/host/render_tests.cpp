@@ -0,0 +1,256 @@
+// render_tests.cpp - golden frames for the menu, its marquees and the
+// passcode screensaver, rendered into a HostDisplayBackend.
+
+#include "host_test.h"
+#include <Arduino.h>
+#include <deque>
+#include "Display_ST7789.h"
+#include "HostDisplayBackend.h"
+#include "MenuInput.h"
+#include "RotaryMarqueeMenu.h"
+#include "SimpleRotaryController.h"
+#include "fonts/BitmapFont.h"
+
+// The screensaver lives in the sketch; give it the two things it borrows from
+// 10_app_decl.ino.
+#define PP_SAVER_POLL_MS 20
+static SimpleRotaryController g_rotary;
+#include "21_screensaver.ino"
+
+// Menu input fed from a script: each loop() consumes one queued event.
+class ScriptedInput : public MenuInput {
+public:
+  enum Event { CW, CCW, BACK, SELECT };
+  void push(Event e) { events_.push_back(e); }
+
+  void update() override {
+    cw_ = ccw_ = a_ = b_ = false;
+    if (events_.empty()) return;
+    const Event e = events_.front();
+    events_.pop_front();
+    cw_ = e == CW;
+    ccw_ = e == CCW;
+    a_ = e == BACK;
+    b_ = e == SELECT;
+  }
+  bool wasTurnedCW() override { return take(cw_); }
+  bool wasTurnedCCW() override { return take(ccw_); }
+  bool wasPressedA() override { return take(a_); }
+  bool wasPressedB() override { return take(b_); }
+
+private:
+  std::deque<Event> events_;
+  bool cw_ = false, ccw_ = false, a_ = false, b_ = false;
+  static bool take(bool& f) { const bool v = f; f = false; return v; }
+};
+
+static const char* kItems[] = {
+  "Email",
+  "Banking",
+  "A rather long entry name that has to scroll",
+  "Social",
+  "Work",
+  "Shopping",
+};
+static const uint8_t kItemCount = sizeof(kItems) / sizeof(kItems[0]);
+
+// A panel that is the display backend for the life of one test. Every test
+// starts from the same clock, pins and palette.
+class TestPanel : public HostDisplayBackend {
+public:
+  explicit TestPanel(uint8_t palette) {
+    hostSetMillis(1000);
+    hostSetDelayHook(nullptr);
+    for (uint8_t pin = 0; pin < 8; ++pin) hostSetPin(pin, HIGH);
+    UI_SetPalette(palette);
+    LCD_SetBackend(this);
+  }
+  ~TestPanel() { LCD_SetBackend(nullptr); }
+};
+
+static void startMenu(RotaryMarqueeMenu& menu, ScriptedInput& input, const char* subtitle) {
+  menu.begin(input, 3, 80);
+  menu.setTitle("Pocket Pass");
+  menu.setSubTitle(subtitle);
+  menu.setMenu(kItems, kItemCount);
+}
+
+static void runMenuFor(RotaryMarqueeMenu& menu, unsigned long ms) {
+  for (unsigned long t = 0; t < ms; t += 10) {
+    hostAdvanceMs(10);
+    menu.loop();
+  }
+}
+
+TEST(menu_initial_frame) {
+  TestPanel panel(0);
+  RotaryMarqueeMenu menu;
+  ScriptedInput input;
+  startMenu(menu, input, "Categories");
+  CHECK_EQ(panel.width(), 320);
+  CHECK_EQ(panel.height(), 172);
+  CHECK_GOLDEN("menu_initial", panel);
+}
+
+TEST(menu_selection_moves) {
+  TestPanel panel(0);
+  RotaryMarqueeMenu menu;
+  ScriptedInput input;
+  startMenu(menu, input, "Categories");
+
+  input.push(ScriptedInput::CW);
+  menu.loop();
+  CHECK_EQ(menu.getSelectedIndex(), 1);
+  CHECK_GOLDEN("menu_select_1", panel);
+
+  // Past the last visible row the window scrolls.
+  for (int i = 0; i < 3; ++i) input.push(ScriptedInput::CW);
+  for (int i = 0; i < 3; ++i) menu.loop();
+  CHECK_EQ(menu.getSelectedIndex(), 4);
+  CHECK_GOLDEN("menu_select_4", panel);
+
+  input.push(ScriptedInput::CCW);
+  menu.loop();
+  CHECK_EQ(menu.getSelectedIndex(), 3);
+  CHECK_GOLDEN("menu_select_3", panel);
+}
+
+TEST(menu_row_marquee) {
+  TestPanel panel(0);
+  RotaryMarqueeMenu menu;
+  ScriptedInput input;
+  startMenu(menu, input, "Categories");
+  input.push(ScriptedInput::CW);
+  input.push(ScriptedInput::CW);
+  menu.loop();
+  menu.loop();
+  CHECK_GOLDEN("marquee_row_rest", panel);
+
+  // Nothing moves before the start delay.
+  const uint32_t rest = panel.crc32();
+  runMenuFor(menu, 900);
+  CHECK_EQ(panel.crc32(), rest);
+
+  runMenuFor(menu, 1100);
+  CHECK(panel.crc32() != rest);
+  CHECK_GOLDEN("marquee_row_2s", panel);
+  runMenuFor(menu, 3000);
+  CHECK_GOLDEN("marquee_row_5s", panel);
+}
+
+TEST(menu_subtitle_marquee) {
+  TestPanel panel(3);
+  RotaryMarqueeMenu menu;
+  ScriptedInput input;
+  startMenu(menu, input, "Subtitle long enough to need the marquee");
+  CHECK_GOLDEN("marquee_sub_rest", panel);
+  runMenuFor(menu, 2000);
+  CHECK_GOLDEN("marquee_sub_2s", panel);
+  runMenuFor(menu, 4000);
+  CHECK_GOLDEN("marquee_sub_6s", panel);
+}
+
+// Runs the screensaver for the named palette, capturing golden frames at a
+// few simulated times, then presses select and expects it to return.
+static void checkSaver(const char* palette) {
+  uint8_t idx = 0;
+  while (idx < UI_PaletteCount() && strcmp(UI_PaletteName(idx), palette) != 0) ++idx;
+  CHECK(idx < UI_PaletteCount());
+
+  TestPanel panel(idx);
+  LCD_Init();
+  LCD_SetOrientation(3);
+  g_rotary.begin(1, 2, 3, 4);
+
+  static const unsigned long kShotsMs[] = { 0, 1000, 4000 };
+  const unsigned long t0 = millis();
+  size_t shot = 0;
+  hostSetDelayHook([&](unsigned long now) {
+    if (shot < 3 && now - t0 >= kShotsMs[shot]) {
+      char name[48];
+      snprintf(name, sizeof(name), "saver_%s_%lus", palette, kShotsMs[shot] / 1000);
+      for (char* p = name; *p; ++p) *p = (char)tolower((unsigned char)*p);
+      CHECK_GOLDEN(name, panel);
+      shot++;
+    }
+    if (shot == 3) hostSetPin(4, LOW);
+  });
+  runPasscodeScreensaver();
+  hostSetDelayHook(nullptr);
+  CHECK_EQ(shot, 3);
+}
+
+TEST(saver_matrix)   { checkSaver("MATRIX"); }
+TEST(saver_pipboy)   { checkSaver("PIPBOY"); }
+TEST(saver_terminal) { checkSaver("TERMINAL"); }
+TEST(saver_mono)     { checkSaver("MONO"); }
+TEST(saver_ice)      { checkSaver("ICE"); }
+TEST(saver_amber)    { checkSaver("AMBER"); }
+TEST(saver_orbit)    { checkSaver("OCEAN"); }
+
+// The same menu in every palette; the indexed build must match these frames
+// exactly, including palettes where two roles share a colour (TERMINAL's
+// foreground is its selection background).
+TEST(menu_every_palette) {
+  for (uint8_t i = 0; i < UI_PaletteCount(); ++i) {
+    TestPanel panel(i);
+    RotaryMarqueeMenu menu;
+    ScriptedInput input;
+    startMenu(menu, input, UI_PaletteName(i));
+    char name[48];
+    snprintf(name, sizeof(name), "palette_%s", UI_PaletteName(i));
+    for (char* p = name; *p; ++p) *p = (char)tolower((unsigned char)*p);
+    CHECK_GOLDEN(name, panel);
+  }
+}
+
+// Switching palettes in RGB565 leaves what is on screen alone until it is
+// redrawn. The indexed framebuffer holds palette colours by role, so there the
+// switch alone recolours the frame. Either way the result matches a menu
+// started in the new palette.
+TEST(palette_switch) {
+  for (uint8_t from = 0; from < UI_PaletteCount(); ++from) {
+    const uint8_t to = (uint8_t)((from + 1) % UI_PaletteCount());
+    TestPanel panel(from);
+    RotaryMarqueeMenu menu;
+    ScriptedInput input;
+    startMenu(menu, input, UI_PaletteName(to));
+    const uint32_t before = panel.crc32();
+
+    UI_SetPalette(to);
+    LCD_Present();
+#if LCD_INDEXED_FRAMEBUFFER
+    (void)before;
+#else
+    CHECK_EQ(panel.crc32(), before);
+    startMenu(menu, input, UI_PaletteName(to));
+#endif
+    char name[48];
+    snprintf(name, sizeof(name), "palette_%s", UI_PaletteName(to));
+    for (char* p = name; *p; ++p) *p = (char)tolower((unsigned char)*p);
+    CHECK_GOLDEN(name, panel);
+  }
+}
+
+// Control characters are blank cells; bytes 128..255 (here a UTF-8 e-acute)
+// draw the fallback box. Both still take one cell each.
+TEST(font_fallback_glyphs) {
+  TestPanel panel(1);
+  LCD_Init();
+  LCD_SetOrientation(3);
+  LCD_Clear(UI_ColorBg());
+  for (uint8_t r = 0; r < FONT_CELL_H; ++r) {
+    CHECK_EQ(fontGlyphRow('\t', r), 0);
+    CHECK_EQ(fontGlyphRow('\x7F', r), 0);
+    CHECK_EQ(fontGlyphRow('\xC3', r), fontGlyphRow('\xFF', r));
+  }
+  CHECK_EQ(fontGlyphRow('\x80', 0), 0x1F);
+  CHECK_EQ(fontGlyphRow('\x80', 1), 0x11);
+  CHECK_EQ(fontTextWidth("caf\xC3\xA9", 2), 5 * 12);
+
+  drawString(10, 10, "caf\xC3\xA9 [\t] ok", UI_ColorFg(), UI_ColorBg(), 2, false);
+  drawString(10, 40, "ASCII 32..126: !\"#$%&'()*+,-./09:;<=>?@AZ[\\]^_`az{|}~",
+             UI_ColorFg(), UI_ColorBg(), 1, false);
+  LCD_Present();
+  CHECK_GOLDEN("font_fallback", panel);
+}
@@ -0,0 +1,79 @@
+// Arduino.cpp - simulated clock, pins and Serial for host builds.
+
+#include "Arduino.h"
+#include <chrono>
+
+HardwareSerial Serial;
+
+static unsigned long long s_now_us = 0;
+static bool s_wall_clock = false;
+static std::chrono::steady_clock::time_point s_wall_start;
+static uint8_t s_pins[64];
+static bool s_pins_init = false;
+static std::function<void(unsigned long)> s_delay_hook;
+
+size_t Print::printf(const char* fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  if (n <= 0) return 0;
+  return write((const uint8_t*)buf, std::min<size_t>((size_t)n, sizeof(buf) - 1));
+}
+
+size_t HardwareSerial::write(const uint8_t* p, size_t n) {
+  static const bool enabled = getenv("PP_HOST_SERIAL") != nullptr;
+  if (enabled) fwrite(p, 1, n, stderr);
+  return n;
+}
+
+static unsigned long long nowUs() {
+  if (!s_wall_clock) return s_now_us;
+  const auto elapsed = std::chrono::steady_clock::now() - s_wall_start;
+  return s_now_us + std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+unsigned long millis() { return (unsigned long)(nowUs() / 1000); }
+unsigned long micros() { return (unsigned long)nowUs(); }
+
+void delay(unsigned long ms) {
+  s_now_us += (unsigned long long)ms * 1000;
+  if (s_delay_hook) s_delay_hook(millis());
+}
+
+void delayMicroseconds(unsigned int us) { s_now_us += us; }
+void yield() {}
+
+static void pinsInit() {
+  if (s_pins_init) return;
+  memset(s_pins, HIGH, sizeof(s_pins));
+  s_pins_init = true;
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+  pinsInit();
+  return pin < sizeof(s_pins) ? s_pins[pin] : HIGH;
+}
+
+void hostAdvanceMs(unsigned long ms) { s_now_us += (unsigned long long)ms * 1000; }
+void hostSetMillis(unsigned long ms) {
+  s_now_us = (unsigned long long)ms * 1000;
+  s_wall_start = std::chrono::steady_clock::now();
+}
+
+void hostUseWallClock(bool on) {
+  s_now_us = nowUs();  // keep the clock monotonic across the switch
+  s_wall_clock = on;
+  s_wall_start = std::chrono::steady_clock::now();
+}
+
+void hostSetPin(uint8_t pin, int level) {
+  pinsInit();
+  if (pin < sizeof(s_pins)) s_pins[pin] = level ? HIGH : LOW;
+}
+
+void hostSetDelayHook(std::function<void(unsigned long)> hook) { s_delay_hook = hook; }
@@ -0,0 +1,235 @@
+// Arduino.h - host stand-in for the parts of the Arduino core this project uses.
+//
+// Time is simulated: millis()/micros() only move when the code under test calls
+// delay() or a test calls hostAdvanceMs(), so a frame sequence renders the same
+// way on every run. Benchmarks that time sketch code with micros() switch to the
+// real clock with hostUseWallClock(). Pins read HIGH (idle, pulled up) until
+// hostSetPin().
+//
+// Like the ESP32 core's Arduino.h it also pulls in FreeRTOS, the ESP-IDF
+// basics and the ESP object; those live in esp32.cpp.
+#pragma once
+
+#include <algorithm>
+#include <ctype.h>
+#include <functional>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+#include <vector>
+
+#define PROGMEM
+#define PGM_P const char*
+#define F(s) (s)
+#define pgm_read_byte(p)  (*(const uint8_t*)(p))
+#define pgm_read_word(p)  (*(const uint16_t*)(p))
+#define pgm_read_dword(p) (*(const uint32_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define IRAM_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+using std::max;
+using std::min;
+
+// ---- String ----
+class String {
+public:
+  String() {}
+  String(const char* s) : s_(s ? s : "") {}
+  String(const char* s, size_t n) : s_(s, n) {}
+  String(char c) : s_(1, c) {}
+  String(int v) : s_(std::to_string(v)) {}
+  String(unsigned v) : s_(std::to_string(v)) {}
+  String(long v) : s_(std::to_string(v)) {}
+  String(unsigned long v) : s_(std::to_string(v)) {}
+  String(long long v) : s_(std::to_string(v)) {}
+  String(unsigned long long v) : s_(std::to_string(v)) {}
+  String(double v, unsigned decimals = 2) {
+    char b[48];
+    snprintf(b, sizeof(b), "%.*f", (int)decimals, v);
+    s_ = b;
+  }
+
+  const char* c_str() const { return s_.c_str(); }
+  unsigned length() const { return (unsigned)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  bool reserve(unsigned n) { s_.reserve(n); return true; }
+  char operator[](unsigned i) const { return i < s_.size() ? s_[i] : 0; }
+  char& operator[](unsigned i) { return s_[i]; }
+  char charAt(unsigned i) const { return (*this)[i]; }
+  void setCharAt(unsigned i, char c) { if (i < s_.size()) s_[i] = c; }
+  char* begin() { return &s_[0]; }
+  char* end() { return &s_[0] + s_.size(); }
+  const char* begin() const { return s_.data(); }
+  const char* end() const { return s_.data() + s_.size(); }
+
+  String& operator+=(const String& o) { s_ += o.s_; return *this; }
+  String& operator+=(const char* o) { if (o) s_ += o; return *this; }
+  String& operator+=(char c) { s_ += c; return *this; }
+  String& operator+=(int v) { s_ += std::to_string(v); return *this; }
+  String& operator+=(unsigned v) { s_ += std::to_string(v); return *this; }
+  String& operator+=(long v) { s_ += std::to_string(v); return *this; }
+  String& operator+=(unsigned long v) { s_ += std::to_string(v); return *this; }
+  bool concat(const String& o) { s_ += o.s_; return true; }
+  bool concat(const char* o) { if (o) s_ += o; return true; }
+  bool concat(const char* o, unsigned n) { s_.append(o, n); return true; }
+  bool concat(char c) { s_ += c; return true; }
+
+  bool operator==(const String& o) const { return s_ == o.s_; }
+  bool operator==(const char* o) const { return s_ == (o ? o : ""); }
+  bool operator!=(const String& o) const { return !(*this == o); }
+  bool operator!=(const char* o) const { return !(*this == o); }
+  bool operator<(const String& o) const { return s_ < o.s_; }
+  bool equals(const String& o) const { return s_ == o.s_; }
+  bool equalsIgnoreCase(const String& o) const { return strcasecmp(c_str(), o.c_str()) == 0; }
+  int compareTo(const String& o) const { return s_.compare(o.s_); }
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0; }
+  bool endsWith(const String& p) const {
+    return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0;
+  }
+
+  int indexOf(char c, unsigned from = 0) const { return pos(s_.find(c, from)); }
+  int indexOf(const String& o, unsigned from = 0) const { return pos(s_.find(o.s_, from)); }
+  int lastIndexOf(char c) const { return pos(s_.rfind(c)); }
+  String substring(unsigned from) const { return from < s_.size() ? String(s_.substr(from).c_str()) : String(); }
+  String substring(unsigned from, unsigned to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= s_.size()) return String();
+    return String(s_.data() + from, std::min<size_t>(to, s_.size()) - from);
+  }
+
+  void trim() {
+    size_t a = 0, b = s_.size();
+    while (a < b && isspace((unsigned char)s_[a])) ++a;
+    while (b > a && isspace((unsigned char)s_[b - 1])) --b;
+    s_ = s_.substr(a, b - a);
+  }
+  void toLowerCase() { for (auto& c : s_) c = (char)tolower((unsigned char)c); }
+  void toUpperCase() { for (auto& c : s_) c = (char)toupper((unsigned char)c); }
+  void replace(const String& from, const String& to) {
+    if (from.s_.empty()) return;
+    for (size_t p = 0; (p = s_.find(from.s_, p)) != std::string::npos; p += to.s_.size()) {
+      s_.replace(p, from.s_.size(), to.s_);
+    }
+  }
+  void remove(unsigned index) { if (index < s_.size()) s_.erase(index); }
+  void remove(unsigned index, unsigned count) { if (index < s_.size()) s_.erase(index, count); }
+  long toInt() const { return atol(c_str()); }
+  void getBytes(unsigned char* buf, unsigned n, unsigned index = 0) const {
+    if (!n) return;
+    size_t k = index < s_.size() ? std::min<size_t>(n - 1, s_.size() - index) : 0;
+    if (k) memcpy(buf, s_.data() + index, k);
+    buf[k] = 0;
+  }
+  void toCharArray(char* buf, unsigned n, unsigned index = 0) const { getBytes((unsigned char*)buf, n, index); }
+
+private:
+  std::string s_;
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+};
+
+inline String operator+(const String& a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, const char* b) { String r(a); r += b; return r; }
+inline String operator+(const char* a, const String& b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, char b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, int b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, unsigned b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, long b) { String r(a); r += b; return r; }
+inline String operator+(const String& a, unsigned long b) { String r(a); r += b; return r; }
+
+// ---- Print / Serial ----
+// Serial goes to stderr only when PP_HOST_SERIAL is set, so test output stays readable.
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) { return write(&c, 1); }
+  virtual size_t write(const uint8_t* p, size_t n) = 0;
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+  size_t print(const char* s) { return write(s ? s : ""); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(long v) { return printf("%ld", v); }
+  size_t print(unsigned long v) { return printf("%lu", v); }
+  size_t print(int v) { return print((long)v); }
+  size_t print(unsigned v) { return print((unsigned long)v); }
+  size_t print(double v) { return printf("%.2f", v); }
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + print("\r\n"); }
+  size_t println() { return print("\r\n"); }
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  virtual int peek() { return -1; }
+  virtual void flush() {}
+  size_t readBytes(uint8_t* buf, size_t n) {
+    size_t got = 0;
+    for (int c; got < n && (c = read()) >= 0;) buf[got++] = (uint8_t)c;
+    return got;
+  }
+  size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
+  String readStringUntil(char end) {
+    String s;
+    for (int c; (c = read()) >= 0 && c != end;) s += (char)c;
+    return s;
+  }
+};
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long) {}
+  void setDebugOutput(bool) {}
+  operator bool() const { return true; }
+  size_t write(const uint8_t* p, size_t n) override;
+  using Print::write;
+};
+extern HardwareSerial Serial;
+
+// ---- Time, pins ----
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+
+// ---- Host controls (tests only) ----
+void hostAdvanceMs(unsigned long ms);
+void hostSetMillis(unsigned long ms);
+// While on, millis()/micros() also advance with real elapsed time.
+void hostUseWallClock(bool on);
+void hostSetPin(uint8_t pin, int level);
+// Called from delay() after the clock moved; lets a test act at given times.
+void hostSetDelayHook(std::function<void(unsigned long now)> hook);
+
+#include "Esp.h"
+#include "driver/gpio.h"
+#include "esp_heap_caps.h"
+#include "esp_random.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
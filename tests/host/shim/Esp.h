@@ -0,0 +1,18 @@
+// Esp.h - host stand-in for the ESP object; reports a fixed, roomy heap.
+#pragma once
+
+#include <stdint.h>
+
+class EspClass {
+public:
+  [[noreturn]] void restart();
+  uint32_t getFreeHeap() { return 256 * 1024; }
+  uint32_t getMinFreeHeap() { return 256 * 1024; }
+  uint32_t getMaxAllocHeap() { return 128 * 1024; }
+  uint32_t getHeapSize() { return 320 * 1024; }
+  uint32_t getFreePsram() { return 0; }
+  uint32_t getPsramSize() { return 0; }
+  uint32_t getFlashChipSize() { return 16u * 1024 * 1024; }
+  uint32_t getCpuFreqMHz() { return 240; }
+};
+extern EspClass ESP;
@@ -0,0 +1,49 @@
+// FS.h - file system interface with nothing behind it: every open fails, so
+// code paths that need the SD card report it missing.
+#pragma once
+
+#include <Arduino.h>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+class File : public Stream {
+public:
+  size_t write(const uint8_t*, size_t) override { return 0; }
+  using Print::write;
+  size_t read(uint8_t*, size_t) { return 0; }
+  int read() override { return -1; }
+  size_t size() const { return 0; }
+  size_t position() const { return 0; }
+  bool seek(uint32_t) { return false; }
+  void close() {}
+  explicit operator bool() const { return false; }
+  bool isDirectory() { return false; }
+  File openNextFile() { return File(); }
+  const char* name() const { return ""; }
+  const char* path() const { return ""; }
+  void rewindDirectory() {}
+};
+
+class FS {
+public:
+  File open(const char*, const char* = FILE_READ, bool = false) { return File(); }
+  File open(const String& path, const char* mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+  bool exists(const char*) { return false; }
+  bool exists(const String&) { return false; }
+  bool remove(const char*) { return false; }
+  bool remove(const String&) { return false; }
+  bool rename(const char*, const char*) { return false; }
+  bool rename(const String&, const String&) { return false; }
+  bool mkdir(const char*) { return false; }
+  bool mkdir(const String&) { return false; }
+  bool rmdir(const char*) { return false; }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
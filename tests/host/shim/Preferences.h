@@ -0,0 +1,79 @@
+// Preferences.h - NVS-backed key/value store, kept in memory for the process.
+#pragma once
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* = nullptr) {
+    ns_ = name ? name : "";
+    readOnly_ = readOnly;
+    open_ = true;
+    return true;
+  }
+  void end() { open_ = false; }
+  bool clear() { if (!writable()) return false; store().erase(ns_); return true; }
+  bool remove(const char* key) { return writable() && space().erase(key) > 0; }
+  bool isKey(const char* key) { return open_ && space().count(key) > 0; }
+
+  size_t putUChar(const char* key, uint8_t v) { return putRaw(key, &v, sizeof(v)); }
+  size_t putUShort(const char* key, uint16_t v) { return putRaw(key, &v, sizeof(v)); }
+  size_t putUInt(const char* key, uint32_t v) { return putRaw(key, &v, sizeof(v)); }
+  size_t putInt(const char* key, int32_t v) { return putRaw(key, &v, sizeof(v)); }
+  size_t putULong(const char* key, uint32_t v) { return putRaw(key, &v, sizeof(v)); }
+  size_t putBool(const char* key, bool v) { const uint8_t b = v; return putRaw(key, &b, 1); }
+  size_t putString(const char* key, const char* v) { return putRaw(key, v, strlen(v)); }
+  size_t putString(const char* key, const String& v) { return putRaw(key, v.c_str(), v.length()); }
+  size_t putBytes(const char* key, const void* v, size_t n) { return putRaw(key, v, n); }
+
+  uint8_t getUChar(const char* key, uint8_t d = 0) { return getRaw(key, d); }
+  uint16_t getUShort(const char* key, uint16_t d = 0) { return getRaw(key, d); }
+  uint32_t getUInt(const char* key, uint32_t d = 0) { return getRaw(key, d); }
+  int32_t getInt(const char* key, int32_t d = 0) { return getRaw(key, d); }
+  uint32_t getULong(const char* key, uint32_t d = 0) { return getRaw(key, d); }
+  bool getBool(const char* key, bool d = false) { return getRaw<uint8_t>(key, d) != 0; }
+  String getString(const char* key, const String& d = String()) {
+    const Blob* b = find(key);
+    return b ? String((const char*)b->data(), b->size()) : d;
+  }
+  size_t getBytesLength(const char* key) { const Blob* b = find(key); return b ? b->size() : 0; }
+  size_t getBytes(const char* key, void* out, size_t n) {
+    const Blob* b = find(key);
+    if (!b || b->size() > n) return 0;
+    memcpy(out, b->data(), b->size());
+    return b->size();
+  }
+
+private:
+  typedef std::vector<uint8_t> Blob;
+  typedef std::map<std::string, Blob> Space;
+
+  static std::map<std::string, Space>& store() { static std::map<std::string, Space> s; return s; }
+  Space& space() { return store()[ns_]; }
+  bool writable() const { return open_ && !readOnly_; }
+  const Blob* find(const char* key) {
+    if (!open_) return nullptr;
+    auto it = space().find(key);
+    return it == space().end() ? nullptr : &it->second;
+  }
+  size_t putRaw(const char* key, const void* v, size_t n) {
+    if (!writable()) return 0;
+    space()[key].assign((const uint8_t*)v, (const uint8_t*)v + n);
+    return n;
+  }
+  template <typename T>
+  T getRaw(const char* key, T d) {
+    const Blob* b = find(key);
+    if (!b || b->size() != sizeof(T)) return d;
+    T v;
+    memcpy(&v, b->data(), sizeof(T));
+    return v;
+  }
+
+  std::string ns_;
+  bool readOnly_ = false;
+  bool open_ = false;
+};
@@ -0,0 +1,22 @@
+// SD_MMC.h - the SD card slot, always empty on the host.
+#pragma once
+
+#include "FS.h"
+
+#define CARD_NONE 0
+#define CARD_MMC 1
+#define CARD_SD 2
+#define CARD_SDHC 3
+
+class SDMMCFS : public fs::FS {
+public:
+  bool setPins(int, int, int) { return true; }
+  bool setPins(int, int, int, int, int, int) { return true; }
+  bool begin(const char* = "/sdcard", bool = false, bool = false, int = 20000, uint8_t = 5) { return false; }
+  void end() {}
+  uint8_t cardType() { return CARD_NONE; }
+  uint64_t cardSize() { return 0; }
+  uint64_t totalBytes() { return 0; }
+  uint64_t usedBytes() { return 0; }
+};
+extern SDMMCFS SD_MMC;
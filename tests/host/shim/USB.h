@@ -0,0 +1,12 @@
+// USB.h - the TinyUSB device stack; nothing to start on the host.
+#pragma once
+
+#include <Arduino.h>
+
+class ESPUSB {
+public:
+  bool begin() { return true; }
+  void productName(const char*) {}
+  void manufacturerName(const char*) {}
+};
+extern ESPUSB USB;
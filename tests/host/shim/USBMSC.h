@@ -0,0 +1,18 @@
+// USBMSC.h - USB mass-storage class; callbacks are accepted and never called.
+#pragma once
+
+#include <Arduino.h>
+
+class USBMSC {
+public:
+  bool begin(uint32_t, uint16_t) { return true; }
+  void end() {}
+  void vendorID(const char*) {}
+  void productID(const char*) {}
+  void productRevision(const char*) {}
+  void onRead(int32_t (*)(uint32_t, uint32_t, void*, uint32_t)) {}
+  void onWrite(int32_t (*)(uint32_t, uint32_t, uint8_t*, uint32_t)) {}
+  void onStartStop(bool (*)(uint8_t, bool, bool)) {}
+  void mediaPresent(bool) {}
+  void isWritable(bool) {}
+};
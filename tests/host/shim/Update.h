@@ -0,0 +1,21 @@
+// Update.h - OTA writer; the host has no flash partition to update.
+#pragma once
+
+#include <Arduino.h>
+
+#define UPDATE_SIZE_UNKNOWN 0xFFFFFFFF
+#define U_FLASH 0
+#define UPDATE_ERROR_NO_PARTITION 10
+
+class UpdateClass {
+public:
+  bool begin(size_t = UPDATE_SIZE_UNKNOWN, int = U_FLASH) { return false; }
+  size_t write(uint8_t*, size_t) { return 0; }
+  bool end(bool = false) { return false; }
+  bool isFinished() { return false; }
+  void abort() {}
+  uint8_t getError() { return UPDATE_ERROR_NO_PARTITION; }
+  void printError(Print&) {}
+  const char* errorString() { return "no OTA partition on host"; }
+};
+extern UpdateClass Update;
@@ -0,0 +1,9 @@
+// gpio.h - ESP-IDF pad configuration has no effect on the host.
+#pragma once
+
+#include "esp_system.h"
+
+typedef int gpio_num_t;
+
+inline esp_err_t gpio_pullup_en(gpio_num_t) { return ESP_OK; }
+inline esp_err_t gpio_pullup_dis(gpio_num_t) { return ESP_OK; }
@@ -0,0 +1,37 @@
+// sdmmc_host.h - SDMMC host types; the host has no card, so init fails.
+#pragma once
+
+#include "esp_system.h"
+
+#include "driver/gpio.h"
+
+typedef struct {
+  uint32_t flags;
+  int slot;
+  int max_freq_khz;
+} sdmmc_host_t;
+
+typedef struct {
+  gpio_num_t clk, cmd, d0, d1, d2, d3, d4, d5, d6, d7, cd, wp;
+  uint8_t width;
+  uint32_t flags;
+} sdmmc_slot_config_t;
+
+typedef struct {
+  struct {
+    uint32_t capacity;
+    uint32_t sector_size;
+  } csd;
+} sdmmc_card_t;
+
+#define SDMMC_HOST_FLAG_1BIT (1 << 0)
+#define SDMMC_HOST_FLAG_4BIT (1 << 1)
+#define SDMMC_HOST_SLOT_1 1
+#define SDMMC_FREQ_DEFAULT 20000
+#define SDMMC_FREQ_HIGHSPEED 40000
+#define SDMMC_HOST_DEFAULT() sdmmc_host_t{ SDMMC_HOST_FLAG_1BIT | SDMMC_HOST_FLAG_4BIT, SDMMC_HOST_SLOT_1, SDMMC_FREQ_DEFAULT }
+#define SDMMC_SLOT_CONFIG_DEFAULT() sdmmc_slot_config_t{}
+
+inline esp_err_t sdmmc_host_init() { return ESP_FAIL; }
+inline esp_err_t sdmmc_host_init_slot(int, const sdmmc_slot_config_t*) { return ESP_FAIL; }
+inline esp_err_t sdmmc_host_deinit() { return ESP_OK; }
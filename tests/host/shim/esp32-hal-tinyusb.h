@@ -0,0 +1,2 @@
+// esp32-hal-tinyusb.h - nothing the sketch uses needs declaring on the host.
+#pragma once
@@ -0,0 +1,170 @@
+// esp32.cpp - the ESP32 core and FreeRTOS pieces the sketch links against:
+// RNG, restart, and tasks/semaphores on std::thread.
+
+#include <Arduino.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "SD_MMC.h"
+#include "USB.h"
+#include "Update.h"
+
+EspClass ESP;
+SDMMCFS SD_MMC;
+UpdateClass Update;
+ESPUSB USB;
+
+void EspClass::restart() { esp_restart(); }
+
+void esp_restart() {
+  fprintf(stderr, "esp_restart() called on the host\n");
+  exit(3);
+}
+
+// ---- RNG ----
+static std::mutex s_rng_mutex;
+static uint64_t s_rng[4];
+static bool s_rng_seeded = false;
+
+static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+static uint64_t splitmix64(uint64_t& x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static void seedLocked(uint64_t seed) {
+  for (uint64_t& s : s_rng) s = splitmix64(seed);
+  s_rng_seeded = true;
+}
+
+static uint64_t nextLocked() {
+  if (!s_rng_seeded) seedLocked(0x5050415353ULL);
+  const uint64_t r = rotl(s_rng[1] * 5, 7) * 9;
+  const uint64_t t = s_rng[1] << 17;
+  s_rng[2] ^= s_rng[0];
+  s_rng[3] ^= s_rng[1];
+  s_rng[1] ^= s_rng[2];
+  s_rng[0] ^= s_rng[3];
+  s_rng[2] ^= t;
+  s_rng[3] = rotl(s_rng[3], 45);
+  return r;
+}
+
+void hostSeedRandom(uint64_t seed) {
+  std::lock_guard<std::mutex> lock(s_rng_mutex);
+  seedLocked(seed);
+}
+
+uint32_t esp_random(void) {
+  std::lock_guard<std::mutex> lock(s_rng_mutex);
+  return (uint32_t)(nextLocked() >> 32);
+}
+
+void esp_fill_random(void* buf, size_t len) {
+  std::lock_guard<std::mutex> lock(s_rng_mutex);
+  uint8_t* p = (uint8_t*)buf;
+  while (len) {
+    const uint64_t r = nextLocked();
+    const size_t n = len < 8 ? len : 8;
+    memcpy(p, &r, n);
+    p += n;
+    len -= n;
+  }
+}
+
+// ---- Tasks ----
+struct HostTask {
+  BaseType_t core;
+};
+
+namespace {
+struct TaskExit {};  // thrown by vTaskDelete(nullptr) to unwind the task's thread
+}
+
+static HostTask s_main_task = { 1 };  // the Arduino loop runs on core 1
+static thread_local HostTask* t_current = &s_main_task;
+static std::atomic<bool> s_task_creation{ true };
+
+void hostSetTaskCreation(bool allowed) { s_task_creation = allowed; }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* outHandle, BaseType_t core) {
+  if (!s_task_creation) return pdFAIL;
+  HostTask* task = new HostTask{ core == tskNO_AFFINITY ? 0 : core };
+  if (outHandle) *outHandle = task;
+  std::thread([fn, arg, task] {
+    t_current = task;
+    try {
+      fn(arg);
+    } catch (const TaskExit&) {
+    }
+    delete task;
+  }).detach();
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackBytes, void* arg,
+                       UBaseType_t priority, TaskHandle_t* outHandle) {
+  return xTaskCreatePinnedToCore(fn, name, stackBytes, arg, priority, outHandle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (task && task != t_current) {
+    fprintf(stderr, "vTaskDelete() of another task is not supported on the host\n");
+    abort();
+  }
+  if (t_current == &s_main_task) {
+    fprintf(stderr, "vTaskDelete() from the main task\n");
+    abort();
+  }
+  throw TaskExit();
+}
+
+// Ticks are not simulated time: a task that waits only gives up the CPU.
+void vTaskDelay(TickType_t) { std::this_thread::yield(); }
+void taskYIELD() { std::this_thread::yield(); }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return t_current; }
+BaseType_t xPortGetCoreID() { return t_current->core; }
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 4096; }
+
+// ---- Semaphores ----
+struct HostSemaphore {
+  std::mutex m;
+  std::condition_variable cv;
+  UBaseType_t count;
+  UBaseType_t max;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new HostSemaphore{ {}, {}, 0, 1 }; }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new HostSemaphore{ {}, {}, 1, 1 }; }
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t maxCount, UBaseType_t initialCount) {
+  return new HostSemaphore{ {}, {}, initialCount, maxCount };
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(sem->m);
+  auto ready = [sem] { return sem->count > 0; };
+  if (ticks == portMAX_DELAY) {
+    sem->cv.wait(lock, ready);
+  } else if (!sem->cv.wait_for(lock, std::chrono::milliseconds(ticks), ready)) {
+    return pdFALSE;
+  }
+  sem->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  std::lock_guard<std::mutex> lock(sem->m);
+  if (sem->count >= sem->max) return pdFALSE;
+  sem->count++;
+  sem->cv.notify_one();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
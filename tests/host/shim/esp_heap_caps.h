@@ -0,0 +1,34 @@
+// esp_heap_caps.h - capability-tagged allocation is plain malloc on the host.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+typedef struct {
+  size_t total_free_bytes;
+  size_t total_allocated_bytes;
+  size_t largest_free_block;
+  size_t minimum_free_bytes;
+  size_t allocated_blocks;
+  size_t free_blocks;
+  size_t total_blocks;
+} multi_heap_info_t;
+
+inline void* heap_caps_malloc(size_t n, uint32_t) { return malloc(n); }
+inline void* heap_caps_calloc(size_t n, size_t size, uint32_t) { return calloc(n, size); }
+inline void heap_caps_free(void* p) { free(p); }
+inline size_t heap_caps_get_free_size(uint32_t) { return 256 * 1024; }
+inline size_t heap_caps_get_largest_free_block(uint32_t) { return 128 * 1024; }
+inline void heap_caps_get_info(multi_heap_info_t* info, uint32_t) {
+  memset(info, 0, sizeof(*info));
+  info->total_free_bytes = info->minimum_free_bytes = 256 * 1024;
+  info->largest_free_block = 128 * 1024;
+}
@@ -0,0 +1,9 @@
+// esp_log.h - ESP-IDF logging is compiled out on the host.
+#pragma once
+
+#include "esp_system.h"
+
+#define ESP_LOGE(tag, ...) ((void)(tag))
+#define ESP_LOGW(tag, ...) ((void)(tag))
+#define ESP_LOGI(tag, ...) ((void)(tag))
+#define ESP_LOGD(tag, ...) ((void)(tag))
@@ -0,0 +1,11 @@
+// esp_random.h - host RNG: xoshiro256** behind a lock, fixed seed so runs repeat.
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+uint32_t esp_random(void);
+void esp_fill_random(void* buf, size_t len);
+
+// Test control: restart the sequence from seed.
+void hostSeedRandom(uint64_t seed);
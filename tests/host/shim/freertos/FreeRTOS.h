@@ -0,0 +1,27 @@
+// FreeRTOS.h - types and constants of the FreeRTOS subset the sketch uses.
+// Tasks and semaphores are std::thread and std::condition_variable (esp32.cpp);
+// one tick is one millisecond.
+#pragma once
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t StackType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7fffffff
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
@@ -0,0 +1,23 @@
+// task.h - FreeRTOS tasks as detached std::threads. A task may end by calling
+// vTaskDelete(nullptr) or by returning; deleting another task is not supported.
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackBytes, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* outHandle, BaseType_t core);
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackBytes, void* arg,
+                       UBaseType_t priority, TaskHandle_t* outHandle);
+[[noreturn]] void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xPortGetCoreID();
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+void taskYIELD();
+
+// Test control: tasks created from now on fail to start while false.
+void hostSetTaskCreation(bool allowed);
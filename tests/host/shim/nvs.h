@@ -0,0 +1,16 @@
+// nvs.h - raw NVS handles; the sketch keeps its state through Preferences, so
+// on the host every handle fails to open.
+#pragma once
+
+#include "esp_system.h"
+
+typedef uint32_t nvs_handle_t;
+typedef enum { NVS_READONLY, NVS_READWRITE } nvs_open_mode_t;
+
+inline esp_err_t nvs_open(const char*, nvs_open_mode_t, nvs_handle_t*) { return ESP_FAIL; }
+inline esp_err_t nvs_get_blob(nvs_handle_t, const char*, void*, size_t*) { return ESP_ERR_NVS_NOT_FOUND; }
+inline esp_err_t nvs_set_blob(nvs_handle_t, const char*, const void*, size_t) { return ESP_FAIL; }
+inline esp_err_t nvs_erase_key(nvs_handle_t, const char*) { return ESP_FAIL; }
+inline esp_err_t nvs_erase_all(nvs_handle_t) { return ESP_FAIL; }
+inline esp_err_t nvs_commit(nvs_handle_t) { return ESP_FAIL; }
+inline void nvs_close(nvs_handle_t) {}
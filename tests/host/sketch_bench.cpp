@@ -0,0 +1,96 @@
+// sketch_bench.cpp - host timings of sketch code paths that run per keystroke
+// or per entry: dictionary lookups, the full strength estimate, password
+// generation and field encryption.
+//
+// A PC is roughly 20-50x faster than the ESP32-S3 running from flash; use the
+// numbers to compare changes, and the probe counts to reason about the device.
+
+#include "pp_sketch.h"
+#include <chrono>
+
+template <typename Fn>
+static double nsPerOp(uint32_t reps, Fn&& fn) {
+  const auto t0 = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < reps; ++i) fn(i);
+  const auto t1 = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / reps;
+}
+
+// Hits cycle through real entries; misses are those entries with their last
+// letter changed, so they land in the same block as a hit would.
+static void benchLookup(const char* name, const StrengthDict& d, const char* const* words, uint32_t n) {
+  volatile uint32_t sink = 0;
+  const uint32_t reps = 200000;
+  const double hit = nsPerOp(reps, [&](uint32_t i) {
+    const char* w = words[i % n];
+    sink = sink + sdict_rank(d, w, (uint8_t)strlen(w));
+  });
+  const double miss = nsPerOp(reps, [&](uint32_t i) {
+    char w[STRENGTH_MAX_WORD + 1];
+    const size_t len = strlen(words[i % n]);
+    memcpy(w, words[i % n], len);
+    w[len - 1] = w[len - 1] == 'q' ? 'x' : 'q';
+    sink = sink + sdict_rank(d, w, (uint8_t)len);
+  });
+  const uint32_t blocks = (d.count + DICT_BLOCK - 1) / DICT_BLOCK;
+  uint32_t probes = 0;
+  while ((1u << probes) < blocks) ++probes;
+  printf("%-28s %9.1f ns hit  %9.1f ns miss  (%u entries, %u head probes + 1 block)\n",
+         name, hit, miss, (unsigned)d.count, (unsigned)probes);
+}
+
+static void benchEstimate(const char* pw) {
+  const size_t n = strlen(pw);
+  volatile float sink = 0;
+  const double ns = nsPerOp(2000, [&](uint32_t) { sink = sink + estimate_strength(pw, n).log10_guesses; });
+  printf("estimate %-19.19s %9.2f us/op  (%u chars)\n", pw, ns / 1000.0, (unsigned)n);
+}
+
+// One PwEntropy across calls, as the importer keeps it, so the figure includes
+// the amortized pool refills.
+static void benchGenerate(uint8_t policy) {
+  const PwPolicy p = pwpolicy_resolve(policy);
+  PwEntropy e;
+  SecureString out;
+  volatile size_t sink = 0;
+  const double ns = nsPerOp(100000, [&](uint32_t) {
+    pwgen_next(e, p, out);
+    sink = sink + out.length();
+  });
+  printf("generate %-19s %9.1f ns/op  (%.0f per second)\n", p.name, ns, 1e9 / ns);
+}
+
+// The device's own settings benchmark, on the real clock. Best of several runs:
+// one run is only 16 KiB.
+static void benchAead(CipherSuite suite) {
+  hostUseWallClock(true);
+  uint32_t best = 0;
+  for (int i = 0; i < 50; ++i) best = std::max(best, aead_benchmark_kbps(suite));
+  hostUseWallClock(false);
+  printf("encrypt %-20s %9u KiB/s  (aead_benchmark_kbps, 256 B fields)\n", cipher_suite_name((uint8_t)suite),
+         (unsigned)best);
+}
+
+int main() {
+  static const char* const kPasswords[] = {
+    "123456", "password", "qwerty", "dragon", "monkey", "letmein", "sunshine", "trustno1",
+  };
+  static const char* const kWords[] = {
+    "the", "people", "michael", "smith", "abandon", "zoology", "yellow", "network",
+  };
+  benchLookup("lookup, passwords", kStrengthDicts[0], kPasswords, 8);
+  benchLookup("lookup, words", kStrengthDicts[1], kWords, 8);
+
+  // Every substring of 3..15 characters is looked up forwards, reversed and
+  // unleeted in both dictionaries, so the estimate grows with length.
+  benchEstimate("hunter2");
+  benchEstimate("Tr0ub4dor&3");
+  benchEstimate("correct-horse-battery-staple");
+  benchEstimate("k9#Vq2!mZ7@xL4$wk9#Vq2!mZ7@xL4$wk9#Vq2!mZ7@xL4$wk9#Vq2!mZ7@xL4$w");
+
+  for (uint8_t id = 1; id < PW_POLICY_COUNT; ++id) benchGenerate(id);
+
+  benchAead(CipherSuite::AesGcm);
+  benchAead(CipherSuite::ChaChaPoly);
+  return 0;
+}
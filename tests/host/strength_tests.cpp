@@ -0,0 +1,68 @@
+// strength_tests.cpp - the flash dictionaries against the lists they were
+// generated from, and a few estimates that must not drift.
+
+#include "pp_sketch.h"
+#include "host_test.h"
+#include <fstream>
+#include <map>
+#include <string>
+
+// Rank of every word gen_dict.py keeps from a list: first line wins, 3..15
+// characters, saturating at 65535.
+static std::map<std::string, uint16_t> loadRanks(const char* file) {
+  std::map<std::string, uint16_t> ranks;
+  std::ifstream in(std::string(PP_STRENGTH_LISTS) + "/" + file);
+  CHECK(in.good());
+  std::string line;
+  uint32_t rank = 0;
+  while (std::getline(in, line)) {
+    while (!line.empty() && isspace((unsigned char)line.back())) line.pop_back();
+    if (line.empty() || line[0] == '#') continue;
+    rank++;
+    for (char& c : line) c = (char)tolower((unsigned char)c);
+    if (line.size() >= 3 && line.size() <= STRENGTH_MAX_WORD && !ranks.count(line)) {
+      ranks[line] = (uint16_t)(rank < 0xFFFF ? rank : 0xFFFF);
+    }
+  }
+  return ranks;
+}
+
+static uint16_t rankOf(const StrengthDict& d, const std::string& w) {
+  return sdict_rank(d, w.data(), (uint8_t)w.size());
+}
+
+TEST(passwords_dict_matches_list) {
+  const auto ranks = loadRanks("passwords.txt");
+  CHECK(ranks.size() > 10000);
+  CHECK_EQ(ranks.size(), DICT_PASSWORDS_COUNT);
+  for (const auto& kv : ranks) CHECK_EQ(rankOf(kStrengthDicts[0], kv.first), kv.second);
+}
+
+// words.txt comes first; the passphrase list is appended after it.
+TEST(words_dict_covers_list_and_passphrases) {
+  const auto ranks = loadRanks("words.txt");
+  for (const auto& kv : ranks) CHECK_EQ(rankOf(kStrengthDicts[1], kv.first), kv.second);
+  for (uint16_t i = 0; i < PASSWORD_WORD_COUNT; ++i) {
+    const std::string w(kPassWords[i]);
+    if (w.size() >= 3) CHECK(rankOf(kStrengthDicts[1], w) != 0);
+  }
+}
+
+// Keys sorting before the first entry, after the last, and between entries of
+// the short last block.
+TEST(dict_misses_return_zero) {
+  static const char* const kMisses[] = { "   ", "!!!", "zzzzzzzzzzzzzzz", "~~~~", "qxqxqx", "passwordpasswor" };
+  for (const auto& d : kStrengthDicts) {
+    for (const char* m : kMisses) CHECK_EQ(sdict_rank(d, m, (uint8_t)strlen(m)), 0);
+    CHECK_EQ(sdict_rank(d, "toolongforthedict", 17), 0);
+  }
+}
+
+TEST(estimates_for_known_passwords) {
+  CHECK_EQ(estimate_strength("password", 8).score, 0);
+  CHECK(strcmp(estimate_strength("password", 8).hint, "Common password") == 0);
+  CHECK_EQ(estimate_strength("qwertyuiop", 10).score, 0);
+  CHECK(estimate_strength("P@ssw0rd1990", 12).score <= 1);
+  CHECK(estimate_strength("correct-horse-battery-staple", 28).score >= 3);
+  CHECK_EQ(estimate_strength("k9#Vq2!mZ7@xL4$w", 16).score, 4);
+}
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""Regenerates main/32_strength_dict.ino from the word lists in this directory.
+
+    python3 tools/strength/gen_dict.py
+
+Each list is ranked by line order (most common first), lowercased, sorted and
+front-coded: every entry stores how many leading bytes it shares with the
+previous one, its rank and the remaining suffix. Entries are grouped in blocks
+of BLOCK whose first entry is stored whole, so a lookup binary-searches the
+block heads and decodes at most one block into a stack buffer. Block offsets
+are 32-bit; ranks are 16-bit and saturate at 65535.
+
+Entry layout: [shared:4 | suffix_len:4] [rank lo] [rank hi] [suffix bytes]
+"""
+import os
+import re
+
+BLOCK = 16
+MAX_LEN = 15
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.normpath(os.path.join(HERE, "..", ".."))
+OUT = os.path.join(ROOT, "main", "32_strength_dict.ino")
+
+# Where the vendored lists come from; repeated in the generated file and in the
+# README's credits, which also carry the full license notices.
+CREDITS = [
+    "Sources:",
+    "- passwords.txt: Royce Williams' 20k most common passwords, as shipped in",
+    "  Django's common-passwords.txt.gz. Copyright (c) Django Software Foundation",
+    "  and individual contributors, BSD-3-Clause (notice in README.md).",
+    "- words.txt: US first names and surnames by frequency and lorem words from",
+    "  Faker (https://github.com/joke2k/faker). Copyright (c) 2012 Daniele",
+    "  Faraglia, MIT (notice in README.md).",
+    "- words.txt: the BIP-39 English wordlist",
+    "  (https://github.com/bitcoin/bips/blob/master/bip-0039/english.txt).",
+    "- The passphrase list from main/31_pwgen.ino: the EFF long wordlist",
+    "  (c) Electronic Frontier Foundation, CC BY 3.0 US.",
+]
+
+
+def read_list(path):
+    words = []
+    with open(path, encoding="utf-8") as f:
+        for line in f:
+            line = line.strip()
+            if line and not line.startswith("#"):
+                words.append(line.lower())
+    return words
+
+
+def passphrase_words():
+    # The generator's passphrase list doubles as dictionary words: a passphrase
+    # estimate should not pretend those words are random letters.
+    src = open(os.path.join(ROOT, "main", "31_pwgen.ino"), encoding="utf-8").read()
+    m = re.search(r"kPassWords\[\]\[\d+\] PROGMEM = \{(.*?)\};", src, re.S)
+    return re.findall(r'"([a-z-]+)"', m.group(1)) if m else []
+
+
+def ranked(words):
+    ranks = {}
+    for i, w in enumerate(words, 1):
+        if 3 <= len(w) <= MAX_LEN and w not in ranks:
+            ranks[w] = min(i, 0xFFFF)
+    return sorted(ranks.items(), key=lambda kv: kv[0].encode())
+
+
+def encode(entries):
+    data = bytearray()
+    blocks = []
+    prev = b""
+    for i, (w, rank) in enumerate(entries):
+        b = w.encode()
+        if i % BLOCK == 0:
+            blocks.append(len(data))
+            shared = 0
+        else:
+            shared = 0
+            while shared < min(len(prev), len(b), 15) and prev[shared] == b[shared]:
+                shared += 1
+        suffix = b[shared:]
+        data.append((shared << 4) | len(suffix))
+        data += bytes((rank & 0xFF, rank >> 8))
+        data += suffix
+        prev = b
+    return data, blocks
+
+
+def emit_bytes(data):
+    out = []
+    for i in range(0, len(data), 16):
+        out.append("  " + ", ".join("0x%02x" % x for x in data[i:i + 16]) + ",")
+    return "\n".join(out)
+
+
+def emit_u32(vals):
+    out = []
+    for i in range(0, len(vals), 10):
+        out.append("  " + ", ".join("%u" % v for v in vals[i:i + 10]) + ",")
+    return "\n".join(out)
+
+
+def main():
+    lists = [
+        ("Passwords", read_list(os.path.join(HERE, "passwords.txt"))),
+        ("Words", read_list(os.path.join(HERE, "words.txt")) + passphrase_words()),
+    ]
+    parts = [
+        "//32_strength_dict.ino",
+        "// ==== Strength dictionaries ====",
+        "// GENERATED by tools/strength/gen_dict.py from the lists next to it - edit those",
+        "// and re-run instead of touching this file. Front-coded, %u entries per block;" % BLOCK,
+        "// see the generator for the entry layout.",
+        "//",
+    ] + ["// " + line if line else "//" for line in CREDITS] + [
+        "",
+        "static constexpr uint8_t DICT_BLOCK = %u;" % BLOCK,
+        "",
+    ]
+    for name, words in lists:
+        entries = ranked(words)
+        data, blocks = encode(entries)
+        parts.append("// %u entries, %u bytes" % (len(entries), len(data)))
+        parts.append("static const uint8_t kDict%sData[] PROGMEM = {" % name)
+        parts.append(emit_bytes(data))
+        parts.append("};")
+        parts.append("static const uint32_t kDict%sBlocks[] PROGMEM = {" % name)
+        parts.append(emit_u32(blocks))
+        parts.append("};")
+        parts.append("static constexpr uint16_t DICT_%s_COUNT = %u;" % (name.upper(), len(entries)))
+        parts.append("")
+    with open(OUT, "w", encoding="utf-8") as f:
+        f.write("\n".join(parts))
+    print("wrote", os.path.relpath(OUT, ROOT))
+
+
+if __name__ == "__main__":
+    main()